@@ -0,0 +1,198 @@
+#include <array>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_AUTON_CHECKPOINT_HPP
+#define HOTEL_AUTON_CHECKPOINT_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * autonomous routine that picks up where it left off when its task is restarted
+     *
+     * if comms drop during autonomous, the task is deleted, and re-enabling starts `autonomous()` again from the top.
+     * this keeps a checkpoint (the number of steps completed, and a snapshot of whatever `State` the robot cares about:
+     * pose, mechanism positions) after every step, in the object itself. it should be a static, which the task's
+     * deletion doesn't touch. when `begin()` is called again within the same autonomous period, the steps that were
+     * already completed are skipped and the one that was interrupted is run again from scratch.
+     *
+     * steps are identified only by the order they're reached in, so the routine has to make the same `step()` calls in
+     * the same order every time. an interrupted step is rerun in full from wherever the robot ended up, so steps should
+     * drive to absolute targets (a pose on the field, a lift height) rather than relative ones; the controllers then
+     * re-target from the current pose on their own. if something that the steps rely on was lost with the task (an
+     * odometry estimate kept in the autonomous task, say), restore it from `last().state` when `resumed()`.
+     *
+     * a checkpoint is written to whichever of two slots isn't current and then published with a single store, so a
+     * task deleted partway through a checkpoint leaves the previous one intact. that, the state capture, and a copy of
+     * `State` is all a checkpoint costs.
+     *
+     * example:
+     * ```{.cpp}
+     * struct robot_state {
+     *     pose p;
+     *     double lift;
+     * };
+     *
+     * static hotel::resumable_auton<robot_state> auton{[] { return robot_state{odom.pose(), lift.get_position()}; }};
+     *
+     * void autonomous() {
+     *     auton.begin();
+     *     auton.step([] { drive_to({24, 0, 0}); });
+     *     auton.step([] { lift_to(600); });
+     *     auton.step([] { drive_to({24, 36, 90}); });
+     * }
+     *
+     * void opcontrol() {
+     *     auton.reset();
+     *     ...
+     * }
+     * ```
+     *
+     * @tparam State trivially copyable snapshot taken after each step
+     * @tparam Clock clock the resume window is measured against
+     */
+    template <class State, concepts::MicrosClock Clock = micros_clock>
+        requires std::is_trivially_copyable_v<State>
+    class resumable_auton {
+    public:
+        struct options {
+            /// how long after a run starts that `begin()` still resumes it rather than starting over, in microseconds;
+            /// the length of the autonomous period, with a little to spare
+            std::uint64_t resume_window_us = 16000000;
+        };
+
+        struct checkpoint {
+            /// steps completed when the checkpoint was taken
+            std::uint32_t completed = 0;
+            /// when the checkpoint was taken, in microseconds
+            std::uint64_t at = 0;
+            State state{};
+        };
+    private:
+        std::function<State()> capture;
+        options opts;
+        std::array<checkpoint, 2> slots{};
+        std::atomic<std::uint8_t> current{0};
+        std::atomic<bool> active{false};
+        std::uint64_t started_at = 0;
+        std::uint32_t restarts_ = 0;
+        std::uint32_t skipped_ = 0;
+
+        // position within the current invocation of the routine
+        std::uint32_t next = 0;
+        std::uint32_t resume_from = 0;
+        bool resumed_ = false;
+
+        void save(std::uint32_t completed) {
+            auto spare = current.load(std::memory_order_relaxed) ^ 1;
+            auto& c = slots[spare];
+            c.completed = completed;
+            c.at = Clock::now();
+            c.state = capture();
+            current.store(static_cast<std::uint8_t>(spare), std::memory_order_release);
+        };
+    public:
+        /**
+         * @param c returns a snapshot of the robot's state; called once per checkpoint
+         * @param o resume window
+         */
+        template <class F>
+            requires std::is_invocable_r_v<State, F>
+        explicit resumable_auton(F&& c, options o = {}) : capture(std::forward<F>(c)), opts(o) {};
+
+        /**
+         * start the routine, resuming the previous run if it's still within the resume window
+         *
+         * call this first thing in `autonomous()`.
+         *
+         * @return whether the previous run was resumed
+         */
+        bool begin() {
+            auto now = Clock::now();
+            next = 0;
+            if (active.load(std::memory_order_acquire) && now - started_at < opts.resume_window_us) {
+                resume_from = last().completed;
+                resumed_ = true;
+                restarts_++;
+                skipped_ += resume_from;
+                return true;
+            }
+
+            started_at = now;
+            resume_from = 0;
+            resumed_ = false;
+            restarts_ = 0;
+            skipped_ = 0;
+            save(0);
+            active.store(true, std::memory_order_release);
+            return false;
+        };
+
+        /**
+         * run the next step, unless a previous run of the routine already completed it
+         *
+         * @param body the step
+         * @return whether the step was run
+         */
+        template <class F>
+        bool step(F&& body) {
+            static_assert(std::is_invocable_v<F>);
+            if (next < resume_from) {
+                next++;
+                return false;
+            }
+            body();
+            save(++next);
+            return true;
+        };
+
+        /**
+         * forget the current run, so the next `begin()` starts from the first step
+         *
+         * call this once autonomous is definitely over (at the start of `opcontrol()`), or before a practice run.
+         */
+        void reset() {
+            active.store(false, std::memory_order_release);
+        };
+
+        /// whether this invocation of the routine resumed a previous one
+        bool resumed() const noexcept { return resumed_; };
+
+        /// index of the next step `step()` will reach
+        std::uint32_t position() const noexcept { return next; };
+
+        /// the most recent checkpoint
+        const checkpoint& last() const { return slots[current.load(std::memory_order_acquire)]; };
+
+        /// times the current run has been resumed
+        std::uint32_t restarts() const noexcept { return restarts_; };
+
+        /// steps skipped on restart over the current run, because an earlier invocation had already completed them
+        std::uint32_t skipped() const noexcept { return skipped_; };
+
+        /**
+         * write the current run's progress as an `auton_checkpoint` telemetry record
+         *
+         * fields are: steps completed, restarts, steps skipped on restart, and time since the last checkpoint (in
+         * microseconds).
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            const auto& c = last();
+            telemetry::write(out, "auton_checkpoint", c.completed, restarts_, skipped_, Clock::now() - c.at);
+        };
+    };
+}
+
+#endif // HOTEL_AUTON_CHECKPOINT_HPP
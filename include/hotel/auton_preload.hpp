@@ -0,0 +1,449 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "pros/rtos.hpp"
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_AUTON_PRELOAD_HPP
+#define HOTEL_AUTON_PRELOAD_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * autonomous routines whose heavy preparation runs before the match starts
+     *
+     * each routine declares the expensive setup it needs (profiling trajectories, loading tables off the SD card,
+     * reserving memory, building controllers) as a list of steps. `start()` runs those steps in small time slices
+     * from a low-priority task of its own while the robot is sitting on the field with nothing better to do, starting
+     * with the selected routine and moving on to the others once it's done. `run()` in `autonomous()` stops that task
+     * and then only has to finish whatever didn't get done in time, so the routine's first motion goes out straight
+     * away instead of after seconds of setup.
+     *
+     * a step is a `bool()` that does a bounded chunk of work per call and returns `true` once it's complete; it's
+     * called again until then. the preparation task is never deleted partway through a step (which could leave it
+     * holding a lock in the allocator or the filesystem): `stop()` raises a flag that's checked between calls, and
+     * waits for the call in progress to return. so the competition callbacks only start and stop it, and can be
+     * deleted by PROS whenever it likes.
+     *
+     * `start()`, `stop()`, `prepare()` and `run()` must not be called from two tasks at once; the competition modes
+     * never overlap, so calling them from the competition callbacks is fine. `ready()` and `progress()` can be read
+     * from anywhere (a selector, say), but the step statistics belong to whichever task is preparing, so read them
+     * (with `for_each_step()` or `report()`) once it's stopped.
+     *
+     * the time from `run()` to the routine's first command is measured when the routine calls `first_command()`, and
+     * reported along with how long each step took.
+     *
+     * example:
+     * ```{.cpp}
+     * auto& preload = hotel::default_auton_preload();
+     *
+     * void initialize() {
+     *     auto left = preload.add_routine("left", [] {
+     *         preload.first_command();
+     *         follow(left_path);
+     *     });
+     *     preload.add_step(left, "profile", [] { return left_path.profile_some(64); });
+     *     preload.add_step(left, "tables", [] { return load_tables("/usd/left.bin"); });
+     * }
+     *
+     * void competition_initialize() {
+     *     preload.select(selector.current());
+     *     preload.start();
+     * }
+     *
+     * void disabled() { preload.start(); }
+     *
+     * void autonomous() { preload.run(); }
+     *
+     * void opcontrol() {
+     *     preload.stop();
+     *     // ...
+     * }
+     * ```
+     *
+     * @tparam MaxRoutines number of routines that can be registered
+     * @tparam MaxSteps total number of steps across all routines
+     * @tparam Clock clock used for time slicing and measurement
+     */
+    template <std::size_t MaxRoutines = 8, std::size_t MaxSteps = 32, concepts::MicrosClock Clock = micros_clock>
+    class basic_auton_preload {
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        struct options {
+            /// also prepare the routines that aren't selected, once the selected one is ready, so a late change of
+            /// selection costs nothing
+            bool prepare_unselected = true;
+        };
+
+        struct step_stats {
+            /// times the step has been called
+            std::uint32_t calls = 0;
+            /// total time spent in the step, in microseconds
+            std::uint64_t busy_us = 0;
+            /// longest single call, in microseconds
+            std::uint32_t longest_us = 0;
+            /// whether the step has completed
+            bool done = false;
+            /// whether the step was completed by `run()` rather than ahead of time
+            bool late = false;
+        };
+
+        struct run_stats {
+            /// the routine that was run, or `npos` if `run()` hasn't been called
+            std::size_t routine = npos;
+            /// time `run()` spent finishing preparation before starting the routine, in microseconds
+            std::uint64_t catch_up_us = 0;
+            /// time from `run()` to the routine's first call to `first_command()`, in microseconds; 0 until then
+            std::uint64_t first_command_us = 0;
+            bool has_commanded = false;
+        };
+    private:
+        struct routine_t {
+            const char* name = nullptr;
+            std::function<void()> body;
+            std::size_t steps = 0;
+            /// written by the preparing task, read by `ready()` and `progress()` from any
+            std::atomic<std::size_t> done{0};
+        };
+
+        enum class worker_state : std::uint8_t {
+            idle,
+            running,
+            /// asked to stop, and finishing the call in progress
+            stopping
+        };
+
+        struct step_t {
+            const char* name = nullptr;
+            std::size_t routine = 0;
+            std::function<bool()> fn;
+            step_stats stats;
+        };
+
+        std::array<routine_t, MaxRoutines> routines;
+        std::array<step_t, MaxSteps> steps;
+        std::size_t routine_count = 0;
+        std::size_t step_count = 0;
+        /// the selection can change while the preparation task is working on it
+        std::atomic<std::size_t> current{0};
+        options opts;
+        run_stats last_run;
+        std::uint64_t run_start = 0;
+        std::atomic<worker_state> worker{worker_state::idle};
+
+        bool stopping() const noexcept { return worker.load(std::memory_order_relaxed) == worker_state::stopping; };
+
+        void call(step_t& s, bool late) {
+            auto start = Clock::now();
+            bool done = s.fn();
+            auto elapsed = Clock::now() - start;
+
+            s.stats.calls++;
+            s.stats.busy_us += elapsed;
+            s.stats.longest_us = std::max(s.stats.longest_us, static_cast<std::uint32_t>(elapsed));
+            if (done) {
+                s.stats.done = true;
+                s.stats.late = late;
+                routines[s.routine].done.fetch_add(1, std::memory_order_release);
+                // nothing else needs the closure, and whatever it captured may be large
+                s.fn = nullptr;
+            }
+        };
+
+        /**
+         * run the routine's unfinished steps in order until they're all done, `deadline` passes or preparation is
+         * being stopped
+         *
+         * @return whether the routine is ready
+         */
+        bool prepare_routine(std::size_t r, std::uint64_t deadline) {
+            for (std::size_t i = 0; i < step_count && !ready(r); i++) {
+                auto& s = steps[i];
+                if (s.routine != r) {
+                    continue;
+                }
+                while (!s.stats.done) {
+                    if (Clock::now() >= deadline || stopping()) {
+                        return false;
+                    }
+                    call(s, false);
+                }
+            }
+            return ready(r);
+        };
+    public:
+        explicit basic_auton_preload(options o = {}) : opts(o) {};
+
+        /**
+         * register a routine
+         *
+         * @param name routine name; must outlive the preloader (a string literal, usually)
+         * @param body the routine itself, run by `run()`
+         * @return the routine's index, or `npos` if there's no room
+         */
+        template <class F>
+        std::size_t add_routine(const char* name, F&& body) {
+            static_assert(std::is_invocable_r_v<void, F>);
+            if (routine_count >= MaxRoutines) {
+                return npos;
+            }
+            auto& r = routines[routine_count];
+            r.name = name;
+            r.body = std::forward<F>(body);
+            r.steps = 0;
+            r.done.store(0, std::memory_order_relaxed);
+            return routine_count++;
+        };
+
+        /**
+         * add a preparation step to a routine
+         *
+         * steps run in the order they were added.
+         *
+         * @param r routine index from `add_routine()`
+         * @param name step name; must outlive the preloader
+         * @param fn does a bounded chunk of work per call, returning `true` once there's none left
+         * @return `false` if the routine doesn't exist or there's no room
+         */
+        template <class F>
+        bool add_step(std::size_t r, const char* name, F&& fn) {
+            static_assert(std::is_invocable_r_v<bool, F>);
+            if (r >= routine_count || step_count >= MaxSteps) {
+                return false;
+            }
+            steps[step_count++] = {name, r, std::forward<F>(fn), {}};
+            routines[r].steps++;
+            return true;
+        };
+
+        /**
+         * choose the routine `run()` will run, and `prepare()` will work on first
+         *
+         * @param r routine index; ignored if it doesn't exist
+         */
+        void select(std::size_t r) {
+            if (r < routine_count) {
+                current.store(r, std::memory_order_relaxed);
+            }
+        };
+
+        std::size_t selected() const noexcept { return current.load(std::memory_order_relaxed); };
+
+        /// @return the routine's index, or `npos` if there's none by that name
+        std::size_t find(const char* name) const {
+            for (std::size_t i = 0; i < routine_count; i++) {
+                if (std::strcmp(routines[i].name, name) == 0) {
+                    return i;
+                }
+            }
+            return npos;
+        };
+
+        const char* name(std::size_t r) const { return r < routine_count ? routines[r].name : nullptr; };
+
+        std::size_t size() const noexcept { return routine_count; };
+
+        /// whether every step of a routine is done
+        bool ready(std::size_t r) const {
+            return r < routine_count && routines[r].done.load(std::memory_order_acquire) == routines[r].steps;
+        };
+
+        /// whether every step of the selected routine is done
+        bool ready() const { return ready(selected()); };
+
+        /// fraction of a routine's steps that are done (for showing on the selector)
+        float progress(std::size_t r) const {
+            if (r >= routine_count || !routines[r].steps) {
+                return 1.0f;
+            }
+            return static_cast<float>(routines[r].done.load(std::memory_order_relaxed)) / routines[r].steps;
+        };
+
+        float progress() const { return progress(selected()); };
+
+        /**
+         * run preparation steps for up to `budget_us`
+         *
+         * works through the selected routine's steps first, then (if enabled) every other routine's. a step call isn't
+         * interrupted, so the budget can be overrun by up to one call.
+         *
+         * @param budget_us time to spend, in microseconds
+         * @return whether the selected routine is ready
+         */
+        bool prepare(std::uint32_t budget_us) {
+            auto deadline = Clock::now() + budget_us;
+            auto selection = selected();
+            if (!prepare_routine(selection, deadline)) {
+                return false;
+            }
+            if (opts.prepare_unselected) {
+                for (std::size_t r = 0; r < routine_count; r++) {
+                    if (r != selection && !prepare_routine(r, deadline)) {
+                        break;
+                    }
+                }
+            }
+            return true;
+        };
+
+        /**
+         * prepare in slices from a new task, until `stop()` (or `run()`)
+         *
+         * meant to be called from `competition_initialize()` and `disabled()`, which can then return (or be deleted)
+         * without affecting it; the gaps between slices leave the rest of the system (and the selector) responsive.
+         * once everything is prepared the task carries on idling through its slices until it's stopped.
+         *
+         * @param slice_us time to spend preparing per slice, in microseconds
+         * @param period_us time between the start of each slice, in microseconds
+         * @param prio task priority; below anything time-critical
+         * @return `false` if preparation was already running (it's left as it was, but not stopped if it was stopping)
+         */
+        bool start(std::uint32_t slice_us = 2000, std::uint32_t period_us = 10000,
+                   std::uint32_t prio = TASK_PRIORITY_DEFAULT - 1) {
+            auto expected = worker_state::stopping;
+            if (worker.compare_exchange_strong(expected, worker_state::running, std::memory_order_acq_rel)) {
+                return false;
+            }
+            if (expected == worker_state::running) {
+                return false;
+            }
+            worker.store(worker_state::running, std::memory_order_release);
+            pros::Task{[this, slice_us, period_us] {
+                auto next = Clock::now();
+                while (true) {
+                    auto state = worker_state::stopping;
+                    if (worker.compare_exchange_strong(state, worker_state::idle, std::memory_order_acq_rel)) {
+                        return;
+                    }
+                    prepare(slice_us);
+                    next += period_us;
+                    Clock::wait_until(next);
+                }
+            }, prio, TASK_STACK_DEPTH_DEFAULT, "auton_preload"};
+            return true;
+        };
+
+        /**
+         * stop the preparation task, waiting for the step call in progress (if any) to return
+         *
+         * the wait is at most one step call, plus up to a period of the task sleeping between slices. does nothing if
+         * preparation isn't running.
+         */
+        void stop() {
+            auto expected = worker_state::running;
+            worker.compare_exchange_strong(expected, worker_state::stopping, std::memory_order_acq_rel);
+            while (worker.load(std::memory_order_acquire) != worker_state::idle) {
+                Clock::wait_until(Clock::now() + 1000);
+            }
+        };
+
+        /**
+         * @return whether the preparation task is running
+         */
+        bool preparing() const noexcept { return worker.load(std::memory_order_relaxed) != worker_state::idle; };
+
+        /**
+         * stop preparing in the background, finish preparing the selected routine, then run it
+         *
+         * anything the routine still needs is done here before its body is called, so it's always run fully prepared;
+         * the time that takes (including waiting for the preparation task to stop) is recorded as `catch_up_us`.
+         */
+        void run() {
+            run_start = Clock::now();
+            stop();
+            auto selection = selected();
+            if (selection >= routine_count) {
+                return;
+            }
+            last_run = {selection, 0, 0, false};
+            for (std::size_t i = 0; i < step_count; i++) {
+                auto& s = steps[i];
+                while (s.routine == selection && !s.stats.done) {
+                    call(s, true);
+                }
+            }
+            last_run.catch_up_us = Clock::now() - run_start;
+            routines[selection].body();
+        };
+
+        /**
+         * mark the routine's first command to the robot
+         *
+         * call this from the routine right before (or right after) its first motor command; only the first call per
+         * `run()` is recorded.
+         */
+        void first_command() {
+            if (last_run.routine != npos && !last_run.has_commanded) {
+                last_run.first_command_us = Clock::now() - run_start;
+                last_run.has_commanded = true;
+            }
+        };
+
+        const run_stats& last() const noexcept { return last_run; };
+
+        /**
+         * visit every step of a routine
+         *
+         * @param r routine index
+         * @param fn called with the step's name and its `const step_stats&`
+         */
+        template <class F>
+        void for_each_step(std::size_t r, F&& fn) const {
+            for (std::size_t i = 0; i < step_count; i++) {
+                if (steps[i].routine == r) {
+                    fn(steps[i].name, steps[i].stats);
+                }
+            }
+        };
+
+        /**
+         * write every step as `preload` telemetry records, followed by an `auton_start` record for the last run
+         *
+         * `preload` fields are: routine, step, calls, busy time, longest call (times in microseconds), done, late.
+         * `auton_start` fields are: routine, catch-up time, time to first command (in microseconds), and whether a
+         * command was marked at all.
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            for (std::size_t i = 0; i < step_count; i++) {
+                const auto& s = steps[i];
+                telemetry::write(out, "preload", routines[s.routine].name, s.name, s.stats.calls, s.stats.busy_us,
+                                 s.stats.longest_us, s.stats.done, s.stats.late);
+            }
+            if (last_run.routine != npos) {
+                telemetry::write(out, "auton_start", routines[last_run.routine].name, last_run.catch_up_us,
+                                 last_run.first_command_us, last_run.has_commanded);
+            }
+        };
+    };
+
+    /**
+     * the autonomous preloader used by default throughout libhotel
+     */
+    using auton_preload = basic_auton_preload<>;
+
+    /**
+     * @return the shared autonomous preloader, for use across the competition callbacks
+     */
+    inline auton_preload& default_auton_preload() {
+        static auton_preload instance;
+        return instance;
+    };
+}
+
+#endif // HOTEL_AUTON_PRELOAD_HPP
@@ -0,0 +1,39 @@
+#include <cstdint>
+
+#include "pros/rtos.hpp"
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_CLOCK_HPP
+#define HOTEL_CLOCK_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * microsecond clock backed by `pros::micros`
+     *
+     * satisfies `hotel::concepts::MicrosClock`, so it can be swapped for `hotel::sim::virtual_clock` when the same code
+     * is run against a simulated plant on the host.
+     */
+    struct micros_clock {
+        static std::uint64_t now() { return pros::micros(); };
+
+        /**
+         * block until `t` has passed
+         *
+         * anything longer than a couple of milliseconds is slept through with `pros::delay` so other tasks get to run;
+         * the remainder is spun, since the scheduler can't give us anything finer than a tick.
+         *
+         * @param t absolute timestamp, in microseconds
+         */
+        static void wait_until(std::uint64_t t) {
+            auto current = now();
+            if (t > current + 2000) {
+                pros::delay(static_cast<std::uint32_t>((t - current) / 1000) - 1);
+            }
+            while (now() < t) {}
+        };
+    };
+}
+
+#endif // HOTEL_CLOCK_HPP
@@ -1,9 +1,18 @@
+#include <concepts>
+#include <coroutine>
+
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
 #ifndef HOTEL_CONCEPTS_HPP
 #define HOTEL_CONCEPTS_HPP
 
-#include <concepts>
+HOTEL_MODULE_EXPORT namespace hotel {
+    struct motion_setpoint;
+}
 
-namespace hotel::concepts {
+HOTEL_MODULE_EXPORT namespace hotel::concepts {
 
     /**
      * @concept hotel::concepts::is_ratio_like<>
@@ -79,6 +88,225 @@ namespace hotel::concepts {
      */
     template <class input_t, class F>
     concept SettledFunction = is_settled_function<input_t, F>;
+
+    /**
+     * @concept hotel::concepts::is_micros_clock<>
+     *
+     * this concept is satisfied if `C` has a static `now()` returning a microsecond timestamp and a static
+     * `wait_until(std::uint64_t)` that blocks until that timestamp has passed
+     *
+     * @sa hotel::micros_clock
+     * @sa hotel::sim::virtual_clock
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class C>
+    concept is_micros_clock = requires(std::uint64_t t) {
+        { C::now() } -> std::convertible_to<std::uint64_t>;
+        C::wait_until(t);
+    };
+
+    /**
+     * @concept hotel::concepts::MicrosClock<>
+     *
+     * a type that satisfies `hotel::concepts::is_micros_clock<C>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class C>
+    concept MicrosClock = is_micros_clock<C>;
+
+    /**
+     * @concept hotel::concepts::is_resumable_controller<>
+     *
+     * this concept is satisfied if `C` can be run as a generator until settled, queried for its error and settled state
+     * without being stepped, and resumed without a bump in its output (as `hotel::pid_controller` can)
+     *
+     * @sa hotel::idle_wake_loop
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class C>
+    concept is_resumable_controller = requires(C c, typename C::target_t e) {
+        c.run();
+        { c.error() } -> std::convertible_to<typename C::target_t>;
+        { c.settled(e) } -> std::convertible_to<bool>;
+        c.resume();
+    };
+
+    /**
+     * @concept hotel::concepts::ResumableController<>
+     *
+     * a type that satisfies `hotel::concepts::is_resumable_controller<C>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class C>
+    concept ResumableController = is_resumable_controller<C>;
+
+    /**
+     * @concept hotel::concepts::is_flywheel_law<>
+     *
+     * this concept is satisfied if `L` is a velocity control law `hotel::flywheel_controller` can run: constructible from
+     * its `parameters`, with `update(setpoint, velocity, dt, limit)` producing an output and `reset(setpoint, velocity,
+     * last_output)` preparing it to carry on from a given state
+     *
+     * @sa hotel::flywheel_controller
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class L>
+    concept is_flywheel_law = std::constructible_from<L, typename L::parameters> &&
+        requires(L& l, float setpoint, float velocity, float dt, float limit) {
+            { l.update(setpoint, velocity, dt, limit) } -> std::convertible_to<float>;
+            l.reset(setpoint, velocity, limit);
+        };
+
+    /**
+     * @concept hotel::concepts::FlywheelLaw<>
+     *
+     * a type that satisfies `hotel::concepts::is_flywheel_law<L>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class L>
+    concept FlywheelLaw = is_flywheel_law<L>;
+
+    /**
+     * @concept hotel::concepts::is_feedforward_model<>
+     *
+     * this concept is satisfied if `M` can be evaluated against a `hotel::motion_setpoint` to produce an output
+     *
+     * @sa hotel::feedforward_adaptor
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class M>
+    concept is_feedforward_model = requires(const M& m, const motion_setpoint& s) {
+        { m(s) } -> std::convertible_to<float>;
+    };
+
+    /**
+     * @concept hotel::concepts::FeedforwardModel<>
+     *
+     * a type that satisfies `hotel::concepts::is_feedforward_model<M>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class M>
+    concept FeedforwardModel = is_feedforward_model<M>;
+
+    /**
+     * @concept hotel::concepts::is_steppable_controller<>
+     *
+     * this concept is satisfied if `C` can be run one iteration at a time, each call to `step()` reading its feedback
+     * and producing an `output_t`, and can be moved (as `hotel::flywheel_controller` and
+     * `hotel::self_tuning_controller` and `hotel::pid_controller` can)
+     *
+     * @sa hotel::controller_registry
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class C>
+    concept is_steppable_controller = std::move_constructible<C> && requires(C c) {
+        { c.step() } -> std::convertible_to<typename C::output_t>;
+    };
+
+    /**
+     * @concept hotel::concepts::SteppableController<>
+     *
+     * a type that satisfies `hotel::concepts::is_steppable_controller<C>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class C>
+    concept SteppableController = is_steppable_controller<C>;
+
+    /**
+     * @concept hotel::concepts::is_serial_link<>
+     *
+     * this concept is satisfied if `L` can move bytes in bulk the way `pros::Serial` does: `read` and `write` of a
+     * buffer, plus `get_read_avail` and `get_write_free` to size those transfers
+     *
+     * @sa hotel::serial_stream
+     * @sa hotel::sim::loopback_serial
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class L>
+    concept is_serial_link = requires(L& l, std::uint8_t* buffer, std::int32_t length) {
+        { l.read(buffer, length) } -> std::convertible_to<std::int32_t>;
+        { l.write(buffer, length) } -> std::convertible_to<std::int32_t>;
+        { l.get_read_avail() } -> std::convertible_to<std::int32_t>;
+        { l.get_write_free() } -> std::convertible_to<std::int32_t>;
+    };
+
+    /**
+     * @concept hotel::concepts::SerialLink<>
+     *
+     * a type that satisfies `hotel::concepts::is_serial_link<L>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class L>
+    concept SerialLink = is_serial_link<L>;
+
+    /**
+     * @concept hotel::concepts::is_inertial_sensor<>
+     *
+     * this concept is satisfied if `I` reports raw rates and accelerations the way `pros::Imu` does: `get_gyro_rate`
+     * and `get_accel` returning something with `x`, `y` and `z` members, plus `set_data_rate`
+     *
+     * @sa hotel::imu_pipeline
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class I>
+    concept is_inertial_sensor = requires(I& i, std::uint32_t rate) {
+        { i.get_gyro_rate().x } -> std::convertible_to<double>;
+        { i.get_gyro_rate().y } -> std::convertible_to<double>;
+        { i.get_gyro_rate().z } -> std::convertible_to<double>;
+        { i.get_accel().x } -> std::convertible_to<double>;
+        { i.get_accel().y } -> std::convertible_to<double>;
+        { i.get_accel().z } -> std::convertible_to<double>;
+        i.set_data_rate(rate);
+    };
+
+    /**
+     * @concept hotel::concepts::InertialSensor<>
+     *
+     * a type that satisfies `hotel::concepts::is_inertial_sensor<I>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class I>
+    concept InertialSensor = is_inertial_sensor<I>;
+
+    /**
+     * @concept hotel::concepts::is_executor<>
+     *
+     * this concept is satisfied if `E` can take a suspended coroutine and resume it later, somewhere: a
+     * `schedule(std::coroutine_handle<>)` member
+     *
+     * @sa hotel::coro::schedule_on
+     * @sa hotel::coro::thread_pool_executor
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class E>
+    concept is_executor = requires(E& e, std::coroutine_handle<> h) {
+        e.schedule(h);
+    };
+
+    /**
+     * @concept hotel::concepts::Executor<>
+     *
+     * a type that satisfies `hotel::concepts::is_executor<E>`
+     *
+     * @headerfile hotel/concepts.hpp
+     */
+    template <class E>
+    concept Executor = is_executor<E>;
 }
 
 #endif // HOTEL_CONCEPTS_HPP
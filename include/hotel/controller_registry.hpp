@@ -0,0 +1,285 @@
+#include <array>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_CONTROLLER_REGISTRY_HPP
+#define HOTEL_CONTROLLER_REGISTRY_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * a set of controllers of different types, stored one contiguous array per type and stepped a type at a time
+     *
+     * holding PID loops, flywheel controllers and self-tuning loops in one `std::vector<std::unique_ptr<Base>>` costs
+     * a virtual call per controller per tick, each to a different place on the heap, in whatever order they were
+     * registered. here every type gets an array of its own, inside the registry: `tick()` walks them one after the
+     * other, so each inner loop calls the same `step()` (which the compiler can inline, and vectorize if there's
+     * nothing in the way) on controllers that sit next to each other in memory. their outputs are kept in a parallel
+     * array per type.
+     *
+     * controllers are added with `emplace()` or `add()` and removed with `remove()`, both in constant time: a removed
+     * controller's place is filled by the last one of its type, so the arrays stay packed. what's handed out is a
+     * typed handle that goes through a slot table, so it keeps pointing at the same controller however the others
+     * move around, and stops working once the controller it named has been removed (up to 65536 reuses of the same
+     * slot). nothing is allocated.
+     *
+     * the registry isn't synchronized: add, remove and tick from one task.
+     *
+     * example:
+     * ```{.cpp}
+     * struct velocity_fn {
+     *     pros::Motor* motor;
+     *     float operator()() const { return static_cast<float>(motor->get_actual_velocity()); };
+     * };
+     * using flywheel_t = hotel::bang_bang_controller<velocity_fn>;
+     * using roller_t = hotel::self_tuning_controller<velocity_fn, std::function<bool(float)>>;
+     * static hotel::controller_registry<flywheel_t, roller_t> controllers;
+     *
+     * auto flywheel = controllers.emplace<flywheel_t>(flywheel_t::parameters{.kv = 19.0f}, velocity_fn{&fw}, 500.0f);
+     * auto roller = controllers.emplace<roller_t>(roller_t::options{.nominal_gain = 4.7f}, velocity_fn{&intake},
+     *                                             [] (float) { return false; }, 400.0f);
+     *
+     * while (true) {
+     *     controllers.tick();
+     *     fw.move_voltage(static_cast<std::int32_t>(controllers.output(flywheel)));
+     *     intake.move(static_cast<std::int32_t>(controllers.output(roller)));
+     *     pros::delay(10);
+     * }
+     * ```
+     *
+     * @tparam Capacity number of controllers of each type that can be held (at most 65535)
+     * @tparam Ts the controller types, each at most once
+     */
+    template <std::size_t Capacity, concepts::SteppableController... Ts>
+        requires (sizeof...(Ts) > 0 && Capacity > 0 && Capacity < std::numeric_limits<std::uint16_t>::max())
+    class basic_controller_registry {
+    public:
+        /**
+         * names one controller of type `T` in the registry
+         */
+        template <class T>
+        struct handle {
+            std::uint16_t slot = std::numeric_limits<std::uint16_t>::max();
+            std::uint16_t generation = 0;
+
+            /// whether this was returned by a successful add (it may have been removed since)
+            constexpr explicit operator bool() const noexcept { return slot < Capacity; };
+        };
+    private:
+        template <class T>
+        static constexpr bool holds = (std::is_same_v<T, Ts> + ...) == 1;
+
+        template <class T>
+        struct pool {
+            alignas(T) std::byte storage[sizeof(T) * Capacity];
+            std::array<typename T::output_t, Capacity> outputs{};
+            /// slot of each packed controller
+            std::array<std::uint16_t, Capacity> slot_of{};
+            /// where each live slot's controller is packed; the next free slot, for free ones
+            std::array<std::uint16_t, Capacity> index_of{};
+            std::array<std::uint16_t, Capacity> generation{};
+            std::uint16_t count = 0;
+            std::uint16_t free_head = 0;
+
+            pool() {
+                for (std::size_t i = 0; i < Capacity; i++) {
+                    index_of[i] = static_cast<std::uint16_t>(i + 1);
+                }
+            };
+
+            ~pool() {
+                std::destroy_n(data(), count);
+            };
+
+            T* data() noexcept { return std::launder(reinterpret_cast<T*>(storage)); };
+
+            const T* data() const noexcept { return std::launder(reinterpret_cast<const T*>(storage)); };
+
+            bool live(handle<T> h) const noexcept {
+                return h.slot < Capacity && generation[h.slot] == h.generation && index_of[h.slot] < count &&
+                       slot_of[index_of[h.slot]] == h.slot;
+            };
+
+            void step() {
+                T* controllers = data();
+                for (std::size_t i = 0; i < count; i++) {
+                    outputs[i] = controllers[i].step();
+                }
+            };
+        };
+
+        std::tuple<pool<Ts>...> pools;
+
+        template <class T>
+        pool<T>& pool_of() noexcept { return std::get<pool<T>>(pools); };
+
+        template <class T>
+        const pool<T>& pool_of() const noexcept { return std::get<pool<T>>(pools); };
+    public:
+        basic_controller_registry() = default;
+
+        // handles are only meaningful for the registry that issued them
+        basic_controller_registry(const basic_controller_registry&) = delete;
+        basic_controller_registry& operator=(const basic_controller_registry&) = delete;
+
+        /**
+         * construct a controller in place
+         *
+         * @param args the controller's constructor arguments
+         * @return a handle to it, which is empty (false) if there's no room for another `T`
+         */
+        template <class T, class... Args>
+            requires holds<T> && std::constructible_from<T, Args...>
+        handle<T> emplace(Args&&... args) {
+            auto& p = pool_of<T>();
+            if (p.count == Capacity) {
+                return {};
+            }
+            auto slot = p.free_head;
+            p.free_head = p.index_of[slot];
+            std::construct_at(p.data() + p.count, std::forward<Args>(args)...);
+            p.outputs[p.count] = {};
+            p.slot_of[p.count] = slot;
+            p.index_of[slot] = p.count++;
+            return {slot, p.generation[slot]};
+        };
+
+        /**
+         * move a controller in
+         *
+         * @return a handle to it, which is empty (false) if there's no room for another `T`
+         */
+        template <class T>
+            requires holds<std::remove_cvref_t<T>>
+        handle<std::remove_cvref_t<T>> add(T&& controller) {
+            return emplace<std::remove_cvref_t<T>>(std::forward<T>(controller));
+        };
+
+        /**
+         * remove a controller, moving the last one of its type into its place
+         *
+         * @return `false` if the handle didn't name a controller in the registry
+         */
+        template <class T>
+        bool remove(handle<T> h) {
+            auto& p = pool_of<T>();
+            if (!p.live(h)) {
+                return false;
+            }
+            auto index = p.index_of[h.slot];
+            auto last = static_cast<std::uint16_t>(p.count - 1);
+            T* controllers = p.data();
+            std::destroy_at(controllers + index);
+            if (index != last) {
+                std::construct_at(controllers + index, std::move(controllers[last]));
+                std::destroy_at(controllers + last);
+                p.outputs[index] = p.outputs[last];
+                p.slot_of[index] = p.slot_of[last];
+                p.index_of[p.slot_of[index]] = index;
+            }
+            p.count--;
+            p.generation[h.slot]++;
+            p.index_of[h.slot] = p.free_head;
+            p.free_head = h.slot;
+            return true;
+        };
+
+        /**
+         * @return whether the handle names a controller in the registry
+         */
+        template <class T>
+        bool contains(handle<T> h) const noexcept { return pool_of<T>().live(h); };
+
+        /**
+         * @return the controller a handle names, or `nullptr` if it's been removed; valid until the next add or remove
+         */
+        template <class T>
+        T* get(handle<T> h) noexcept {
+            auto& p = pool_of<T>();
+            return p.live(h) ? p.data() + p.index_of[h.slot] : nullptr;
+        };
+
+        /**
+         * @return the output of a controller's last step (0 before its first); the handle must be live
+         */
+        template <class T>
+        typename T::output_t output(handle<T> h) const noexcept {
+            const auto& p = pool_of<T>();
+            return p.outputs[p.index_of[h.slot]];
+        };
+
+        /**
+         * step every controller once, one type after another
+         */
+        void tick() { (pool_of<Ts>().step(), ...); };
+
+        /**
+         * step every controller once, and pass each output on as it's produced
+         *
+         * @param fn called with each controller (as its own type) and its output; a generic lambda is instantiated,
+         *           and inlined, once per type
+         */
+        template <class F>
+        void tick(F&& fn) {
+            ([&] {
+                auto& p = pool_of<Ts>();
+                Ts* controllers = p.data();
+                for (std::size_t i = 0; i < p.count; i++) {
+                    p.outputs[i] = controllers[i].step();
+                    fn(controllers[i], p.outputs[i]);
+                }
+            }(), ...);
+        };
+
+        /**
+         * @return every controller of type `T`, packed; the order changes when one is removed
+         */
+        template <class T>
+            requires holds<T>
+        std::span<T> all() noexcept {
+            auto& p = pool_of<T>();
+            return {p.data(), p.count};
+        };
+
+        /**
+         * @return the outputs of every controller of type `T`, in the same order as `all<T>()`
+         */
+        template <class T>
+            requires holds<T>
+        std::span<const typename T::output_t> outputs() const noexcept {
+            const auto& p = pool_of<T>();
+            return {p.outputs.data(), p.count};
+        };
+
+        /**
+         * @return number of controllers of type `T`
+         */
+        template <class T>
+            requires holds<T>
+        std::size_t size() const noexcept { return pool_of<T>().count; };
+
+        /**
+         * @return number of controllers of every type
+         */
+        std::size_t size() const noexcept { return (std::size_t{0} + ... + pool_of<Ts>().count); };
+    };
+
+    /**
+     * a controller registry with room for 16 controllers of each type
+     */
+    template <class... Ts>
+    using controller_registry = basic_controller_registry<16, Ts...>;
+}
+
+#endif // HOTEL_CONTROLLER_REGISTRY_HPP
@@ -1,24 +1,35 @@
 #include <coroutine>
+#include <exception>
 #include <iterator>
 #include <memory>
+#include <source_location>
+#include <type_traits>
+#include <utility>
 
 #include <cstddef>
 
+#include "hotel/coro/introspection.hpp"
+#include "hotel/export.hpp"
+
 #ifndef HOTEL_CORO_GENERATOR_HPP
 #define HOTEL_CORO_GENERATOR_HPP
 
-namespace hotel::coro {
+HOTEL_MODULE_EXPORT namespace hotel::coro {
 
         template<class T>
         class generator;
 
-        namespace {
+        namespace detail {
             template<class T>
-            struct generator_promise_type {
+            struct generator_promise_type : frame_hook {
                 using value_type = std::remove_reference<T>;
                 using reference_type = std::conditional_t<std::is_reference<T>::value, T, T &>;
                 using pointer_type = value_type *;
 
+                // the default argument is evaluated where the compiler creates the promise, i.e. it names the coroutine
+                explicit generator_promise_type(std::source_location where = std::source_location::current())
+                    : frame_hook(where) {};
+
                 static auto get_return_object_on_allocation_failure() { return generator<T>{nullptr}; };
 
                 auto get_return_object()
@@ -89,7 +100,7 @@ namespace hotel::coro {
                 };
 
                 generator_iterator &operator++() {
-                    coro.resume();
+                    generator_promise_type<T>::resume(coro);
                     if (coro.done()) {
                         coro.promise().rethrow_if_exception();
                     }
@@ -138,8 +149,8 @@ namespace hotel::coro {
         template<class T>
         class generator {
         public:
-            using promise_type = generator_promise_type<T>;
-            using iterator = generator_iterator<T>;
+            using promise_type = detail::generator_promise_type<T>;
+            using iterator = detail::generator_iterator<T>;
 
             generator() noexcept : coro(nullptr) {};
 
@@ -158,7 +169,7 @@ namespace hotel::coro {
              * advance the generator
              * @return `false` if the generator is finished
              */
-            bool next() { return coro ? (coro.resume(), !coro.done()) : false; };
+            bool next() { return coro ? (promise_type::resume(coro), !coro.done()) : false; };
 
             /**
              * get an iterator pointing to the start of the sequence
@@ -178,7 +189,7 @@ namespace hotel::coro {
              */
             iterator begin() {
                 if (coro) {
-                    coro.resume();
+                    promise_type::resume(coro);
                     if (coro.done()) {
                         coro.promise().rethrow_if_exception();
                     }
@@ -194,25 +205,35 @@ namespace hotel::coro {
              *
              * @return sentinel marking the end of the sequence
              */
-            generator_sentinel end() noexcept {
+            detail::generator_sentinel end() noexcept {
                 return {};
             }
         private:
             using handle = std::coroutine_handle<promise_type>;
 
-            friend class generator_promise_type<T>;
+            friend class detail::generator_promise_type<T>;
 
             explicit generator(handle h) : coro(h) {};
             handle coro;
         };
 
-        namespace {
+        namespace detail {
             // define this here now that generator is a complete type
             template<class T>
             auto generator_promise_type<T>::get_return_object() noexcept {
                 using handle = std::coroutine_handle<generator_promise_type<T>>;
                 return generator{handle::from_promise(*this)};
             };
+
+#ifndef HOTEL_CORO_STATS
+            // with the stats compiled out the hook is an empty base, and the promise is no bigger than its own members
+            struct unhooked_promise {
+                int current_value;
+                std::exception_ptr _exception;
+            };
+
+            static_assert(std::is_empty_v<frame_hook> && sizeof(generator_promise_type<int>) == sizeof(unhooked_promise));
+#endif
         }
 
 } // namespace hotel
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <new>
+#include <source_location>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/histogram.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_CORO_INTROSPECTION_HPP
+#define HOTEL_CORO_INTROSPECTION_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::coro {
+
+    /**
+     * per-coroutine frame and resume accounting
+     *
+     * a site is one coroutine function (one instantiation of it, for templates), identified by the source location
+     * the compiler gives its promise. each site tracks the size of the frames it allocates, how many have been
+     * created and destroyed (so how many are alive, and the most that ever were at once), and how long each resume took,
+     * from the caller's side of `resume()` until control came back. that time includes any coroutines resumed from
+     * inside, so a generator reading from another one also accounts for its source.
+     *
+     * `hotel::coro::generator` only feeds this when libhotel is built with `HOTEL_CORO_STATS` defined
+     * (`USE_CORO_STATS:=1` in the Makefile), and it has to be defined the same way for every translation unit. without
+     * it the hooks are empty and nothing here is compiled into the program.
+     *
+     * sites are registered into a fixed table from whichever task creates the first frame. the counters are atomic; the
+     * resume histogram isn't, so a site resumed from two tasks at once may lose the odd sample.
+     *
+     * example:
+     * ```{.cpp}
+     * // in a low-priority task, every few seconds
+     * hotel::coro::default_frame_stats().report(stdout);
+     * ```
+     *
+     * @tparam MaxSites number of coroutine functions that can be tracked
+     * @tparam Clock clock used to time resumes
+     */
+    template <std::size_t MaxSites = 32, concepts::MicrosClock Clock = micros_clock>
+    class basic_frame_stats {
+    public:
+        /// resume durations, 0-1ms in 10us buckets
+        using resume_histogram = histogram<100, 10>;
+
+        class site_t {
+            std::source_location where_;
+            std::atomic<bool> claimed{false};
+            std::atomic<std::uint32_t> frame_size_{0};
+            std::atomic<std::uint32_t> created_{0};
+            std::atomic<std::uint32_t> destroyed_{0};
+            std::atomic<std::uint32_t> peak_{0};
+            resume_histogram resumes_;
+
+            friend class basic_frame_stats;
+        public:
+            /**
+             * record a frame allocation
+             *
+             * @param size size of the frame, in bytes
+             */
+            void allocated(std::size_t size) {
+                auto s = static_cast<std::uint32_t>(size);
+                auto current = frame_size_.load(std::memory_order_relaxed);
+                while (current < s && !frame_size_.compare_exchange_weak(current, s, std::memory_order_relaxed)) {}
+            };
+
+            void constructed() {
+                auto live = created_.fetch_add(1, std::memory_order_relaxed) + 1 -
+                            destroyed_.load(std::memory_order_relaxed);
+                auto peak = peak_.load(std::memory_order_relaxed);
+                while (peak < live && !peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+            };
+
+            void destroyed() { destroyed_.fetch_add(1, std::memory_order_relaxed); };
+
+            /**
+             * record one resume
+             *
+             * @param start when `resume()` was called
+             * @param end when it returned
+             */
+            void resumed(std::uint64_t start, std::uint64_t end) {
+                resumes_.add(static_cast<std::uint32_t>(end - start));
+            };
+
+            const char* function() const noexcept { return where_.function_name(); };
+
+            const char* file() const noexcept { return where_.file_name(); };
+
+            std::uint32_t line() const noexcept { return where_.line(); };
+
+            /// largest frame allocated, in bytes
+            std::uint32_t frame_size() const noexcept { return frame_size_.load(std::memory_order_relaxed); };
+
+            std::uint32_t created() const noexcept { return created_.load(std::memory_order_relaxed); };
+
+            std::uint32_t destroyed() const noexcept { return destroyed_.load(std::memory_order_relaxed); };
+
+            /// frames currently alive
+            std::uint32_t live() const noexcept { return created() - destroyed(); };
+
+            /// most frames alive at once
+            std::uint32_t peak() const noexcept { return peak_.load(std::memory_order_relaxed); };
+
+            const resume_histogram& resumes() const noexcept { return resumes_; };
+        };
+    private:
+        std::array<site_t, MaxSites> sites;
+        std::atomic<std::size_t> count{0};
+        site_t overflow;
+
+        static bool same(const std::source_location& a, const std::source_location& b) {
+            return a.line() == b.line() && std::strcmp(a.function_name(), b.function_name()) == 0 &&
+                   std::strcmp(a.file_name(), b.file_name()) == 0;
+        };
+    public:
+        /**
+         * find or register the site for a coroutine
+         *
+         * if the table is full, a shared overflow site is returned, so recording never fails
+         *
+         * @param where the location the compiler gave the coroutine's promise
+         * @return the site
+         */
+        site_t& site(const std::source_location& where) {
+            auto n = std::min(count.load(std::memory_order_acquire), MaxSites);
+            for (std::size_t i = 0; i < n; i++) {
+                if (sites[i].claimed.load(std::memory_order_acquire) && same(sites[i].where_, where)) {
+                    return sites[i];
+                }
+            }
+
+            auto slot = count.fetch_add(1, std::memory_order_acq_rel);
+            if (slot >= MaxSites) {
+                return overflow;
+            }
+            sites[slot].where_ = where;
+            sites[slot].claimed.store(true, std::memory_order_release);
+            return sites[slot];
+        };
+
+        /**
+         * visit every registered site
+         *
+         * @param fn called with each `const site_t&`
+         */
+        template <class F>
+        void for_each(F&& fn) const {
+            auto n = std::min(count.load(std::memory_order_acquire), MaxSites);
+            for (std::size_t i = 0; i < n; i++) {
+                if (sites[i].claimed.load(std::memory_order_acquire)) {
+                    fn(sites[i]);
+                }
+            }
+            if (overflow.created()) {
+                fn(overflow);
+            }
+        };
+
+        /**
+         * write every site as `coro` telemetry records
+         *
+         * fields are: function, line, frame size, created, destroyed, live, peak live, resumes, mean, p99 and max resume
+         * time (sizes in bytes, times in microseconds). the function name has its commas replaced so the record still
+         * splits cleanly; the overflow site is written as `overflow`.
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            for_each([out, this] (const site_t& s) {
+                char name[96] = "overflow";
+                if (&s != &overflow) {
+                    std::strncpy(name, s.function(), sizeof(name) - 1);
+                    std::replace(name, name + sizeof(name), ',', ';');
+                }
+                telemetry::write(out, "coro", name, s.line(), s.frame_size(), s.created(), s.destroyed(), s.live(),
+                                 s.peak(), s.resumes().count(), s.resumes().mean(), s.resumes().percentile(0.99f),
+                                 s.resumes().max());
+            });
+        };
+    };
+
+    /**
+     * the frame statistics `hotel::coro::generator` records into
+     */
+    using frame_stats = basic_frame_stats<>;
+
+    /**
+     * @return the shared frame statistics
+     */
+    inline frame_stats& default_frame_stats() {
+        static frame_stats instance;
+        return instance;
+    };
+
+    namespace detail {
+#ifdef HOTEL_CORO_STATS
+        /**
+         * base of a promise type that records its coroutine into `default_frame_stats()`
+         *
+         * the promise has to take the location as a defaulted constructor argument itself and pass it on, so it's
+         * evaluated where the compiler constructs the promise (which reports the coroutine function) rather than here.
+         */
+        struct frame_hook {
+            frame_stats::site_t* site;
+
+            explicit frame_hook(const std::source_location& where) : site(&default_frame_stats().site(where)) {
+                site->constructed();
+            };
+
+            frame_hook(const frame_hook&) = delete;
+
+            ~frame_hook() { site->destroyed(); };
+
+            // `get_return_object_on_allocation_failure` means the frame allocation has to report failure with nullptr
+            static void* operator new(std::size_t size,
+                                      std::source_location where = std::source_location::current()) noexcept {
+                default_frame_stats().site(where).allocated(size);
+                return ::operator new(size, std::nothrow);
+            };
+
+            static void operator delete(void* frame, std::size_t) noexcept { ::operator delete(frame); };
+
+            template <class Promise>
+            static void resume(std::coroutine_handle<Promise> h) {
+                auto* s = h.promise().site;
+                auto start = micros_clock::now();
+                h.resume();
+                s->resumed(start, micros_clock::now());
+            };
+        };
+#else
+        struct frame_hook {
+            constexpr explicit frame_hook(const std::source_location&) noexcept {};
+
+            template <class Promise>
+            static void resume(std::coroutine_handle<Promise> h) { h.resume(); };
+        };
+#endif
+    }
+}
+
+#endif // HOTEL_CORO_INTROSPECTION_HPP
@@ -0,0 +1,232 @@
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_CORO_TASK_HPP
+#define HOTEL_CORO_TASK_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::coro {
+
+        template<class T>
+        class task;
+
+        namespace detail {
+            /// resumes whoever awaited the task once it's finished, without growing the stack
+            struct task_final_awaiter {
+                bool await_ready() const noexcept { return false; };
+
+                template<class Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+                    auto continuation = h.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                };
+
+                void await_resume() const noexcept {};
+            };
+
+            struct task_promise_base {
+                std::coroutine_handle<> continuation;
+                std::exception_ptr exception;
+
+                auto initial_suspend() noexcept { return std::suspend_always{}; };
+
+                auto final_suspend() noexcept { return task_final_awaiter{}; };
+
+                void unhandled_exception() { exception = std::current_exception(); };
+
+                void rethrow_if_exception() {
+                    if (exception) {
+                        std::rethrow_exception(exception);
+                    }
+                };
+            };
+
+            template<class T>
+            struct task_promise_type : task_promise_base {
+                std::optional<T> value;
+
+                task<T> get_return_object() noexcept;
+
+                template<class U>
+                    requires std::is_convertible_v<U &&, T>
+                void return_value(U &&v) { value.emplace(std::forward<U>(v)); };
+
+                T &result() {
+                    rethrow_if_exception();
+                    return *value;
+                };
+            };
+
+            template<>
+            struct task_promise_type<void> : task_promise_base {
+                task<void> get_return_object() noexcept;
+
+                void return_void() {};
+
+                void result() { rethrow_if_exception(); };
+            };
+        }
+
+        /**
+         * lazily-started coroutine that produces one value
+         *
+         * nothing runs until the task is awaited (or `resume()`d); awaiting it runs it to completion and evaluates to
+         * what it `co_return`ed, rethrowing anything it threw. when it finishes, whoever awaited it is resumed directly
+         * (symmetric transfer), so chains of tasks awaiting tasks don't grow the stack.
+         *
+         * a task doesn't care where it runs: it continues on whatever resumed it. on the brain that's the PROS task
+         * driving it; on the host, `co_await hotel::coro::schedule_on(pool)` moves it onto a
+         * `hotel::coro::thread_pool_executor`, which is what makes the same code run on many cores there.
+         *
+         * example:
+         * ```{.cpp}
+         * hotel::coro::task<double> settle_time(gains g) {
+         *     co_return simulate(g);
+         * }
+         *
+         * hotel::coro::task<double> best(std::span<const gains> candidates) {
+         *     double fastest = 1e9;
+         *     for (auto& g : candidates) {
+         *         fastest = std::min(fastest, co_await settle_time(g));
+         *     }
+         *     co_return fastest;
+         * }
+         *
+         * // drive it without an executor: runs until it first suspends on something that doesn't resume it inline
+         * auto t = best(candidates);
+         * t.resume();
+         * if (t.done()) printf("%f\n", t.result());
+         * ```
+         *
+         * @tparam T type of the result (`void` for none)
+         */
+        template<class T = void>
+        class task {
+        public:
+            using promise_type = detail::task_promise_type<T>;
+
+            task() noexcept : coro(nullptr) {};
+
+            task(task const &) = delete;
+
+            task(task &&rhs) noexcept : coro(std::exchange(rhs.coro, nullptr)) {};
+
+            task &operator=(task other) noexcept {
+                std::swap(coro, other.coro);
+                return *this;
+            }
+
+            ~task() { if (coro) coro.destroy(); };
+
+            /**
+             * @return `true` if the task has run to completion (or there is no task)
+             */
+            bool done() const noexcept { return !coro || coro.done(); };
+
+            /**
+             * run the task until it next suspends, without awaiting it
+             *
+             * for driving a task from ordinary code, e.g. a PROS task's loop
+             */
+            void resume() {
+                if (coro && !coro.done()) {
+                    coro.resume();
+                }
+            };
+
+            /**
+             * @return the task's result; only valid once `done()`. rethrows anything the task threw
+             */
+            decltype(auto) result() { return coro.promise().result(); };
+
+            auto operator co_await() & noexcept { return awaiter{coro}; };
+
+            auto operator co_await() && noexcept { return awaiter{coro}; };
+
+            /**
+             * @return an awaitable that runs the task to completion like `co_await`, but leaves its result (or
+             *         exception) in the task for `result()`
+             */
+            auto when_ready() noexcept {
+                struct ready_awaiter : awaiter {
+                    void await_resume() const noexcept {};
+                };
+                return ready_awaiter{{coro}};
+            };
+        private:
+            using handle = std::coroutine_handle<promise_type>;
+
+            friend struct detail::task_promise_type<T>;
+
+            struct awaiter {
+                handle coro;
+
+                bool await_ready() const noexcept { return !coro || coro.done(); };
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                    coro.promise().continuation = awaiting;
+                    return coro;
+                };
+
+                decltype(auto) await_resume() {
+                    if constexpr (std::is_void_v<T>) {
+                        coro.promise().result();
+                    } else {
+                        return T(std::move(coro.promise().result()));
+                    }
+                };
+            };
+
+            explicit task(handle h) : coro(h) {};
+
+            handle coro;
+        };
+
+        namespace detail {
+            // define these here now that task is a complete type
+            template<class T>
+            task<T> task_promise_type<T>::get_return_object() noexcept {
+                return task<T>{std::coroutine_handle<task_promise_type<T>>::from_promise(*this)};
+            };
+
+            inline task<void> task_promise_type<void>::get_return_object() noexcept {
+                return task<void>{std::coroutine_handle<task_promise_type<void>>::from_promise(*this)};
+            };
+        }
+
+        /**
+         * move the awaiting coroutine onto an executor
+         *
+         * ```{.cpp}
+         * hotel::coro::task<double> run(hotel::coro::thread_pool_executor& pool, gains g) {
+         *     co_await hotel::coro::schedule_on(pool);
+         *     // from here on, running on one of the pool's threads
+         *     co_return simulate(g);
+         * }
+         * ```
+         *
+         * @param executor anything with a `schedule(std::coroutine_handle<>)` that resumes the handle later
+         * @return an awaitable that suspends, hands the coroutine to `executor`, and resumes wherever it's resumed
+         */
+        template<concepts::Executor E>
+        auto schedule_on(E &executor) noexcept {
+            struct awaiter {
+                E &executor;
+
+                bool await_ready() const noexcept { return false; };
+
+                void await_suspend(std::coroutine_handle<> h) { executor.schedule(h); };
+
+                void await_resume() const noexcept {};
+            };
+            return awaiter{executor};
+        };
+
+} // namespace hotel
+
+#endif // HOTEL_CORO_TASK_HPP
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/coro/task.hpp"
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_CORO_THREAD_POOL_HPP
+#define HOTEL_CORO_THREAD_POOL_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::coro {
+
+        /**
+         * work-stealing thread pool for coroutines, for tools running on the host
+         *
+         * there are no threads on the brain, so this header is left out of the `hotel` module and `src/hotel.cpp`;
+         * include it from host tools only. the tasks it runs are ordinary `hotel::coro::task`s, the same ones the robot
+         * code uses, moved onto the pool with `co_await hotel::coro::schedule_on(pool)`.
+         *
+         * every worker thread has its own deque. a coroutine scheduled from a worker goes on the back of that worker's
+         * deque, and the worker takes from the back (newest first, which is what's still in cache); one scheduled from
+         * outside the pool is dealt round-robin. a worker with nothing left steals from the front of the others'
+         * deques (oldest first, which tends to be the biggest piece of work left), and sleeps only once there's nothing
+         * queued anywhere.
+         *
+         * example:
+         * ```{.cpp}
+         * hotel::coro::task<double> score(hotel::coro::thread_pool_executor& pool, gains g) {
+         *     co_await hotel::coro::schedule_on(pool);
+         *     co_return simulate(g);
+         * }
+         *
+         * hotel::coro::thread_pool_executor pool;
+         * std::vector<hotel::coro::task<double>> runs;
+         * for (auto& g : candidates) runs.push_back(score(pool, g));
+         * hotel::coro::sync_wait_all(std::span{runs});
+         * for (auto& r : runs) printf("%f\n", r.result());
+         * ```
+         */
+        class thread_pool_executor {
+        public:
+            struct statistics {
+                /// coroutines resumed
+                std::uint64_t executed = 0;
+                /// of those, how many were taken from another worker's deque
+                std::uint64_t stolen = 0;
+                /// times a worker found nothing to do and went to sleep
+                std::uint64_t sleeps = 0;
+            };
+        private:
+            struct worker {
+                std::mutex lock;
+                std::deque<std::coroutine_handle<>> queue;
+                std::atomic<std::uint64_t> executed{0};
+                std::atomic<std::uint64_t> stolen{0};
+                std::atomic<std::uint64_t> sleeps{0};
+            };
+
+            /// which pool and worker the current thread is, if any
+            struct identity {
+                thread_pool_executor* pool;
+                std::size_t index;
+            };
+
+            static inline thread_local identity current{};
+
+            std::vector<std::unique_ptr<worker>> workers;
+            std::vector<std::thread> threads;
+            std::atomic<std::size_t> pending{0};
+            std::atomic<std::size_t> sleepers{0};
+            std::atomic<std::size_t> next{0};
+            std::mutex sleep_lock;
+            std::condition_variable wake;
+            bool stopping = false;
+
+            std::coroutine_handle<> pop(std::size_t self) {
+                {
+                    auto& w = *workers[self];
+                    std::lock_guard guard{w.lock};
+                    if (!w.queue.empty()) {
+                        auto h = w.queue.back();
+                        w.queue.pop_back();
+                        return h;
+                    }
+                }
+                for (std::size_t i = 1; i < workers.size(); i++) {
+                    auto& victim = *workers[(self + i) % workers.size()];
+                    std::lock_guard guard{victim.lock};
+                    if (!victim.queue.empty()) {
+                        auto h = victim.queue.front();
+                        victim.queue.pop_front();
+                        workers[self]->stolen.fetch_add(1, std::memory_order_relaxed);
+                        return h;
+                    }
+                }
+                return nullptr;
+            };
+
+            void run(std::size_t self) {
+                current = {this, self};
+                while (true) {
+                    if (auto h = pop(self)) {
+                        pending.fetch_sub(1);
+                        workers[self]->executed.fetch_add(1, std::memory_order_relaxed);
+                        h.resume();
+                        continue;
+                    }
+
+                    std::unique_lock guard{sleep_lock};
+                    // counted before the check, so `schedule()` either sees a sleeper or the check sees its work
+                    sleepers.fetch_add(1);
+                    if (!stopping && pending.load() == 0) {
+                        workers[self]->sleeps.fetch_add(1, std::memory_order_relaxed);
+                        wake.wait(guard, [this] { return stopping || pending.load() > 0; });
+                    }
+                    sleepers.fetch_sub(1);
+                    if (stopping && pending.load() == 0) {
+                        return;
+                    }
+                }
+            };
+        public:
+            /**
+             * start the worker threads
+             *
+             * @param threads number of workers; defaults to one per hardware thread
+             */
+            explicit thread_pool_executor(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+                threads = std::max<std::size_t>(threads, 1);
+                for (std::size_t i = 0; i < threads; i++) {
+                    workers.push_back(std::make_unique<worker>());
+                }
+                for (std::size_t i = 0; i < threads; i++) {
+                    this->threads.emplace_back([this, i] { run(i); });
+                }
+            };
+
+            thread_pool_executor(const thread_pool_executor&) = delete;
+
+            thread_pool_executor& operator=(const thread_pool_executor&) = delete;
+
+            /**
+             * run everything still queued, then stop and join the workers
+             */
+            ~thread_pool_executor() {
+                {
+                    std::lock_guard guard{sleep_lock};
+                    stopping = true;
+                }
+                wake.notify_all();
+                for (auto& t : threads) {
+                    t.join();
+                }
+            };
+
+            /**
+             * queue a suspended coroutine to be resumed on one of the workers
+             *
+             * satisfies `hotel::concepts::Executor`; usually reached through `schedule_on(pool)`
+             *
+             * @param h the coroutine
+             */
+            void schedule(std::coroutine_handle<> h) {
+                auto target = current.pool == this ? current.index
+                                                   : next.fetch_add(1, std::memory_order_relaxed) % workers.size();
+                // counted before it's queued, so a worker can't take it and count it off first
+                pending.fetch_add(1);
+                {
+                    auto& w = *workers[target];
+                    std::lock_guard guard{w.lock};
+                    w.queue.push_back(h);
+                }
+                if (sleepers.load() > 0) {
+                    std::lock_guard guard{sleep_lock};
+                    wake.notify_one();
+                }
+            };
+
+            std::size_t size() const noexcept { return workers.size(); };
+
+            /**
+             * @return totals over every worker
+             */
+            statistics stats() const {
+                statistics s;
+                for (auto& w : workers) {
+                    s.executed += w->executed.load(std::memory_order_relaxed);
+                    s.stolen += w->stolen.load(std::memory_order_relaxed);
+                    s.sleeps += w->sleeps.load(std::memory_order_relaxed);
+                }
+                return s;
+            };
+        };
+
+        namespace detail {
+            /// fire-and-forget coroutine that counts a latch down once it's finished
+            struct latch_task {
+                struct promise_type {
+                    std::latch* done = nullptr;
+
+                    latch_task get_return_object() noexcept {
+                        return {std::coroutine_handle<promise_type>::from_promise(*this)};
+                    };
+
+                    auto initial_suspend() noexcept { return std::suspend_always{}; };
+
+                    auto final_suspend() noexcept {
+                        struct signal {
+                            bool await_ready() const noexcept { return false; };
+
+                            // after suspending, so the waiting thread can destroy the frame as soon as it wakes
+                            void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                                h.promise().done->count_down();
+                            };
+
+                            void await_resume() const noexcept {};
+                        };
+                        return signal{};
+                    };
+
+                    void unhandled_exception() noexcept { std::terminate(); };
+
+                    void return_void() {};
+                };
+
+                std::coroutine_handle<promise_type> coro;
+            };
+
+            template<class T>
+            latch_task await_and_signal(task<T>& t) {
+                // exceptions stay in `t`, for whoever reads its result
+                co_await t.when_ready();
+            };
+        }
+
+        /**
+         * run tasks to completion, blocking the calling thread until every one has finished
+         *
+         * each task starts on the calling thread and stays there until it moves itself elsewhere (with `schedule_on`),
+         * so the ones that should run in parallel need to do that first. results (and exceptions) stay in the tasks.
+         *
+         * @param tasks the tasks
+         */
+        template<class T>
+        void sync_wait_all(std::span<task<T>> tasks) {
+            std::latch done{static_cast<std::ptrdiff_t>(tasks.size())};
+            std::vector<detail::latch_task> waiters;
+            waiters.reserve(tasks.size());
+            for (auto& t : tasks) {
+                waiters.push_back(detail::await_and_signal(t));
+                waiters.back().coro.promise().done = &done;
+            }
+            for (auto& w : waiters) {
+                w.coro.resume();
+            }
+            done.wait();
+            for (auto& w : waiters) {
+                w.coro.destroy();
+            }
+        };
+
+        /**
+         * run a task to completion, blocking the calling thread until it's finished
+         *
+         * @param t the task
+         * @return its result; rethrows anything it threw
+         */
+        template<class T>
+        T sync_wait(task<T> t) {
+            sync_wait_all(std::span<task<T>>{&t, 1});
+            return t.result();
+        };
+
+} // namespace hotel
+
+#endif // HOTEL_CORO_THREAD_POOL_HPP
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_DISTURBANCE_OBSERVER_HPP
+#define HOTEL_DISTURBANCE_OBSERVER_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * disturbance observer: estimates the load on a mechanism from what it was told to do and what it did
+     *
+     * the mechanism is modeled as a first-order response of its velocity to the command,
+     * @f$\tau \dot{v} = K (u(t - t_d) - d) - v@f$, with @f$d@f$ everything the model doesn't account for (gravity, a
+     * game object picked up, another robot pushing back) lumped into one input-referred disturbance. every tick the
+     * model is inverted on the measured velocity to find the command that would explain it; the difference from the
+     * command actually applied is the disturbance, which is smoothed by the Q-filter (first order, time constant
+     * `filter_time_constant`) and added back onto the next command. the controller then only sees the mechanism the
+     * model describes, so a new load is cancelled in a few filter time constants instead of waiting on an integral to
+     * build up.
+     *
+     * it doesn't care what the controller is: call `update()` with the measurement once per tick, then pass the
+     * controller's output through `compensate()` on its way to the motor. the slower the filter, the less noise gets
+     * through, and the more slowly loads are rejected; it should be slower than the dead time, and the nominal model
+     * only needs to be roughly right.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Motor lift{2};
+     * hotel::disturbance_observer<> observer{{.gain = 9.4f, .time_constant = 0.08f, .dead_time_us = 10000,
+     *                                         .measurement = hotel::disturbance_observer<>::position}};
+     *
+     * for (std::int32_t output : lift_controller.run()) {
+     *     observer.update(lift.get_position());
+     *     lift.move(static_cast<std::int32_t>(observer.compensate(output)));
+     *     pros::delay(10);
+     * }
+     * ```
+     *
+     * @tparam MaxDelay largest dead time it can model, in ticks
+     */
+    template <std::size_t MaxDelay = 8>
+    class disturbance_observer {
+    public:
+        enum measured {
+            /// `update()` is given the velocity the model describes
+            velocity,
+            /// `update()` is given a position, which is differenced into a velocity
+            position
+        };
+
+        struct parameters {
+            /// nominal steady-state velocity per unit of command
+            float gain = 1.0f;
+            /// nominal time constant, in seconds
+            float time_constant = 0.05f;
+            /// nominal delay between a command and the response starting, in microseconds (rounded to whole ticks)
+            std::uint32_t dead_time_us = 0;
+            /// Q-filter time constant, in seconds
+            float filter_time_constant = 0.05f;
+            /// tick period, in milliseconds
+            std::uint32_t period_ms = 10;
+            /// the motor's command limit; compensated commands are clamped to it (127 for `pros::Motor::move`)
+            float output_limit = 127.0f;
+            /// largest disturbance estimate, in command units
+            float max_estimate = 127.0f;
+            measured measurement = velocity;
+        };
+    private:
+        parameters params;
+        float a;
+        float q;
+        std::size_t delay;
+
+        std::array<float, MaxDelay + 1> applied{};
+        std::size_t head = 0;
+
+        float last_measurement = 0.0f;
+        float last_velocity = 0.0f;
+        float estimate_ = 0.0f;
+        std::uint8_t primed = 0;
+    public:
+        explicit disturbance_observer(parameters p) :
+            params(p),
+            a(std::exp(-(p.period_ms * 1e-3f) / p.time_constant)),
+            q(1.0f - std::exp(-(p.period_ms * 1e-3f) / p.filter_time_constant)),
+            delay(std::min<std::size_t>(p.period_ms ? (p.dead_time_us + p.period_ms * 500) / (p.period_ms * 1000) : 0,
+                                        MaxDelay)) {};
+
+        /**
+         * feed this tick's measurement in, before `compensate()`
+         *
+         * @param measurement velocity or position, as set in the parameters
+         * @return the updated disturbance estimate
+         */
+        float update(float measurement) {
+            float v = measurement;
+            if (params.measurement == position) {
+                v = (measurement - last_measurement) / (params.period_ms * 1e-3f);
+                last_measurement = measurement;
+                if (primed == 0) {
+                    primed = 1;
+                    return estimate_;
+                }
+            }
+            if (primed < 2) {
+                primed = 2;
+                last_velocity = v;
+                return estimate_;
+            }
+
+            // the command that acted over the last period, `delay` ticks before it was applied
+            float u = applied[(head + MaxDelay + 1 - 1 - delay) % (MaxDelay + 1)];
+            float explained = (v - a * last_velocity) / ((1.0f - a) * params.gain);
+            last_velocity = v;
+
+            estimate_ += q * ((u - explained) - estimate_);
+            estimate_ = std::clamp(estimate_, -params.max_estimate, params.max_estimate);
+            return estimate_;
+        };
+
+        /**
+         * add the disturbance estimate to a command, and remember what was applied
+         *
+         * @param command the controller's output
+         * @return the command to send to the motor, clamped to `output_limit`
+         */
+        float compensate(float command) {
+            float u = std::clamp(command + estimate_, -params.output_limit, params.output_limit);
+            applied[head] = u;
+            head = (head + 1) % (MaxDelay + 1);
+            return u;
+        };
+
+        /**
+         * @return the current disturbance estimate, in command units
+         */
+        float estimate() const noexcept { return estimate_; };
+
+        /**
+         * forget the estimate and the command history (e.g. after the mechanism was disabled)
+         */
+        void reset() {
+            applied.fill(0.0f);
+            estimate_ = 0.0f;
+            primed = 0;
+        };
+    };
+}
+
+#endif // HOTEL_DISTURBANCE_OBSERVER_HPP
@@ -0,0 +1,15 @@
+#ifndef HOTEL_EXPORT_HPP
+#define HOTEL_EXPORT_HPP
+
+/**
+ * marks a namespace as exported when the headers are compiled as part of the `hotel` named module
+ *
+ * expands to nothing for ordinary `#include` use; `hotel.cppm` redefines it to `export`.
+ *
+ * @sa include/hotel/hotel.cppm
+ */
+#ifndef HOTEL_MODULE_EXPORT
+#define HOTEL_MODULE_EXPORT
+#endif
+
+#endif // HOTEL_EXPORT_HPP
@@ -0,0 +1,265 @@
+#include <concepts>
+#include <numbers>
+
+#include "hotel/concepts.hpp"
+#include "hotel/coro/generator.hpp"
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_FEEDFORWARD_HPP
+#define HOTEL_FEEDFORWARD_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    namespace detail {
+        /**
+         * @f$\cos x@f$ to about 3e-5, in a handful of multiply-adds
+         *
+         * reduced to @f$[0, \pi/2]@f$ by symmetry, then the Taylor series through @f$x^8@f$, which is as far as it
+         * needs to go there
+         */
+        constexpr float fast_cos(float x) {
+            constexpr float pi = std::numbers::pi_v<float>;
+            constexpr float inverse_tau = 0.5f / pi;
+            float turns = x * inverse_tau + 0.5f;
+            auto whole = static_cast<float>(static_cast<int>(turns) - (turns < 0.0f ? 1 : 0));
+            // now in [-pi, pi)
+            x -= 2.0f * pi * whole;
+            float a = x < 0.0f ? -x : x;
+            float sign = 1.0f;
+            if (a > 0.5f * pi) {
+                a = pi - a;
+                sign = -1.0f;
+            }
+            float a2 = a * a;
+            return sign * (1.0f + a2 * (-1.0f / 2.0f + a2 * (1.0f / 24.0f + a2 * (-1.0f / 720.0f + a2 / 40320.0f))));
+        };
+
+        constexpr float sgn(float v) { return v > 0.0f ? 1.0f : v < 0.0f ? -1.0f : 0.0f; };
+    }
+
+    /**
+     * where a mechanism should be this tick, and how it should be moving: one sample of a motion profile
+     *
+     * units are the mechanism's own (degrees, inches, rpm...), per second and per second squared, and have to match the
+     * ones the feedforward gains were measured in.
+     */
+    struct motion_setpoint {
+        float position = 0.0f;
+        float velocity = 0.0f;
+        float acceleration = 0.0f;
+    };
+
+    /**
+     * @f$k_S \operatorname{sgn}(v) + k_V v + k_A a@f$: friction, back-EMF and inertia
+     *
+     * on its own, the model for a flywheel, a roller, or one side of a drivetrain. the output is in whatever the
+     * controller it's added to produces (`move()` units, millivolts...).
+     */
+    struct simple_feedforward {
+        /// output that just overcomes static friction
+        float ks = 0.0f;
+        /// output per unit of velocity
+        float kv = 0.0f;
+        /// output per unit of acceleration
+        float ka = 0.0f;
+
+        constexpr float operator()(float velocity, float acceleration = 0.0f) const {
+            return ks * detail::sgn(velocity) + kv * velocity + ka * acceleration;
+        };
+
+        constexpr float operator()(const motion_setpoint& s) const { return (*this)(s.velocity, s.acceleration); };
+    };
+
+    /**
+     * `simple_feedforward` plus a constant @f$k_G@f$ holding the load up: a lift or elevator
+     */
+    struct elevator_feedforward {
+        float ks = 0.0f;
+        /// output that holds the lift still against gravity
+        float kg = 0.0f;
+        float kv = 0.0f;
+        float ka = 0.0f;
+
+        constexpr float operator()(float velocity, float acceleration = 0.0f) const {
+            return kg + ks * detail::sgn(velocity) + kv * velocity + ka * acceleration;
+        };
+
+        constexpr float operator()(const motion_setpoint& s) const { return (*this)(s.velocity, s.acceleration); };
+    };
+
+    /**
+     * `simple_feedforward` plus @f$k_G \cos\theta@f$: a pivoting arm, whose gravity torque is greatest when it's level
+     *
+     * the angle is taken from the setpoint's position, converted to radians from horizontal with `scale` and
+     * `horizontal`, so the gains can be in the same units as the position controller under it.
+     */
+    struct arm_feedforward {
+        float ks = 0.0f;
+        /// output that holds the arm level
+        float kg = 0.0f;
+        float kv = 0.0f;
+        float ka = 0.0f;
+        /// position at which the arm is level, in position units
+        float horizontal = 0.0f;
+        /// radians per position unit (the default is for degrees)
+        float scale = std::numbers::pi_v<float> / 180.0f;
+
+        constexpr float operator()(float position, float velocity, float acceleration = 0.0f) const {
+            return kg * detail::fast_cos((position - horizontal) * scale) + ks * detail::sgn(velocity) +
+                   kv * velocity + ka * acceleration;
+        };
+
+        constexpr float operator()(const motion_setpoint& s) const {
+            return (*this)(s.position, s.velocity, s.acceleration);
+        };
+    };
+
+    /**
+     * per-side feedforward for a differential drivetrain, from its linear and angular motion
+     *
+     * the turning gains are separate from the driving ones because turning scrubs the wheels sideways, so it costs
+     * more than the same wheel speeds driving straight would.
+     */
+    struct differential_feedforward {
+        /// against forward velocity and acceleration
+        simple_feedforward linear;
+        /// against angular velocity and acceleration (counter-clockwise positive)
+        simple_feedforward angular;
+
+        struct sides {
+            float left;
+            float right;
+        };
+
+        constexpr sides operator()(float velocity, float angular_velocity, float acceleration = 0.0f,
+                                   float angular_acceleration = 0.0f) const {
+            float forward = linear(velocity, acceleration);
+            float turn = angular(angular_velocity, angular_acceleration);
+            return {forward - turn, forward + turn};
+        };
+    };
+
+    /**
+     * a feedback controller with a feedforward model added to its output
+     *
+     * the feedforward supplies what the model says the mechanism needs to follow the reference (hold against gravity,
+     * overcome friction, accelerate), so the controller under it only has to correct for what the model gets wrong and
+     * its gains no longer have to fight the load. the adaptor has the same interface as the controller, so it can be
+     * used anywhere the controller can, including `hotel::idle_wake_loop`.
+     *
+     * every tick of a motion profile, pass its sample to `track()`: the model is evaluated against it, and if the
+     * controller has a `follow()` (as `hotel::pid_controller` does) its setpoint is moved along with it. the adaptor
+     * isn't settled while the reference is still moving (nonzero velocity or acceleration), whatever the controller
+     * thinks: a controller that settles partway through the profile, or on its first sample, is stepped on until the
+     * reference stops, and `run()` only finishes once it's settled on where the profile ends.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Motor lift{2};
+     * hotel::motor_position_controller<std::ratio<1, 2>, std::ratio<0>, std::ratio<1, 100>> pid{
+     *     [&lift] { return lift.get_position(); },
+     *     [] (double error) { return std::fabs(error) < 5; }
+     * };
+     * hotel::feedforward_adaptor controller{pid, hotel::elevator_feedforward{.ks = 4.0f, .kg = 18.0f, .kv = 0.08f}};
+     *
+     * auto sample = profile.begin();
+     * for (std::int32_t output : controller.track(*sample).run()) {
+     *     lift.move(std::clamp(output, std::int32_t{-127}, std::int32_t{127}));
+     *     pros::delay(10);
+     *     if (++sample != profile.end()) {
+     *         controller.track(*sample);
+     *     }
+     * }
+     * ```
+     *
+     * @tparam Controller controller type (e.g. `hotel::pid_controller<...>`)
+     * @tparam Model feedforward model type, e.g. `elevator_feedforward`
+     */
+    template <concepts::ResumableController Controller, concepts::FeedforwardModel Model>
+    class feedforward_adaptor {
+    public:
+        using target_t = typename Controller::target_t;
+        using output_t = typename Controller::output_t;
+    private:
+        Controller& controller;
+        Model model;
+        motion_setpoint reference;
+        float feedforward;
+    public:
+        /**
+         * @param c the controller; must outlive the adaptor
+         * @param m the feedforward model
+         * @param s initial reference
+         */
+        feedforward_adaptor(Controller& c, Model m, motion_setpoint s = {}) :
+            controller(c),
+            model(m),
+            reference(s),
+            feedforward(m(s)) {};
+
+        /**
+         * move the reference, e.g. to the next sample of a motion profile
+         *
+         * @param s where the mechanism should be, and how it should be moving
+         * @return this instance
+         */
+        feedforward_adaptor& track(motion_setpoint s) {
+            reference = s;
+            feedforward = model(s);
+            if constexpr (requires { controller.follow(static_cast<target_t>(s.position)); }) {
+                controller.follow(static_cast<target_t>(s.position));
+            }
+            return *this;
+        };
+
+        /**
+         * the controller's generator, with the feedforward for the current reference added to every output
+         *
+         * while the reference is moving, the controller settling doesn't end this: its generator is restarted for as
+         * long as it's off the reference again, and it's stepped directly (if it has a `step()`, as
+         * `hotel::pid_controller` does; otherwise only the feedforward is output) for as long as it isn't.
+         */
+        coro::generator<output_t> run() {
+            while (true) {
+                for (const auto& output : controller.run()) {
+                    co_yield static_cast<output_t>(output + feedforward);
+                }
+                if (!moving()) {
+                    break;
+                }
+
+                if constexpr (requires { controller.step(); }) {
+                    co_yield static_cast<output_t>(controller.step() + feedforward);
+                } else {
+                    co_yield static_cast<output_t>(feedforward);
+                }
+            }
+        };
+
+        target_t error() { return controller.error(); };
+
+        /**
+         * @return whether the reference has stopped and the controller is settled at the given error
+         */
+        bool settled(target_t error) { return !moving() && controller.settled(error); };
+
+        /**
+         * @return whether the reference is still moving (has a nonzero velocity or acceleration)
+         */
+        bool moving() const noexcept { return reference.velocity != 0.0f || reference.acceleration != 0.0f; };
+
+        feedforward_adaptor& resume() {
+            controller.resume();
+            return *this;
+        };
+
+        /**
+         * @return the feedforward for the current reference
+         */
+        float output() const noexcept { return feedforward; };
+
+        const motion_setpoint& setpoint() const noexcept { return reference; };
+    };
+}
+
+#endif // HOTEL_FEEDFORWARD_HPP
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <span>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_FIELD_INDEX_HPP
+#define HOTEL_FIELD_INDEX_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * uniform-grid spatial index over the field, for nearest-object and within-radius queries every tick
+     *
+     * the 144" field is split into square cells, and every object is filed in the cell under it. each cell keeps its
+     * objects' ids and coordinates in parallel arrays (structure of arrays), so a query reads a few short runs of
+     * floats from the cells near the query point instead of every object on the field. inserting, moving and removing
+     * an object are constant time: an object remembers its cell and its slot there, and leaving a cell swaps the cell's
+     * last entry into the gap.
+     *
+     * `nearest` searches outwards a ring of cells at a time, and stops as soon as nothing in the next ring could be
+     * closer than the best found so far. coordinates are in inches from a field corner; anything off the field is filed
+     * in the nearest edge cell, and distances to it are still exact.
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::field_index<> objects;
+     * objects.insert(7, 36.0f, 72.0f, ring);
+     *
+     * // every tick
+     * objects.move(7, tracked.x, tracked.y);
+     * auto target = objects.nearest(pose.x, pose.y, [&](auto id) { return objects.kind(id) == ring && reachable(id); });
+     * if (target) drive_to(objects.position(target->id));
+     * ```
+     *
+     * @tparam MaxObjects number of object ids (ids are `0` to `MaxObjects - 1`, chosen by the caller)
+     * @tparam CellCapacity most objects one cell can hold
+     * @tparam CellInches side of a cell, in inches; should divide 144
+     */
+    template <std::size_t MaxObjects = 512, std::size_t CellCapacity = 16, std::uint32_t CellInches = 12>
+        requires (MaxObjects < 0xffff && CellCapacity < 0xff && CellInches > 0)
+    class field_index {
+    public:
+        using id_t = std::uint16_t;
+
+        static constexpr float field_inches = 144.0f;
+        static constexpr float cell_inches = static_cast<float>(CellInches);
+        static constexpr std::size_t cells_per_side = (144 + CellInches - 1) / CellInches;
+
+        struct point {
+            float x;
+            float y;
+        };
+
+        struct hit {
+            id_t id;
+            /// distance from the query point, in inches
+            float distance;
+        };
+    private:
+        static constexpr std::uint16_t absent = 0xffff;
+
+        struct cell {
+            std::array<float, CellCapacity> x;
+            std::array<float, CellCapacity> y;
+            std::array<id_t, CellCapacity> id;
+            std::uint8_t count = 0;
+        };
+
+        std::array<cell, cells_per_side * cells_per_side> cells{};
+        std::array<point, MaxObjects> positions{};
+        std::array<std::uint16_t, MaxObjects> cell_of;
+        std::array<std::uint8_t, MaxObjects> slot_of{};
+        std::array<std::uint8_t, MaxObjects> kinds{};
+        std::size_t count = 0;
+
+        static std::size_t coordinate(float v) {
+            auto c = static_cast<int>(v / cell_inches);
+            return static_cast<std::size_t>(std::clamp(c, 0, static_cast<int>(cells_per_side) - 1));
+        };
+
+        static std::uint16_t cell_at(float x, float y) {
+            return static_cast<std::uint16_t>(coordinate(y) * cells_per_side + coordinate(x));
+        };
+
+        bool file(id_t id, std::uint16_t c, float x, float y) {
+            auto& bucket = cells[c];
+            if (bucket.count == CellCapacity) {
+                return false;
+            }
+            auto slot = bucket.count++;
+            bucket.x[slot] = x;
+            bucket.y[slot] = y;
+            bucket.id[slot] = id;
+            cell_of[id] = c;
+            slot_of[id] = slot;
+            return true;
+        };
+
+        void unfile(id_t id) {
+            auto& bucket = cells[cell_of[id]];
+            auto slot = slot_of[id];
+            auto last = --bucket.count;
+            if (slot != last) {
+                bucket.x[slot] = bucket.x[last];
+                bucket.y[slot] = bucket.y[last];
+                bucket.id[slot] = bucket.id[last];
+                slot_of[bucket.id[slot]] = slot;
+            }
+            cell_of[id] = absent;
+        };
+
+        /// nearest object in one cell that passes `filter`, if it's closer than `best` (squared distance)
+        template <class F>
+        void search(const cell& bucket, float x, float y, float& best, id_t& found, F& filter) const {
+            for (std::size_t i = 0; i < bucket.count; i++) {
+                float dx = bucket.x[i] - x, dy = bucket.y[i] - y;
+                float d = dx * dx + dy * dy;
+                if (d < best && filter(bucket.id[i])) {
+                    best = d;
+                    found = bucket.id[i];
+                }
+            }
+        };
+    public:
+        field_index() { cell_of.fill(absent); };
+
+        /**
+         * add an object
+         *
+         * @param id the object's id; must not already be in the index
+         * @param x position, in inches
+         * @param y position, in inches
+         * @param kind caller-defined tag (game element type, alliance, ...)
+         * @return `false` if the id is out of range or taken, or the cell is full
+         */
+        bool insert(id_t id, float x, float y, std::uint8_t kind = 0) {
+            if (id >= MaxObjects || cell_of[id] != absent || !file(id, cell_at(x, y), x, y)) {
+                return false;
+            }
+            positions[id] = {x, y};
+            kinds[id] = kind;
+            count++;
+            return true;
+        };
+
+        /**
+         * update an object's position
+         *
+         * @return `false` if the object isn't in the index, or the cell it's moving into is full (it stays where it was)
+         */
+        bool move(id_t id, float x, float y) {
+            if (!contains(id)) {
+                return false;
+            }
+            auto from = cell_of[id], to = cell_at(x, y);
+            if (from == to) {
+                cells[from].x[slot_of[id]] = x;
+                cells[from].y[slot_of[id]] = y;
+            } else {
+                if (cells[to].count == CellCapacity) {
+                    return false;
+                }
+                unfile(id);
+                file(id, to, x, y);
+            }
+            positions[id] = {x, y};
+            return true;
+        };
+
+        /**
+         * @return `false` if the object wasn't in the index
+         */
+        bool remove(id_t id) {
+            if (!contains(id)) {
+                return false;
+            }
+            unfile(id);
+            count--;
+            return true;
+        };
+
+        void clear() {
+            for (auto& c : cells) {
+                c.count = 0;
+            }
+            cell_of.fill(absent);
+            count = 0;
+        };
+
+        bool contains(id_t id) const noexcept { return id < MaxObjects && cell_of[id] != absent; };
+
+        point position(id_t id) const noexcept { return positions[id]; };
+
+        std::uint8_t kind(id_t id) const noexcept { return kinds[id]; };
+
+        std::size_t size() const noexcept { return count; };
+
+        /**
+         * find the closest object that passes a filter
+         *
+         * @param x query position, in inches
+         * @param y query position, in inches
+         * @param filter predicate on an object id; only objects it accepts are considered
+         * @param max_distance ignore anything further than this, in inches
+         * @return the closest object and its distance, or nothing if there's no match in range
+         */
+        template <class F>
+        std::optional<hit> nearest(float x, float y, F filter,
+                                   float max_distance = std::numeric_limits<float>::infinity()) const {
+            float best = max_distance * max_distance;
+            id_t found = absent;
+            auto cx = static_cast<int>(coordinate(x)), cy = static_cast<int>(coordinate(y));
+            constexpr auto n = static_cast<int>(cells_per_side);
+
+            // how far the query point is inside its own cell's nearest edge; nothing in ring r + 1 can be closer than
+            // r cells plus that
+            float inset = 0.0f;
+            if (x >= 0.0f && y >= 0.0f && x < field_inches && y < field_inches) {
+                float fx = x - cx * cell_inches, fy = y - cy * cell_inches;
+                inset = std::min({fx, cell_inches - fx, fy, cell_inches - fy});
+            }
+
+            for (int r = 0; r < n; r++) {
+                if (r > 0) {
+                    float bound = (r - 1) * cell_inches + inset;
+                    if (bound * bound >= best) {
+                        break;
+                    }
+                }
+                for (int j = std::max(cy - r, 0); j <= std::min(cy + r, n - 1); j++) {
+                    bool edge_row = j == cy - r || j == cy + r;
+                    // inside the ring only its left and right cells are new
+                    int step = edge_row ? 1 : 2 * r;
+                    for (int i = cx - r; i <= cx + r; i += std::max(step, 1)) {
+                        if (i >= 0 && i < n) {
+                            search(cells[j * n + i], x, y, best, found, filter);
+                        }
+                    }
+                }
+            }
+            if (found == absent) {
+                return std::nullopt;
+            }
+            return hit{found, std::sqrt(best)};
+        };
+
+        /**
+         * find the closest object
+         */
+        std::optional<hit> nearest(float x, float y,
+                                   float max_distance = std::numeric_limits<float>::infinity()) const {
+            return nearest(x, y, [] (id_t) { return true; }, max_distance);
+        };
+
+        /**
+         * visit every object within a radius
+         *
+         * @param x query position, in inches
+         * @param y query position, in inches
+         * @param radius in inches
+         * @param fn called with the id of each object within `radius`, in no particular order
+         */
+        template <class F>
+        void for_each_within(float x, float y, float radius, F&& fn) const {
+            auto x0 = coordinate(x - radius), x1 = coordinate(x + radius);
+            auto y0 = coordinate(y - radius), y1 = coordinate(y + radius);
+            float r2 = radius * radius;
+            for (auto j = y0; j <= y1; j++) {
+                for (auto i = x0; i <= x1; i++) {
+                    const auto& bucket = cells[j * cells_per_side + i];
+                    for (std::size_t k = 0; k < bucket.count; k++) {
+                        float dx = bucket.x[k] - x, dy = bucket.y[k] - y;
+                        if (dx * dx + dy * dy <= r2) {
+                            fn(bucket.id[k]);
+                        }
+                    }
+                }
+            }
+        };
+
+        /**
+         * collect the objects within a radius
+         *
+         * @param out where to write their ids
+         * @return how many were written (at most `out.size()`)
+         */
+        std::size_t within(float x, float y, float radius, std::span<id_t> out) const {
+            std::size_t n = 0;
+            for_each_within(x, y, radius, [&] (id_t id) {
+                if (n < out.size()) {
+                    out[n++] = id;
+                }
+            });
+            return n;
+        };
+    };
+}
+
+#endif // HOTEL_FIELD_INDEX_HPP
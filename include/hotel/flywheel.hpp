@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/coro/generator.hpp"
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_FLYWHEEL_HPP
+#define HOTEL_FLYWHEEL_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * flywheel velocity from encoder position, with less lag than `pros::Motor::get_actual_velocity`
+     *
+     * the motor's own velocity reading is heavily filtered, so a controller running on it sees a shot tens of
+     * milliseconds late and keeps pushing after the wheel has recovered. this keeps the last `Window` position samples
+     * with their timestamps and reports the least-squares slope through them: the lag is half the window, and the
+     * encoder's quantization noise is averaged down over every sample in it rather than just the two ends.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Motor flywheel{5};
+     * flywheel.set_encoder_units(pros::E_MOTOR_ENCODER_DEGREES);
+     * hotel::velocity_estimator<> speed;
+     *
+     * hotel::take_back_half_controller<> controller{{.gain = 400.0f, .kv = 19.0f},
+     *                                               [&] { return speed.update(flywheel.get_position()); }, 500.0f};
+     * ```
+     *
+     * @tparam Window number of samples to fit over; at least 2
+     * @tparam Clock clock to timestamp samples with
+     */
+    template <std::size_t Window = 4, concepts::MicrosClock Clock = micros_clock>
+        requires (Window >= 2)
+    class velocity_estimator {
+    public:
+        struct options {
+            /// converts position units per second to the units wanted (the default turns degrees into rpm)
+            float scale = 1.0f / 6.0f;
+        };
+    private:
+        options opts;
+        std::array<double, Window> positions{};
+        std::array<std::uint64_t, Window> times{};
+        std::size_t head = 0;
+        std::size_t count = 0;
+        float current = 0.0f;
+    public:
+        explicit velocity_estimator(options o = {}) : opts(o) {};
+
+        /**
+         * add a position sample, timestamped now
+         *
+         * @param position the position, e.g. from `pros::Motor::get_position`
+         * @return the new velocity estimate
+         */
+        float update(double position) { return update(position, Clock::now()); };
+
+        /**
+         * add a position sample
+         *
+         * @param position the position
+         * @param t when it was read, in microseconds
+         * @return the new velocity estimate
+         */
+        float update(double position, std::uint64_t t) {
+            positions[head] = position;
+            times[head] = t;
+            head = (head + 1) % Window;
+            count = std::min(count + 1, Window);
+            if (count < 2) {
+                return current;
+            }
+
+            // fit relative to the oldest sample, so large positions and timestamps don't cost precision in the sums
+            auto oldest = (head + Window - count) % Window;
+            double t0 = static_cast<double>(times[oldest]), p0 = positions[oldest];
+            double st = 0.0, sp = 0.0, stt = 0.0, stp = 0.0;
+            for (std::size_t i = 0; i < count; i++) {
+                auto k = (oldest + i) % Window;
+                double dt = (static_cast<double>(times[k]) - t0) * 1e-6, dp = positions[k] - p0;
+                st += dt;
+                sp += dp;
+                stt += dt * dt;
+                stp += dt * dp;
+            }
+            double denominator = count * stt - st * st;
+            if (denominator > 0.0) {
+                current = static_cast<float>((count * stp - st * sp) / denominator) * opts.scale;
+            }
+            return current;
+        };
+
+        /**
+         * @return the latest estimate
+         */
+        float velocity() const noexcept { return current; };
+
+        /**
+         * forget every sample (e.g. after the encoder is reset)
+         */
+        void reset() noexcept {
+            count = 0;
+            current = 0.0f;
+        };
+    };
+
+    /**
+     * take-back-half flywheel law
+     *
+     * the output integrates the error, and every time the error changes sign (the wheel has crossed the setpoint) the
+     * output is set halfway between where it is and where it was at the last crossing. it converges on the output that
+     * holds the speed without needing a model, and it can't wind up: there's no separate integral to unwind, just the
+     * output itself, which is clamped. the first take-back value is seeded from `kv`, so spin-up doesn't have to
+     * halve its way down from full power.
+     */
+    class take_back_half {
+    public:
+        struct parameters {
+            /// output added per rpm of error per second, in mV
+            float gain = 400.0f;
+            /// output that holds one rpm, in mV; 0 if unknown
+            float kv = 0.0f;
+        };
+    private:
+        parameters params;
+        float output = 0.0f;
+        float taken_back = 0.0f;
+        float last_error = 0.0f;
+    public:
+        explicit take_back_half(parameters p) : params(p) {};
+
+        void reset(float setpoint, float velocity, float last_output) {
+            output = last_output;
+            taken_back = params.kv * setpoint;
+            last_error = setpoint - velocity;
+        };
+
+        float update(float setpoint, float velocity, float dt, float limit) {
+            float error = setpoint - velocity;
+            output = std::clamp(output + params.gain * error * dt, 0.0f, limit);
+            if ((error > 0.0f) != (last_error > 0.0f)) {
+                output = taken_back = 0.5f * (output + taken_back);
+            }
+            last_error = error;
+            return output;
+        };
+    };
+
+    /**
+     * bang-bang flywheel law with a feedforward hold band
+     *
+     * outside the band it's full power below the setpoint and nothing above it, which is as fast as the motor can
+     * recover from a shot. inside the band the output is the feedforward that holds the setpoint plus a proportional
+     * trim, so it doesn't chatter between the two extremes once it's at speed.
+     */
+    class bang_bang_feedforward {
+    public:
+        struct parameters {
+            /// output that holds one rpm, in mV
+            float kv = 20.0f;
+            /// output that just overcomes friction, in mV
+            float ks = 0.0f;
+            /// half-width of the hold band, in rpm
+            float band = 20.0f;
+            /// proportional trim inside the band, in mV per rpm
+            float kp = 100.0f;
+        };
+    private:
+        parameters params;
+    public:
+        explicit bang_bang_feedforward(parameters p) : params(p) {};
+
+        void reset(float, float, float) {};
+
+        float update(float setpoint, float velocity, float, float limit) {
+            float error = setpoint - velocity;
+            if (error > params.band) {
+                return limit;
+            }
+            if (error < -params.band) {
+                return 0.0f;
+            }
+            return params.kv * setpoint + (setpoint > 0.0f ? params.ks : 0.0f) + params.kp * error;
+        };
+    };
+
+    /**
+     * PID flywheel law on top of a feedforward
+     *
+     * the feedforward supplies the output that holds the setpoint, so the PID terms only have to correct for the model
+     * being off and for shots. the integral is only accumulated while the output isn't saturated (or while the error
+     * is pulling it back out of saturation), so the time spent at full power recovering from a shot doesn't wind it
+     * up, and the derivative is taken on the measurement, so changing the setpoint doesn't kick it.
+     */
+    class pid_feedforward {
+    public:
+        struct parameters {
+            /// output that holds one rpm, in mV
+            float kv = 20.0f;
+            /// output that just overcomes friction, in mV
+            float ks = 0.0f;
+            /// in mV per rpm
+            float kp = 80.0f;
+            /// in mV per rpm-second
+            float ki = 100.0f;
+            /// in mV per rpm per second
+            float kd = 0.0f;
+        };
+    private:
+        parameters params;
+        float integral = 0.0f;
+        float last_velocity = 0.0f;
+    public:
+        explicit pid_feedforward(parameters p) : params(p) {};
+
+        void reset(float setpoint, float velocity, float last_output) {
+            last_velocity = velocity;
+            // pick up from the last output, so resuming doesn't bump it
+            float error = setpoint - velocity;
+            float base = params.kv * setpoint + (setpoint > 0.0f ? params.ks : 0.0f) + params.kp * error;
+            integral = last_output > 0.0f ? last_output - base : 0.0f;
+        };
+
+        float update(float setpoint, float velocity, float dt, float limit) {
+            float error = setpoint - velocity;
+            float derivative = dt > 0.0f ? (velocity - last_velocity) / dt : 0.0f;
+            last_velocity = velocity;
+
+            float base = params.kv * setpoint + (setpoint > 0.0f ? params.ks : 0.0f) + params.kp * error -
+                         params.kd * derivative;
+            float candidate = integral + params.ki * error * dt;
+            float output = base + candidate;
+            if ((output < limit || error < 0.0f) && (output > 0.0f || error > 0.0f)) {
+                integral = candidate;
+            }
+            return base + integral;
+        };
+    };
+
+    /**
+     * velocity controller for a flywheel, running one of the laws above
+     *
+     * it has the same interface as `hotel::pid_controller` (`run()`, `target()`, `error()`, `settled()` and
+     * `resume()`), plus `step()` for loops that would rather call it directly. the difference is that a flywheel is
+     * never done: `run()` keeps producing outputs for as long as it's iterated, and `settled()` just says whether the
+     * wheel is close enough to the setpoint to shoot. the output is in millivolts for `pros::Motor::move_voltage`, and
+     * never negative (reversing into a spinning flywheel is hard on the gears, and braking it is what the next shot is
+     * for).
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Motor flywheel{5};
+     * flywheel.set_encoder_units(pros::E_MOTOR_ENCODER_DEGREES);
+     * hotel::velocity_estimator<> speed;
+     * hotel::bang_bang_controller<> controller{{.kv = 19.0f, .band = 30.0f},
+     *                                          [&] { return speed.update(flywheel.get_position()); }, 500.0f};
+     *
+     * for (float output : controller.run()) {
+     *     flywheel.move_voltage(static_cast<std::int32_t>(output));
+     *     // the velocity this iteration already read: calling `error()` here would update the estimator a second time
+     *     if (shoot_requested && controller.settled(controller.setpoint() - controller.velocity())) {
+     *         indexer.shoot();
+     *     }
+     *     pros::delay(10);
+     * }
+     * ```
+     *
+     * @tparam Law the control law: `take_back_half`, `bang_bang_feedforward` or `pid_feedforward`
+     * @tparam FeedbackFn type of the velocity feedback function, in rpm (e.g. `velocity_estimator::update`, or
+     *                    `pros::Motor::get_actual_velocity`)
+     * @tparam Clock clock used to time iterations
+     */
+    template <concepts::FlywheelLaw Law, class FeedbackFn = std::function<float()>,
+              concepts::MicrosClock Clock = micros_clock>
+        requires concepts::FeedbackFunction<float, FeedbackFn>
+    class flywheel_controller {
+    public:
+        using target_t = float;
+        using output_t = float;
+        using parameters = typename Law::parameters;
+
+        struct options {
+            /// most output the law can ask for, in mV
+            float max_output = 12000.0f;
+            /// within this many rpm of the setpoint is at speed, for `settled()`
+            float tolerance = 20.0f;
+        };
+    private:
+        Law law;
+        FeedbackFn feedback_fn;
+        options opts;
+        target_t current_setpoint;
+        target_t last_velocity = 0.0f;
+        output_t last_output = 0.0f;
+        std::uint64_t last_iteration;
+    public:
+        /**
+         * @param p the law's parameters
+         * @param ffn velocity feedback function, in rpm
+         * @param setpoint initial setpoint, in rpm
+         * @param o output limit and tolerance
+         */
+        flywheel_controller(parameters p, FeedbackFn ffn, target_t setpoint = 0.0f, options o = {}) :
+            law(p),
+            feedback_fn(ffn),
+            opts(o),
+            current_setpoint(setpoint),
+            last_iteration(Clock::now()) {
+            law.reset(current_setpoint, 0.0f, 0.0f);
+        };
+
+        /**
+         * run one iteration: read the velocity and produce an output
+         *
+         * @return the output, in mV
+         */
+        output_t step() {
+            last_velocity = feedback_fn();
+            auto now = Clock::now();
+            float dt = (now - last_iteration) * 1e-6f;
+            last_iteration = now;
+            last_output = std::clamp(law.update(current_setpoint, last_velocity, dt, opts.max_output), 0.0f,
+                                     opts.max_output);
+            return last_output;
+        };
+
+        /**
+         * create the control loop as a generator coroutine
+         *
+         * unlike `pid_controller::run()` this never finishes on its own; stop iterating it to stop the loop.
+         *
+         * @return a generator producing one output, in mV, per iteration
+         */
+        coro::generator<output_t> run() {
+            while (true) {
+                co_yield step();
+            }
+        };
+
+        /**
+         * set a new target for this controller
+         *
+         * the law carries on from the current output, so a change of speed between shots isn't a restart from zero
+         *
+         * @param setpoint the new setpoint, in rpm
+         * @return this instance
+         */
+        flywheel_controller& target(target_t setpoint) {
+            current_setpoint = setpoint;
+            law.reset(current_setpoint, last_velocity, last_output);
+            return *this;
+        };
+
+        /**
+         * read the current error without stepping the controller
+         *
+         * this calls the feedback function, so with a stateful one (`velocity_estimator::update`) it counts as a
+         * reading; from inside the `run()` loop use `setpoint() - velocity()` instead.
+         *
+         * @return the setpoint minus the current velocity, in rpm
+         */
+        target_t error() { return current_setpoint - feedback_fn(); };
+
+        /**
+         * @param error an error value (e.g. from `error()`)
+         * @return whether the wheel is within tolerance of the setpoint at that error
+         */
+        bool settled(target_t error) const { return std::fabs(error) <= opts.tolerance; };
+
+        /**
+         * prepare to `run()` again after a pause, carrying on from the last output without a bump
+         *
+         * @return this instance
+         */
+        flywheel_controller& resume() {
+            last_velocity = feedback_fn();
+            last_iteration = Clock::now();
+            law.reset(current_setpoint, last_velocity, last_output);
+            return *this;
+        };
+
+        target_t setpoint() const noexcept { return current_setpoint; };
+
+        /**
+         * @return the velocity read by the last iteration, in rpm
+         */
+        target_t velocity() const noexcept { return last_velocity; };
+
+        /**
+         * @return the last output, in mV
+         */
+        output_t output() const noexcept { return last_output; };
+    };
+
+    /**
+     * typedef describing a take-back-half flywheel controller
+     */
+    template <class FeedbackFn = std::function<float()>, concepts::MicrosClock Clock = micros_clock>
+    using take_back_half_controller = flywheel_controller<take_back_half, FeedbackFn, Clock>;
+
+    /**
+     * typedef describing a bang-bang flywheel controller with a feedforward hold band
+     */
+    template <class FeedbackFn = std::function<float()>, concepts::MicrosClock Clock = micros_clock>
+    using bang_bang_controller = flywheel_controller<bang_bang_feedforward, FeedbackFn, Clock>;
+
+    /**
+     * typedef describing a PID-plus-feedforward flywheel controller
+     */
+    template <class FeedbackFn = std::function<float()>, concepts::MicrosClock Clock = micros_clock>
+    using pid_feedforward_controller = flywheel_controller<pid_feedforward, FeedbackFn, Clock>;
+}
+
+#endif // HOTEL_FLYWHEEL_HPP
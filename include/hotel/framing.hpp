@@ -0,0 +1,234 @@
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_FRAMING_HPP
+#define HOTEL_FRAMING_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::framing {
+
+    /**
+     * sync bytes that start every frame
+     *
+     * @tparam Bytes the sync sequence; at least one byte
+     */
+    template <std::uint8_t... Bytes>
+        requires (sizeof...(Bytes) > 0)
+    struct sync {
+        static constexpr std::array<std::uint8_t, sizeof...(Bytes)> bytes{Bytes...};
+    };
+
+    /**
+     * payload length field following the sync bytes
+     *
+     * @tparam T unsigned integer type of the field
+     * @tparam Order byte order of the field
+     */
+    template <class T = std::uint8_t, std::endian Order = std::endian::little>
+        requires std::is_unsigned_v<T>
+    struct length {
+        static constexpr std::size_t size = sizeof(T);
+        static constexpr std::size_t limit = static_cast<std::size_t>(static_cast<T>(~T{}));
+
+        static std::size_t decode(const std::uint8_t* in) noexcept {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < size; i++) {
+                auto shift = Order == std::endian::little ? 8 * i : 8 * (size - 1 - i);
+                n |= static_cast<std::size_t>(in[i]) << shift;
+            }
+            return n;
+        };
+
+        static void encode(std::size_t n, std::uint8_t* out) noexcept {
+            for (std::size_t i = 0; i < size; i++) {
+                auto shift = Order == std::endian::little ? 8 * i : 8 * (size - 1 - i);
+                out[i] = static_cast<std::uint8_t>(n >> shift);
+            }
+        };
+    };
+
+    /**
+     * no length field: every payload is `N` bytes
+     */
+    template <std::size_t N>
+    struct fixed_length {
+        static constexpr std::size_t size = 0;
+        static constexpr std::size_t limit = N;
+
+        static std::size_t decode(const std::uint8_t*) noexcept { return N; };
+
+        static void encode(std::size_t, std::uint8_t*) noexcept {};
+    };
+
+    namespace detail {
+        constexpr std::array<std::uint16_t, 256> crc16_ccitt_table() {
+            std::array<std::uint16_t, 256> table{};
+            for (std::uint32_t i = 0; i < 256; i++) {
+                std::uint16_t crc = static_cast<std::uint16_t>(i << 8);
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = static_cast<std::uint16_t>(crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+                }
+                table[i] = crc;
+            }
+            return table;
+        };
+
+        inline constexpr auto crc16_ccitt_lookup = crc16_ccitt_table();
+    }
+
+    /**
+     * no checksum
+     */
+    struct no_checksum {
+        static constexpr std::size_t size = 0;
+
+        static void compute(const std::uint8_t*, std::size_t, std::uint8_t*) noexcept {};
+    };
+
+    /**
+     * low byte of the sum of every byte
+     */
+    struct sum8 {
+        static constexpr std::size_t size = 1;
+
+        static void compute(const std::uint8_t* data, std::size_t n, std::uint8_t* out) noexcept {
+            std::uint8_t sum = 0;
+            for (std::size_t i = 0; i < n; i++) {
+                sum += data[i];
+            }
+            out[0] = sum;
+        };
+    };
+
+    /**
+     * xor of every byte
+     */
+    struct xor8 {
+        static constexpr std::size_t size = 1;
+
+        static void compute(const std::uint8_t* data, std::size_t n, std::uint8_t* out) noexcept {
+            std::uint8_t x = 0;
+            for (std::size_t i = 0; i < n; i++) {
+                x ^= data[i];
+            }
+            out[0] = x;
+        };
+    };
+
+    /**
+     * CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xffff), sent big-endian
+     */
+    struct crc16_ccitt {
+        static constexpr std::size_t size = 2;
+
+        static void compute(const std::uint8_t* data, std::size_t n, std::uint8_t* out) noexcept {
+            std::uint16_t crc = 0xffff;
+            for (std::size_t i = 0; i < n; i++) {
+                crc = static_cast<std::uint16_t>((crc << 8) ^ detail::crc16_ccitt_lookup[(crc >> 8) ^ data[i]]);
+            }
+            out[0] = static_cast<std::uint8_t>(crc >> 8);
+            out[1] = static_cast<std::uint8_t>(crc);
+        };
+    };
+
+    /**
+     * compile-time description of a framed binary protocol
+     *
+     * a frame is the sync bytes, then the length field (if any), then the payload, then the checksum (if any). the
+     * checksum covers the payload, or the whole frame up to it with `ChecksumHeader`.
+     *
+     * example:
+     * ```{.cpp}
+     * // Benewake TFmini: 0x59 0x59, 6 fixed bytes, then the low byte of the sum of everything before it
+     * using tfmini = hotel::framing::format<hotel::framing::sync<0x59, 0x59>, hotel::framing::fixed_length<6>,
+     *                                       hotel::framing::sum8, 6, true>;
+     *
+     * // a coprocessor link: 0xaa 0x55, 16-bit length, CRC
+     * using coprocessor = hotel::framing::format<hotel::framing::sync<0xaa, 0x55>,
+     *                                            hotel::framing::length<std::uint16_t>,
+     *                                            hotel::framing::crc16_ccitt, 512>;
+     * ```
+     *
+     * @tparam Sync `hotel::framing::sync<...>`
+     * @tparam Length `hotel::framing::length<...>` or `hotel::framing::fixed_length<...>`
+     * @tparam Checksum one of the checksum types in `hotel::framing`
+     * @tparam MaxPayload largest payload accepted; longer frames are treated as corrupt
+     * @tparam ChecksumHeader whether the checksum covers the sync bytes and length as well as the payload
+     */
+    template <class Sync, class Length, class Checksum, std::size_t MaxPayload = 255, bool ChecksumHeader = false>
+        requires (MaxPayload <= Length::limit)
+    struct format {
+        using sync_t = Sync;
+        using length_t = Length;
+        using checksum_t = Checksum;
+
+        static constexpr std::size_t sync_size = Sync::bytes.size();
+        static constexpr std::size_t header_size = sync_size + Length::size;
+        static constexpr std::size_t trailer_size = Checksum::size;
+        static constexpr std::size_t max_payload = MaxPayload;
+        static constexpr std::size_t max_frame = header_size + MaxPayload + trailer_size;
+
+        static constexpr std::size_t frame_size(std::size_t payload) noexcept {
+            return header_size + payload + trailer_size;
+        };
+
+        /**
+         * frame a payload
+         *
+         * @param payload the payload
+         * @param out where to write the frame; must have room for `frame_size(payload.size())` bytes
+         * @return bytes written, or 0 if the payload is too long (or the wrong length, for fixed-length formats)
+         */
+        static std::size_t encode(std::span<const std::uint8_t> payload, std::uint8_t* out) noexcept {
+            if (payload.size() > MaxPayload || (Length::size == 0 && payload.size() != Length::limit)) {
+                return 0;
+            }
+
+            std::memcpy(out, Sync::bytes.data(), sync_size);
+            Length::encode(payload.size(), out + sync_size);
+            if (!payload.empty()) {
+                std::memcpy(out + header_size, payload.data(), payload.size());
+            }
+            auto covered = ChecksumHeader ? out : out + header_size;
+            auto covered_size = ChecksumHeader ? header_size + payload.size() : payload.size();
+            Checksum::compute(covered, covered_size, out + header_size + payload.size());
+            return frame_size(payload.size());
+        };
+
+        /**
+         * read the payload length from a complete header
+         *
+         * @return the length, or `max_payload + 1` if it's too long to be a valid frame
+         */
+        static std::size_t payload_size(const std::uint8_t* frame) noexcept {
+            auto n = Length::decode(frame + sync_size);
+            return n <= MaxPayload ? n : MaxPayload + 1;
+        };
+
+        /**
+         * check a complete frame's checksum
+         *
+         * @param frame start of the frame
+         * @param payload payload length
+         */
+        static bool verify(const std::uint8_t* frame, std::size_t payload) noexcept {
+            if constexpr (Checksum::size == 0) {
+                return true;
+            } else {
+                std::uint8_t expected[Checksum::size];
+                auto covered = ChecksumHeader ? frame : frame + header_size;
+                Checksum::compute(covered, ChecksumHeader ? header_size + payload : payload, expected);
+                return std::memcmp(expected, frame + header_size + payload, Checksum::size) == 0;
+            }
+        };
+    };
+}
+
+#endif // HOTEL_FRAMING_HPP
@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "pros/misc.hpp"
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_GOVERNOR_HPP
+#define HOTEL_GOVERNOR_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * the part of a match the robot is in, as far as the field controller is concerned
+     */
+    enum class match_phase : std::uint8_t {
+        /// disabled: before the match, between autonomous and driver control, after the match
+        disabled,
+        autonomous,
+        /// driver control, or running without a field controller
+        driver
+    };
+
+    /**
+     * how much of the processor a subsystem may use during one phase of a match
+     */
+    struct budget {
+        /// how often the subsystem should do its work, in milliseconds; 0 turns it off
+        std::uint32_t period_ms = 0;
+        /// how much it should do each time: a log level, a number of telemetry channels... up to the subsystem
+        std::uint8_t detail = 0;
+
+        constexpr bool enabled() const noexcept { return period_ms != 0; };
+    };
+
+    /**
+     * a subsystem's budget for each phase of a match
+     */
+    struct budget_profile {
+        budget disabled;
+        budget autonomous;
+        budget driver;
+
+        constexpr const budget& operator[](match_phase phase) const noexcept {
+            return phase == match_phase::disabled ? disabled : phase == match_phase::autonomous ? autonomous : driver;
+        };
+    };
+
+    /**
+     * switches background work between budgets as the match moves between phases
+     *
+     * telemetry, screen refreshes, logging and background precomputation all compete with the control loops for the
+     * processor, and all of them are far more useful while the robot is sitting disabled than during autonomous, where
+     * every cycle of a control loop that's late is an inch of error. every subsystem registers a `budget_profile`
+     * (how often it should run and how much it should do in each phase) and then either reads its current budget, asks
+     * `due()` whether to do its work on this pass, or has a callback told whenever its budget changes.
+     *
+     * `poll()` reads the competition status and, when the phase has changed, switches every subsystem over and calls
+     * their callbacks, on the calling task; `watch()` does that forever, from a task of its own. registration isn't
+     * synchronized with polling, so every subsystem should be added before the first `poll()`.
+     *
+     * the only thing handed from the polling task to the others is the phase, in one atomic byte: `current()` looks a
+     * subsystem's budget up in its (unchanging) profile for whatever phase it reads, and `due()` keeps its timing
+     * state to itself, noticing a phase change the first time it's called after one. so `current()` can be called
+     * from any task, and `due()` from any one task per subsystem (usually the one that does its work).
+     *
+     * example:
+     * ```{.cpp}
+     * auto& governor = hotel::default_governor();
+     *
+     * void initialize() {
+     *     auto telemetry = governor.add("telemetry",
+     *                                   {.disabled = {20, 2}, .autonomous = {100, 0}, .driver = {50, 1}});
+     *     governor.add("screen", {.disabled = {50, 1}, .autonomous = {}, .driver = {100, 1}},
+     *                  [] (const hotel::budget& b, hotel::match_phase) { screen.set_refresh(b.period_ms); });
+     *     pros::Task watcher{[] { hotel::default_governor().watch(); }};
+     *
+     *     pros::Task sender{[telemetry] {
+     *         while (true) {
+     *             if (hotel::default_governor().due(telemetry)) {
+     *                 send_telemetry(hotel::default_governor().current(telemetry).detail);
+     *             }
+     *             pros::delay(5);
+     *         }
+     *     }};
+     * }
+     * ```
+     *
+     * @tparam MaxSubsystems number of subsystems that can be registered
+     * @tparam Clock clock `due()` is timed against
+     */
+    template <std::size_t MaxSubsystems = 16, concepts::MicrosClock Clock = micros_clock>
+    class basic_governor {
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        using status_fn = std::function<std::uint8_t()>;
+        using apply_fn = std::function<void(const budget&, match_phase)>;
+
+        struct statistics {
+            /// times the competition status has been read
+            std::uint32_t polls = 0;
+            /// phase changes seen
+            std::uint32_t transitions = 0;
+            /// times each phase was entered, indexed by `match_phase`
+            std::array<std::uint32_t, 3> entered{};
+        };
+    private:
+        struct subsystem {
+            const char* name = nullptr;
+            budget_profile profile;
+            apply_fn apply;
+            /// only touched by `due()`, on the subsystem's own task
+            std::uint64_t next_due = 0;
+            match_phase seen = match_phase::disabled;
+        };
+
+        status_fn status;
+        std::array<subsystem, MaxSubsystems> subsystems;
+        std::size_t count = 0;
+        std::atomic<match_phase> phase_ = match_phase::disabled;
+        bool primed = false;
+        statistics stats_;
+
+        void enter(match_phase p) {
+            phase_.store(p, std::memory_order_release);
+            stats_.entered[static_cast<std::size_t>(p)]++;
+            for (std::size_t i = 0; i < count; i++) {
+                auto& s = subsystems[i];
+                if (s.apply) {
+                    s.apply(s.profile[p], p);
+                }
+            }
+        };
+    public:
+        /**
+         * @param fn reads the competition status, as a mask of the `COMPETITION_*` bits; the default asks PROS
+         */
+        explicit basic_governor(status_fn fn = pros::competition::get_status) : status(std::move(fn)) {};
+
+        /**
+         * the phase a competition status mask means
+         */
+        static constexpr match_phase phase_of(std::uint8_t status) noexcept {
+            if (status & COMPETITION_DISABLED) {
+                return match_phase::disabled;
+            }
+            return status & COMPETITION_AUTONOMOUS ? match_phase::autonomous : match_phase::driver;
+        };
+
+        /**
+         * register a subsystem
+         *
+         * @param name name to report it under; must outlive the governor
+         * @param profile its budget in each phase
+         * @param apply called with the new budget whenever the phase changes (optional)
+         * @return a handle to the subsystem, or `npos` if the governor is full
+         */
+        std::size_t add(const char* name, budget_profile profile, apply_fn apply = nullptr) {
+            if (count == MaxSubsystems) {
+                return npos;
+            }
+            auto& s = subsystems[count];
+            s = {name, profile, std::move(apply), Clock::now(), phase()};
+            return count++;
+        };
+
+        /**
+         * read the competition status, and switch every subsystem over if the phase has changed
+         *
+         * the first call always applies the budgets for the phase it finds.
+         *
+         * @return the current phase
+         */
+        match_phase poll() {
+            stats_.polls++;
+            auto p = phase_of(status());
+            if (!primed || p != phase()) {
+                if (primed) {
+                    stats_.transitions++;
+                }
+                primed = true;
+                enter(p);
+            }
+            return p;
+        };
+
+        /**
+         * poll forever; meant to be the body of a low-priority task of its own
+         *
+         * @param period_us time between polls, in microseconds
+         */
+        [[noreturn]] void watch(std::uint32_t period_us = 20000) {
+            auto next = Clock::now();
+            while (true) {
+                poll();
+                next += period_us;
+                Clock::wait_until(next);
+            }
+        };
+
+        /**
+         * whether a subsystem should do its work now, for subsystems that share a loop running faster than they do
+         *
+         * returns `true` at most once per period of the subsystem's current budget, and never while it's turned off.
+         * a subsystem's timing is kept unsynchronized, so call this for it from one task only.
+         *
+         * @param id the subsystem's handle
+         */
+        bool due(std::size_t id) {
+            auto& s = subsystems[id];
+            auto p = phase();
+            auto now = Clock::now();
+            if (p != s.seen) {
+                // a subsystem that was switched off, or slowed right down, shouldn't have to wait out its old period
+                s.seen = p;
+                s.next_due = now;
+            }
+            const auto& b = s.profile[p];
+            if (!b.enabled() || now < s.next_due) {
+                return false;
+            }
+            // catch up on a missed period without bunching the next few together
+            s.next_due = std::max(s.next_due + b.period_ms * std::uint64_t{1000}, now);
+            return true;
+        };
+
+        /**
+         * @return a subsystem's budget for the current phase
+         */
+        const budget& current(std::size_t id) const noexcept { return subsystems[id].profile[phase()]; };
+
+        match_phase phase() const noexcept { return phase_.load(std::memory_order_acquire); };
+
+        std::size_t size() const noexcept { return count; };
+
+        const statistics& stats() const noexcept { return stats_; };
+
+        /**
+         * write a `governor` telemetry record, followed by a `budget` record for each subsystem
+         *
+         * `governor` fields are: phase, polls, transitions, and the times disabled, autonomous and driver control were
+         * entered. `budget` fields are: subsystem, period (in milliseconds), detail.
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            auto p = phase();
+            telemetry::write(out, "governor", static_cast<std::uint32_t>(p), stats_.polls, stats_.transitions,
+                             stats_.entered[0], stats_.entered[1], stats_.entered[2]);
+            for (std::size_t i = 0; i < count; i++) {
+                const auto& b = subsystems[i].profile[p];
+                telemetry::write(out, "budget", subsystems[i].name, b.period_ms, static_cast<std::uint32_t>(b.detail));
+            }
+        };
+    };
+
+    /**
+     * the governor used by default throughout libhotel
+     */
+    using governor = basic_governor<>;
+
+    /**
+     * @return the shared governor, for subsystems to register with from `initialize()`
+     */
+    inline governor& default_governor() {
+        static governor instance;
+        return instance;
+    };
+}
+
+#endif // HOTEL_GOVERNOR_HPP
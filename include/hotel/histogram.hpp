@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_HISTOGRAM_HPP
+#define HOTEL_HISTOGRAM_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * fixed-size linear histogram for unsigned samples (usually microseconds)
+     *
+     * bucket `i` counts samples in `[i * BucketWidth, (i + 1) * BucketWidth)`. the last bucket also collects everything
+     * that falls off the end, so nothing is ever dropped. exact min, max and sum are kept alongside the buckets so the
+     * mean isn't subject to bucket quantization.
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::histogram<32, 100> loop_time;  // 0-3.2ms in 100us buckets
+     *
+     * auto start = pros::micros();
+     * do_work();
+     * loop_time.add(pros::micros() - start);
+     *
+     * printf("p99: %lu us\n", loop_time.percentile(0.99));
+     * ```
+     *
+     * @tparam Buckets number of buckets
+     * @tparam BucketWidth width of each bucket, in sample units
+     */
+    template <std::size_t Buckets, std::uint32_t BucketWidth>
+        requires (Buckets > 0 && BucketWidth > 0)
+    class histogram {
+        std::array<std::uint32_t, Buckets> buckets{};
+        std::uint32_t samples = 0;
+        std::uint32_t smallest = std::numeric_limits<std::uint32_t>::max();
+        std::uint32_t largest = 0;
+        std::uint64_t total = 0;
+    public:
+        static constexpr std::size_t bucket_count = Buckets;
+        static constexpr std::uint32_t bucket_width = BucketWidth;
+
+        /**
+         * record a sample
+         *
+         * @param value the sample
+         */
+        void add(std::uint32_t value) {
+            buckets[std::min<std::size_t>(value / BucketWidth, Buckets - 1)]++;
+            samples++;
+            smallest = std::min(smallest, value);
+            largest = std::max(largest, value);
+            total += value;
+        };
+
+        /**
+         * fold another histogram with the same shape into this one
+         *
+         * @param other the histogram to merge
+         */
+        void merge(const histogram& other) {
+            for (std::size_t i = 0; i < Buckets; i++) {
+                buckets[i] += other.buckets[i];
+            }
+            samples += other.samples;
+            smallest = std::min(smallest, other.smallest);
+            largest = std::max(largest, other.largest);
+            total += other.total;
+        };
+
+        /**
+         * forget all recorded samples
+         */
+        void clear() { *this = histogram{}; };
+
+        std::uint32_t count() const noexcept { return samples; };
+
+        std::uint32_t min() const noexcept { return samples ? smallest : 0; };
+
+        std::uint32_t max() const noexcept { return largest; };
+
+        std::uint64_t sum() const noexcept { return total; };
+
+        float mean() const noexcept { return samples ? static_cast<float>(total) / samples : 0.0f; };
+
+        std::uint32_t bucket(std::size_t i) const noexcept { return buckets[i]; };
+
+        /**
+         * estimate a percentile from the buckets
+         *
+         * the estimate is the upper edge of the bucket containing the requested rank, clamped to the exact maximum
+         * (so it never under-reports, and never reports more than was actually seen)
+         *
+         * @param p fraction in `[0, 1]`, e.g. `0.99` for p99
+         * @return the estimated percentile, or 0 if there are no samples
+         */
+        std::uint32_t percentile(float p) const noexcept {
+            if (!samples) {
+                return 0;
+            }
+
+            auto rank = static_cast<std::uint32_t>(std::clamp(p, 0.0f, 1.0f) * (samples - 1)) + 1;
+            std::uint32_t seen = 0;
+            for (std::size_t i = 0; i < Buckets; i++) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return std::min(static_cast<std::uint32_t>((i + 1) * BucketWidth), largest);
+                }
+            }
+
+            return largest;
+        };
+    };
+}
+
+#endif // HOTEL_HISTOGRAM_HPP
@@ -0,0 +1,189 @@
+/**
+ * @file hotel.cppm
+ *
+ * `hotel` C++20 named module
+ *
+ * this is built from the same headers that get `#include`d when modules aren't available, so there's nothing to keep
+ * in sync except the list of headers below. the trick is that every libhotel header pulls in its dependencies *before*
+ * its include guard: with the guards pre-defined, the global module fragment gets every standard library and PROS
+ * header the library needs and nothing else. the guards are then dropped and the same headers are included again in
+ * the module purview, where `HOTEL_MODULE_EXPORT` expands to `export` and only the library itself is compiled.
+ *
+ * everything is declared inside `extern "C++"`, so it stays attached to the global module. that means a translation
+ * unit that does `import hotel;` and one that does `#include "hotel/pid.hpp"` see the same entities and can be linked
+ * into the same program.
+ *
+ * build it with `USE_MODULES:=1` in the Makefile; see the README for toolchain requirements.
+ */
+module;
+
+#define HOTEL_AUTON_CHECKPOINT_HPP
+#define HOTEL_AUTON_PRELOAD_HPP
+#define HOTEL_CLOCK_HPP
+#define HOTEL_CONCEPTS_HPP
+#define HOTEL_CONTROLLER_REGISTRY_HPP
+#define HOTEL_CORO_GENERATOR_HPP
+#define HOTEL_CORO_INTROSPECTION_HPP
+#define HOTEL_CORO_TASK_HPP
+#define HOTEL_DISTURBANCE_OBSERVER_HPP
+#define HOTEL_FEEDFORWARD_HPP
+#define HOTEL_FIELD_INDEX_HPP
+#define HOTEL_FLYWHEEL_HPP
+#define HOTEL_FRAMING_HPP
+#define HOTEL_GOVERNOR_HPP
+#define HOTEL_HISTOGRAM_HPP
+#define HOTEL_IDLE_WAKE_HPP
+#define HOTEL_IMU_PIPELINE_HPP
+#define HOTEL_LATENCY_PROBE_HPP
+#define HOTEL_LEAST_SQUARES_HPP
+#define HOTEL_LINK_MUX_HPP
+#define HOTEL_LOG_BITSTREAM_HPP
+#define HOTEL_LOG_COLUMNAR_HPP
+#define HOTEL_ODOMETRY_CALIBRATION_HPP
+#define HOTEL_PID_HPP
+#define HOTEL_PROFILER_HPP
+#define HOTEL_QUATERNION_HPP
+#define HOTEL_SCHEDULABILITY_HPP
+#define HOTEL_SELF_TUNING_HPP
+#define HOTEL_SERIAL_STREAM_HPP
+#define HOTEL_SIM_PLANT_HPP
+#define HOTEL_SIM_SCHEDULER_HPP
+#define HOTEL_SIM_SERIAL_HPP
+#define HOTEL_SPSC_QUEUE_HPP
+#define HOTEL_STACK_AUDIT_HPP
+#define HOTEL_STATE_SYNC_HPP
+#define HOTEL_TELEMETRY_HPP
+#define HOTEL_TIMESERIES_HPP
+#define HOTEL_TRAJECTORY_CACHE_HPP
+#define HOTEL_TRAJECTORY_HPP
+#define HOTEL_VERIFY_HPP
+
+#include "hotel/auton_checkpoint.hpp"
+#include "hotel/auton_preload.hpp"
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/controller_registry.hpp"
+#include "hotel/coro/generator.hpp"
+#include "hotel/coro/introspection.hpp"
+#include "hotel/coro/task.hpp"
+#include "hotel/disturbance_observer.hpp"
+#include "hotel/feedforward.hpp"
+#include "hotel/field_index.hpp"
+#include "hotel/flywheel.hpp"
+#include "hotel/framing.hpp"
+#include "hotel/governor.hpp"
+#include "hotel/histogram.hpp"
+#include "hotel/idle_wake.hpp"
+#include "hotel/imu_pipeline.hpp"
+#include "hotel/latency_probe.hpp"
+#include "hotel/least_squares.hpp"
+#include "hotel/link_mux.hpp"
+#include "hotel/log/bitstream.hpp"
+#include "hotel/log/columnar.hpp"
+#include "hotel/odometry_calibration.hpp"
+#include "hotel/pid.hpp"
+#include "hotel/profiler.hpp"
+#include "hotel/quaternion.hpp"
+#include "hotel/schedulability.hpp"
+#include "hotel/self_tuning.hpp"
+#include "hotel/serial_stream.hpp"
+#include "hotel/sim/plant.hpp"
+#include "hotel/sim/scheduler.hpp"
+#include "hotel/sim/serial.hpp"
+#include "hotel/spsc_queue.hpp"
+#include "hotel/stack_audit.hpp"
+#include "hotel/state_sync.hpp"
+#include "hotel/telemetry.hpp"
+#include "hotel/timeseries.hpp"
+#include "hotel/trajectory.hpp"
+#include "hotel/trajectory_cache.hpp"
+#include "hotel/verify.hpp"
+
+#undef HOTEL_AUTON_CHECKPOINT_HPP
+#undef HOTEL_AUTON_PRELOAD_HPP
+#undef HOTEL_CLOCK_HPP
+#undef HOTEL_CONCEPTS_HPP
+#undef HOTEL_CONTROLLER_REGISTRY_HPP
+#undef HOTEL_CORO_GENERATOR_HPP
+#undef HOTEL_CORO_INTROSPECTION_HPP
+#undef HOTEL_CORO_TASK_HPP
+#undef HOTEL_DISTURBANCE_OBSERVER_HPP
+#undef HOTEL_FEEDFORWARD_HPP
+#undef HOTEL_FIELD_INDEX_HPP
+#undef HOTEL_FLYWHEEL_HPP
+#undef HOTEL_FRAMING_HPP
+#undef HOTEL_GOVERNOR_HPP
+#undef HOTEL_HISTOGRAM_HPP
+#undef HOTEL_IDLE_WAKE_HPP
+#undef HOTEL_IMU_PIPELINE_HPP
+#undef HOTEL_LATENCY_PROBE_HPP
+#undef HOTEL_LEAST_SQUARES_HPP
+#undef HOTEL_LINK_MUX_HPP
+#undef HOTEL_LOG_BITSTREAM_HPP
+#undef HOTEL_LOG_COLUMNAR_HPP
+#undef HOTEL_ODOMETRY_CALIBRATION_HPP
+#undef HOTEL_PID_HPP
+#undef HOTEL_PROFILER_HPP
+#undef HOTEL_QUATERNION_HPP
+#undef HOTEL_SCHEDULABILITY_HPP
+#undef HOTEL_SELF_TUNING_HPP
+#undef HOTEL_SERIAL_STREAM_HPP
+#undef HOTEL_SIM_PLANT_HPP
+#undef HOTEL_SIM_SCHEDULER_HPP
+#undef HOTEL_SIM_SERIAL_HPP
+#undef HOTEL_SPSC_QUEUE_HPP
+#undef HOTEL_STACK_AUDIT_HPP
+#undef HOTEL_STATE_SYNC_HPP
+#undef HOTEL_TELEMETRY_HPP
+#undef HOTEL_TIMESERIES_HPP
+#undef HOTEL_TRAJECTORY_CACHE_HPP
+#undef HOTEL_TRAJECTORY_HPP
+#undef HOTEL_VERIFY_HPP
+
+export module hotel;
+
+#undef HOTEL_MODULE_EXPORT
+#define HOTEL_MODULE_EXPORT export
+
+extern "C++" {
+#include "hotel/auton_checkpoint.hpp"
+#include "hotel/auton_preload.hpp"
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/controller_registry.hpp"
+#include "hotel/coro/generator.hpp"
+#include "hotel/coro/introspection.hpp"
+#include "hotel/coro/task.hpp"
+#include "hotel/disturbance_observer.hpp"
+#include "hotel/feedforward.hpp"
+#include "hotel/field_index.hpp"
+#include "hotel/flywheel.hpp"
+#include "hotel/framing.hpp"
+#include "hotel/governor.hpp"
+#include "hotel/histogram.hpp"
+#include "hotel/idle_wake.hpp"
+#include "hotel/imu_pipeline.hpp"
+#include "hotel/latency_probe.hpp"
+#include "hotel/least_squares.hpp"
+#include "hotel/link_mux.hpp"
+#include "hotel/log/bitstream.hpp"
+#include "hotel/log/columnar.hpp"
+#include "hotel/odometry_calibration.hpp"
+#include "hotel/pid.hpp"
+#include "hotel/profiler.hpp"
+#include "hotel/quaternion.hpp"
+#include "hotel/schedulability.hpp"
+#include "hotel/self_tuning.hpp"
+#include "hotel/serial_stream.hpp"
+#include "hotel/sim/plant.hpp"
+#include "hotel/sim/scheduler.hpp"
+#include "hotel/sim/serial.hpp"
+#include "hotel/spsc_queue.hpp"
+#include "hotel/stack_audit.hpp"
+#include "hotel/state_sync.hpp"
+#include "hotel/telemetry.hpp"
+#include "hotel/timeseries.hpp"
+#include "hotel/trajectory.hpp"
+#include "hotel/trajectory_cache.hpp"
+#include "hotel/verify.hpp"
+}
@@ -0,0 +1,201 @@
+#include <concepts>
+
+#include <cstdint>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/profiler.hpp"
+
+#ifndef HOTEL_IDLE_WAKE_HPP
+#define HOTEL_IDLE_WAKE_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * holding loop that sleeps while settled and wakes on disturbance
+     *
+     * while the controller is working, this runs it at the full rate and forwards every output. once it settles, the
+     * last output is left in place (for a lift or arm, that's the effort holding it up) and the loop drops to a monitor
+     * that does nothing but read the error once per `idle_period_us` and check it against the controller's settled
+     * function. as soon as the error leaves the band the controller is `resume()`d, which keeps its accumulated error
+     * and resets its derivative and timing state, so the output picks up where it left off rather than kicking.
+     *
+     * the loop keeps its own accounting of how long it spent in each mode and how busy it was, and can also record
+     * every iteration into a profiler section. tools/wake_check.cpp checks the wake against a simulated lift.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Motor lift{2};
+     * hotel::motor_position_controller<std::ratio<1, 2>, std::ratio<1, 1000>, std::ratio<1, 100>> controller{
+     *     [&lift] { return lift.get_position(); },
+     *     [] (double error) { return std::fabs(error) < 5; },
+     *     600.0
+     * };
+     *
+     * hotel::idle_wake_loop hold{controller, {.active_period_us = 10000, .idle_period_us = 50000},
+     *                            &hotel::default_profiler().section("lift")};
+     * hold.run([&lift] (std::int32_t output) {
+     *     lift.move(std::clamp(output, std::int32_t{-127}, std::int32_t{127}));
+     * });
+     * ```
+     *
+     * @tparam Controller controller type (e.g. `hotel::pid_controller<...>`)
+     * @tparam Clock clock used for pacing and accounting
+     */
+    template <concepts::ResumableController Controller, concepts::MicrosClock Clock = micros_clock>
+    class idle_wake_loop {
+    public:
+        struct options {
+            /// loop period while the controller is active, in microseconds
+            std::uint32_t active_period_us = 10000;
+            /// monitor period while settled, in microseconds
+            std::uint32_t idle_period_us = 50000;
+        };
+
+        struct accounting {
+            /// time spent executing active iterations, in microseconds
+            std::uint64_t active_busy_us = 0;
+            /// time spent executing idle checks, in microseconds
+            std::uint64_t idle_busy_us = 0;
+            /// wall time spent in each mode, in microseconds
+            std::uint64_t active_time_us = 0;
+            std::uint64_t idle_time_us = 0;
+            std::uint32_t active_iterations = 0;
+            std::uint32_t idle_iterations = 0;
+            /// number of times the loop woke from idle
+            std::uint32_t wakes = 0;
+        };
+    private:
+        Controller& controller;
+        options opts;
+        basic_profiler<>::section_t* section;
+        accounting totals;
+        bool is_idle = false;
+
+        template <class F>
+        auto timed(std::uint64_t& busy, F&& body) {
+            auto start = Clock::now();
+            auto result = body();
+            auto end = Clock::now();
+            busy += end - start;
+            if (section) {
+                section->record(start, end);
+            }
+            return result;
+        };
+    public:
+        /**
+         * construct an idle/wake loop around a controller
+         *
+         * @param c the controller; must outlive the loop
+         * @param o loop periods
+         * @param s optional profiler section to record every iteration into
+         */
+        idle_wake_loop(Controller& c, options o = {}, basic_profiler<>::section_t* s = nullptr) :
+            controller(c),
+            opts(o),
+            section(s) {};
+
+        /**
+         * run the loop
+         *
+         * @param output called with every controller output while active
+         * @param stop polled once per iteration in either mode; the loop returns when it's true
+         */
+        template <class OutputFn, class StopFn>
+            requires std::predicate<StopFn>
+        void run(OutputFn&& output, StopFn&& stop) {
+            auto next = Clock::now();
+            while (!stop()) {
+                // active: full controller iterations at the full rate
+                is_idle = false;
+                auto phase_start = Clock::now();
+                {
+                    auto generator = controller.run();
+                    // each iteration is computed when it's due, not straight after the one before it is handed out
+                    decltype(generator.begin()) it;
+                    bool started = false;
+                    while (timed(totals.active_busy_us, [&] {
+                        if (started) {
+                            ++it;
+                        } else {
+                            it = generator.begin();
+                            started = true;
+                        }
+                        if (it == generator.end()) {
+                            return false;
+                        }
+                        output(*it);
+                        return true;
+                    })) {
+                        totals.active_iterations++;
+                        next += opts.active_period_us;
+                        Clock::wait_until(next);
+                        if (stop()) {
+                            totals.active_time_us += Clock::now() - phase_start;
+                            return;
+                        }
+                    }
+                }
+                totals.active_time_us += Clock::now() - phase_start;
+
+                // idle: leave the last output alone and just watch the error
+                is_idle = true;
+                phase_start = Clock::now();
+                while (timed(totals.idle_busy_us, [&] { return controller.settled(controller.error()); })) {
+                    totals.idle_iterations++;
+                    next += opts.idle_period_us;
+                    Clock::wait_until(next);
+                    if (stop()) {
+                        totals.idle_time_us += Clock::now() - phase_start;
+                        return;
+                    }
+                }
+                totals.idle_time_us += Clock::now() - phase_start;
+
+                totals.wakes++;
+                controller.resume();
+                next = Clock::now();
+            }
+        };
+
+        /**
+         * run the loop forever
+         *
+         * @param output called with every controller output while active
+         */
+        template <class OutputFn>
+        [[noreturn]] void run(OutputFn&& output) {
+            run(output, [] { return false; });
+            __builtin_unreachable();
+        };
+
+        /**
+         * @return whether the loop is currently in idle (monitor) mode
+         */
+        bool idle() const noexcept { return is_idle; };
+
+        const accounting& stats() const noexcept { return totals; };
+
+        /**
+         * estimate the CPU time the idle mode has given back
+         *
+         * this is what the full loop would have spent running at the active rate through the time spent idle (at its
+         * measured mean cost per iteration), minus what the monitor actually spent.
+         *
+         * @return reclaimed time, in microseconds
+         */
+        std::uint64_t reclaimed_us() const noexcept {
+            if (!totals.active_iterations) {
+                return 0;
+            }
+
+            auto would_have_run = totals.idle_time_us / opts.active_period_us;
+            auto would_have_spent = would_have_run * totals.active_busy_us / totals.active_iterations;
+            return would_have_spent > totals.idle_busy_us ? would_have_spent - totals.idle_busy_us : 0;
+        };
+    };
+}
+
+#endif // HOTEL_IDLE_WAKE_HPP
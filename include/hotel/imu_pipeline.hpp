@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <numbers>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include "pros/imu.hpp"
+#include "pros/rtos.hpp"
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/quaternion.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_IMU_PIPELINE_HPP
+#define HOTEL_IMU_PIPELINE_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * high-rate heading from the IMU's raw gyro, with the bias tracked while the robot is still
+     *
+     * `pros::Imu::get_rotation` integrates the gyro with the bias it measured when it was calibrated, and that bias
+     * wanders as the sensor warms up, so the heading drifts a degree or two a minute. this raises the sensor's data
+     * rate and integrates `get_gyro_rate` itself, in its own task:
+     *
+     * - whenever every axis has read close to the current bias estimate, and the accelerometer close to 1g, for long
+     *   enough, the robot is taken to be stationary. the bias estimate is then pulled towards the raw rate, nothing is
+     *   integrated, and the accelerometer (reading nothing but gravity) nudges the orientation's tilt back into place,
+     *   so errors picked up while tilted (going over a barrier, say) don't keep leaking into the heading
+     * - otherwise the bias-corrected rates are integrated into an orientation quaternion
+     *
+     * the heading is the unwrapped rotation about the gravity direction seen at the first stationary period, in degrees
+     * and clockwise-positive like `get_rotation` (for a sensor mounted z-up; set `clockwise` to `false` if it comes out
+     * backwards). it's published after every step through a single 64-bit atomic alongside the yaw rate, so `heading()`
+     * and `reading()` never wait and never see a torn value. the full state is published through a sequence lock, and
+     * copied in and out of it a word at a time through relaxed atomics, so a copy that races a step is retried rather
+     * than being a data race.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Imu imu{10};
+     * imu.reset(true);
+     * hotel::imu_pipeline<> pipeline{imu};
+     * pipeline.start();
+     *
+     * // anywhere, at any rate
+     * double heading = pipeline.heading();
+     * ```
+     *
+     * @tparam Imu inertial sensor type (`pros::Imu`, or a stand-in replaying a recording)
+     * @tparam Clock clock used for pacing and integration
+     */
+    template <concepts::InertialSensor Imu = pros::Imu, concepts::MicrosClock Clock = micros_clock>
+    class imu_pipeline {
+    public:
+        struct options {
+            /// sensor data rate, in milliseconds (`IMU_MINIMUM_DATA_RATE` is as fast as it goes)
+            std::uint32_t data_rate_ms = IMU_MINIMUM_DATA_RATE;
+            /// time between steps, in microseconds
+            std::uint32_t period_us = 5000;
+            /// largest deviation from the bias estimate on any axis that still counts as still, in degrees per second
+            float stationary_rate = 1.5f;
+            /// largest deviation of the acceleration from 1g that still counts as still (or level enough to correct
+            /// tilt against), in g
+            float stationary_accel = 0.05f;
+            /// how long the robot has to be still before it's taken to be stationary, in microseconds
+            std::uint32_t stationary_us = 150000;
+            /// time constant of the bias estimate while stationary, in seconds
+            float bias_time_constant = 1.0f;
+            /// fraction of the tilt error corrected per step while stationary
+            float tilt_gain = 0.05f;
+            /// whether a positive z rate turns the heading clockwise (negative); `false` flips the heading's sign
+            bool clockwise = true;
+        };
+
+        struct state {
+            /// orientation relative to where the pipeline started
+            quaternion orientation;
+            /// unwrapped heading, in degrees
+            double heading = 0.0;
+            /// heading rate, in degrees per second
+            float rate = 0.0f;
+            /// current gyro bias estimate, in degrees per second
+            vector3 bias;
+            bool stationary = false;
+            /// time of the step that produced this state, in microseconds
+            std::uint64_t time = 0;
+            std::uint32_t steps = 0;
+        };
+
+        struct statistics {
+            std::uint32_t steps = 0;
+            /// reads the sensor failed (and were skipped)
+            std::uint32_t errors = 0;
+            /// total time spent stationary, in microseconds
+            std::uint64_t stationary_us = 0;
+            /// time spent inside `step()`, in microseconds
+            std::uint64_t busy_us = 0;
+            std::uint32_t longest_step_us = 0;
+        };
+    private:
+        static constexpr float radians = std::numbers::pi_v<float> / 180.0f;
+
+        Imu& imu;
+        options opts;
+        state current;
+        statistics stats_;
+        vector3 world_up{};
+        bool has_up = false;
+        float last_yaw = 0.0f;
+        std::uint64_t still_since = 0;
+        bool is_still = false;
+
+        std::atomic<std::uint64_t> packed{0};
+        std::atomic<std::uint32_t> sequence{0};
+        static_assert(std::is_trivially_copyable_v<state>);
+        static constexpr std::size_t state_words = (sizeof(state) + 3) / 4;
+        std::array<std::atomic<std::uint32_t>, state_words> published{};
+
+        /// pack heading and rate into one word, so both can be read wait-free and consistently
+        static std::uint64_t pack(float heading, float rate) {
+            return std::uint64_t{std::bit_cast<std::uint32_t>(heading)} << 32 | std::bit_cast<std::uint32_t>(rate);
+        };
+
+        void publish() {
+            packed.store(pack(static_cast<float>(current.heading), current.rate), std::memory_order_release);
+
+            auto s = sequence.load(std::memory_order_relaxed);
+            sequence.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            std::array<std::uint32_t, state_words> words{};
+            std::memcpy(words.data(), &current, sizeof(state));
+            for (std::size_t i = 0; i < state_words; i++) {
+                published[i].store(words[i], std::memory_order_relaxed);
+            }
+            sequence.store(s + 2, std::memory_order_release);
+        };
+
+        /// yaw about the gravity direction, found by turning the orientation into a frame with world up along +z
+        float yaw() const {
+            auto up = has_up ? world_up : vector3{0.0f, 0.0f, 1.0f};
+            auto level = quaternion::between(up, {0.0f, 0.0f, 1.0f});
+            return (level * current.orientation * level.conjugate()).to_euler().yaw;
+        };
+
+        void update_heading() {
+            float yaw = this->yaw();
+            float delta = yaw - last_yaw;
+            if (delta > std::numbers::pi_v<float>) {
+                delta -= 2.0f * std::numbers::pi_v<float>;
+            } else if (delta < -std::numbers::pi_v<float>) {
+                delta += 2.0f * std::numbers::pi_v<float>;
+            }
+            last_yaw = yaw;
+            current.heading += (opts.clockwise ? -delta : delta) / radians;
+        };
+    public:
+        /**
+         * @param i the sensor; must outlive the pipeline, and should be calibrated (`reset(true)`) before `start()`
+         * @param o rates and thresholds
+         */
+        explicit imu_pipeline(Imu& i, options o = {}) : imu(i), opts(o) {};
+
+        /**
+         * raise the sensor's data rate and run `step()` every period from a new task
+         *
+         * @param prio task priority; above the control loops that read the heading, so they never see a stale one
+         * @return the task
+         */
+        pros::Task start(std::uint32_t prio = TASK_PRIORITY_DEFAULT + 2) {
+            imu.set_data_rate(opts.data_rate_ms);
+            return pros::Task{[this] {
+                auto next = Clock::now();
+                while (true) {
+                    step();
+                    next += opts.period_us;
+                    Clock::wait_until(next);
+                }
+            }, prio, TASK_STACK_DEPTH_DEFAULT, "imu_pipeline"};
+        };
+
+        /**
+         * read the sensor once, integrate, and publish
+         *
+         * @return `false` if the sensor couldn't be read
+         */
+        bool step() {
+            auto start = Clock::now();
+            auto g = imu.get_gyro_rate();
+            auto a = imu.get_accel();
+            vector3 rate{static_cast<float>(g.x), static_cast<float>(g.y), static_cast<float>(g.z)};
+            vector3 accel{static_cast<float>(a.x), static_cast<float>(a.y), static_cast<float>(a.z)};
+            if (!std::isfinite(rate.x + rate.y + rate.z + accel.x + accel.y + accel.z)) {
+                stats_.errors++;
+                return false;
+            }
+
+            auto now = Clock::now();
+            float dt = current.steps ? (now - current.time) * 1e-6f : 0.0f;
+            current.time = now;
+            current.steps++;
+
+            auto corrected = rate - current.bias;
+            float g_error = std::fabs(accel.norm() - 1.0f);
+            bool still = std::max({std::fabs(corrected.x), std::fabs(corrected.y), std::fabs(corrected.z)}) <
+                             opts.stationary_rate && g_error < opts.stationary_accel;
+            if (still && !is_still) {
+                still_since = now;
+            }
+            is_still = still;
+            bool was_stationary = current.stationary;
+            current.stationary = still && now - still_since >= opts.stationary_us;
+
+            if (current.stationary) {
+                if (was_stationary) {
+                    stats_.stationary_us += static_cast<std::uint64_t>(dt * 1e6f);
+                }
+                current.bias = current.bias + corrected * std::min(1.0f, dt / opts.bias_time_constant);
+                auto gravity = accel * (1.0f / accel.norm());
+                if (!has_up) {
+                    world_up = current.orientation.rotate(gravity);
+                    has_up = true;
+                    // the heading is measured in a new frame from here on, which isn't a turn
+                    last_yaw = yaw();
+                } else {
+                    // where gravity should be in the sensor's frame, against where it is
+                    auto predicted = current.orientation.conjugate().rotate(world_up);
+                    auto correction = quaternion::between(gravity, predicted);
+                    current.orientation = (current.orientation * slerp({}, correction, opts.tilt_gain)).normalized();
+                }
+                current.rate = 0.0f;
+            } else {
+                auto turn = quaternion::from_rotation_vector(corrected * (dt * radians));
+                current.orientation = (current.orientation * turn).normalized();
+                auto up = has_up ? current.orientation.conjugate().rotate(world_up) : vector3{0.0f, 0.0f, 1.0f};
+                current.rate = (opts.clockwise ? -1.0f : 1.0f) * corrected.dot(up);
+            }
+            update_heading();
+            publish();
+
+            auto elapsed = static_cast<std::uint32_t>(Clock::now() - start);
+            stats_.steps++;
+            stats_.busy_us += elapsed;
+            stats_.longest_step_us = std::max(stats_.longest_step_us, elapsed);
+            return true;
+        };
+
+        struct heading_reading {
+            float heading;
+            float rate;
+        };
+
+        /**
+         * @return the latest heading, in degrees; wait-free from any task
+         */
+        double heading() const { return reading().heading; };
+
+        /**
+         * @return the latest heading (degrees) and heading rate (degrees per second), from the same step; wait-free
+         */
+        heading_reading reading() const {
+            auto p = packed.load(std::memory_order_acquire);
+            return {std::bit_cast<float>(static_cast<std::uint32_t>(p >> 32)),
+                    std::bit_cast<float>(static_cast<std::uint32_t>(p))};
+        };
+
+        /**
+         * @return a consistent copy of the full state; retries (without blocking the pipeline) if a step lands mid-copy
+         */
+        state snapshot() const {
+            while (true) {
+                auto before = sequence.load(std::memory_order_acquire);
+                if (before & 1) {
+                    continue;
+                }
+                std::array<std::uint32_t, state_words> words;
+                for (std::size_t i = 0; i < state_words; i++) {
+                    words[i] = published[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    state s;
+                    std::memcpy(static_cast<void*>(&s), words.data(), sizeof(state));
+                    return s;
+                }
+            }
+        };
+
+        /**
+         * reset the heading, keeping the bias estimate
+         *
+         * only call this from the task that steps the pipeline (or before `start()`)
+         *
+         * @param heading new heading, in degrees
+         */
+        void set_heading(double heading) {
+            current.heading = heading;
+            publish();
+        };
+
+        const statistics& stats() const noexcept { return stats_; };
+
+        /**
+         * write the pipeline's state as an `imu` telemetry record
+         *
+         * fields are: heading, rate, bias x/y/z, stationary, steps, errors, stationary time, mean and longest step time
+         * (times in microseconds)
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            auto s = snapshot();
+            telemetry::write(out, "imu", s.heading, s.rate, s.bias.x, s.bias.y, s.bias.z, s.stationary, stats_.steps,
+                             stats_.errors, stats_.stationary_us,
+                             stats_.steps ? static_cast<std::uint32_t>(stats_.busy_us / stats_.steps) : 0u,
+                             stats_.longest_step_us);
+        };
+    };
+}
+
+#endif // HOTEL_IMU_PIPELINE_HPP
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <optional>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/histogram.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_LATENCY_PROBE_HPP
+#define HOTEL_LATENCY_PROBE_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * kind of device a latency measurement was taken against; only used to key and label results
+     */
+    enum class device_kind : std::uint8_t {
+        motor,
+        rotation,
+        imu,
+        optical,
+        distance,
+        adi,
+        controller,
+        other
+    };
+
+    /**
+     * end-to-end actuation latency measurement
+     *
+     * a measurement takes a short baseline of the feedback signal to estimate its noise, injects a step command, then
+     * polls the feedback every `sample_period_us` until it leaves the baseline band by more than `threshold`. the time
+     * from the command to that first sample is recorded in a histogram keyed by device kind and port. the resolution
+     * of a single measurement is the sample period, so keep it well below the latency you expect to see (the V5 motor
+     * reports at 10ms, so 250us-1ms is plenty).
+     *
+     * events that can't be injected (e.g. a controller button press) can be timestamped elsewhere and fed in with
+     * `record()`.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Motor motor{1};
+     * hotel::latency_probe<> probe;
+     *
+     * for (int i = 0; i < 20; i++) {
+     *     probe.measure(hotel::device_kind::motor, 1,
+     *                   [&motor] { motor.move(60); },
+     *                   [&motor] { return motor.get_position(); },
+     *                   {.threshold = 1.0});
+     *     motor.move(0);
+     *     pros::delay(500);
+     * }
+     *
+     * probe.report(stdout);
+     * probe.save("/usd/latency.csv");
+     * ```
+     *
+     * the measurement itself is validated on the host by running it against `hotel::sim::first_order_plant` with a
+     * known dead time and `hotel::sim::virtual_clock` as the clock: see tools/latency_check.cpp.
+     *
+     * @tparam MaxChannels number of distinct (device kind, port) pairs that can be tracked
+     * @tparam Clock clock used for timestamps and polling
+     * @tparam Buckets number of histogram buckets per channel
+     * @tparam BucketWidth histogram bucket width, in microseconds
+     */
+    template <
+        std::size_t MaxChannels = 8,
+        concepts::MicrosClock Clock = micros_clock,
+        std::size_t Buckets = 40, std::uint32_t BucketWidth = 1000
+    >
+    class latency_probe {
+    public:
+        using histogram_t = histogram<Buckets, BucketWidth>;
+
+        struct options {
+            /// how far (beyond baseline noise) the feedback has to move to count as a response
+            double threshold = 1.0;
+            /// feedback polling period, in microseconds
+            std::uint32_t sample_period_us = 250;
+            /// give up if no response is seen within this long, in microseconds
+            std::uint32_t timeout_us = 200000;
+            /// number of samples taken before the step to establish the baseline
+            std::uint32_t baseline_samples = 8;
+        };
+
+        struct channel {
+            device_kind kind;
+            std::uint8_t port;
+            histogram_t latency;
+            std::uint32_t timeouts;
+        };
+    private:
+        std::array<channel, MaxChannels> channels{};
+        std::size_t channel_count = 0;
+
+        channel* find(device_kind kind, std::uint8_t port) {
+            for (std::size_t i = 0; i < channel_count; i++) {
+                if (channels[i].kind == kind && channels[i].port == port) {
+                    return &channels[i];
+                }
+            }
+
+            if (channel_count == MaxChannels) {
+                return nullptr;
+            }
+
+            channels[channel_count] = {kind, port, {}, 0};
+            return &channels[channel_count++];
+        };
+    public:
+        /**
+         * inject a step and time the response
+         *
+         * @param kind device kind the result is filed under
+         * @param port device port the result is filed under
+         * @param command function that issues the step command
+         * @param feedback function that reads the response signal
+         * @param opts measurement options
+         * @return the latency in microseconds, or `std::nullopt` on timeout (or if the channel table is full)
+         */
+        template <class CommandFn, class FeedbackFn>
+            requires std::invocable<CommandFn> && concepts::FeedbackFunction<double, FeedbackFn>
+        std::optional<std::uint32_t> measure(device_kind kind, std::uint8_t port,
+                                             CommandFn&& command, FeedbackFn&& feedback, options opts = {}) {
+            auto* ch = find(kind, port);
+            if (!ch) {
+                return std::nullopt;
+            }
+
+            // establish the baseline and how noisy it is
+            double lo = static_cast<double>(feedback());
+            double hi = lo;
+            auto t = Clock::now();
+            for (std::uint32_t i = 1; i < opts.baseline_samples; i++) {
+                t += opts.sample_period_us;
+                Clock::wait_until(t);
+                double x = static_cast<double>(feedback());
+                lo = std::min(lo, x);
+                hi = std::max(hi, x);
+            }
+            lo -= opts.threshold;
+            hi += opts.threshold;
+
+            auto start = Clock::now();
+            command();
+
+            for (t = start; t - start < opts.timeout_us;) {
+                t += opts.sample_period_us;
+                Clock::wait_until(t);
+                auto sampled = Clock::now();
+                double x = static_cast<double>(feedback());
+                if (x < lo || x > hi) {
+                    auto latency = static_cast<std::uint32_t>(sampled - start);
+                    ch->latency.add(latency);
+                    return latency;
+                }
+            }
+
+            ch->timeouts++;
+            return std::nullopt;
+        };
+
+        /**
+         * record an externally timestamped command/response pair
+         *
+         * @param kind device kind the result is filed under
+         * @param port device port the result is filed under
+         * @param command_us timestamp of the command (or input event)
+         * @param response_us timestamp the response was first observed
+         */
+        void record(device_kind kind, std::uint8_t port, std::uint64_t command_us, std::uint64_t response_us) {
+            if (auto* ch = find(kind, port); ch && response_us >= command_us) {
+                ch->latency.add(static_cast<std::uint32_t>(response_us - command_us));
+            }
+        };
+
+        /**
+         * look up the results for a channel
+         *
+         * @return the channel, or `nullptr` if nothing has been recorded for it
+         */
+        const channel* results(device_kind kind, std::uint8_t port) const {
+            for (std::size_t i = 0; i < channel_count; i++) {
+                if (channels[i].kind == kind && channels[i].port == port) {
+                    return &channels[i];
+                }
+            }
+            return nullptr;
+        };
+
+        /**
+         * write a summary of every channel as `latency` telemetry records
+         *
+         * fields are: kind, port, count, timeouts, min, mean, p50, p90, p99, max (times in microseconds)
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            for (std::size_t i = 0; i < channel_count; i++) {
+                const auto& ch = channels[i];
+                telemetry::write(out, "latency", ch.kind, ch.port, ch.latency.count(), ch.timeouts,
+                                 ch.latency.min(), ch.latency.mean(), ch.latency.percentile(0.5f),
+                                 ch.latency.percentile(0.9f), ch.latency.percentile(0.99f), ch.latency.max());
+            }
+        };
+
+        /**
+         * append a summary of every channel to a file (e.g. on the SD card)
+         *
+         * @param path file to append to
+         * @return `false` if the file couldn't be opened
+         */
+        bool save(const char* path) const {
+            std::FILE* out = std::fopen(path, "a");
+            if (!out) {
+                return false;
+            }
+            report(out);
+            std::fclose(out);
+            return true;
+        };
+    };
+}
+
+#endif // HOTEL_LATENCY_PROBE_HPP
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_LEAST_SQUARES_HPP
+#define HOTEL_LEAST_SQUARES_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * forward-mode dual number: a value and its gradient with respect to `N` parameters
+     *
+     * write a residual function once, templated on its scalar type, and evaluate it with `dual<N>` to get the Jacobian
+     * row alongside the residual, with no finite differencing and no allocation.
+     *
+     * @tparam N number of parameters
+     */
+    template <std::size_t N>
+    struct dual {
+        double value = 0.0;
+        std::array<double, N> gradient{};
+
+        constexpr dual() = default;
+
+        constexpr dual(double v) : value(v) {};
+
+        /// the `i`th parameter itself, with a unit gradient
+        static constexpr dual parameter(double v, std::size_t i) {
+            dual d{v};
+            d.gradient[i] = 1.0;
+            return d;
+        };
+
+        constexpr dual operator-() const {
+            dual r{-value};
+            for (std::size_t i = 0; i < N; i++) {
+                r.gradient[i] = -gradient[i];
+            }
+            return r;
+        };
+
+        constexpr dual& operator+=(const dual& o) {
+            value += o.value;
+            for (std::size_t i = 0; i < N; i++) {
+                gradient[i] += o.gradient[i];
+            }
+            return *this;
+        };
+
+        constexpr dual& operator-=(const dual& o) {
+            value -= o.value;
+            for (std::size_t i = 0; i < N; i++) {
+                gradient[i] -= o.gradient[i];
+            }
+            return *this;
+        };
+
+        constexpr dual& operator*=(const dual& o) {
+            for (std::size_t i = 0; i < N; i++) {
+                gradient[i] = gradient[i] * o.value + value * o.gradient[i];
+            }
+            value *= o.value;
+            return *this;
+        };
+
+        constexpr dual& operator/=(const dual& o) {
+            auto inverse = 1.0 / o.value;
+            value *= inverse;
+            for (std::size_t i = 0; i < N; i++) {
+                gradient[i] = (gradient[i] - value * o.gradient[i]) * inverse;
+            }
+            return *this;
+        };
+
+        friend constexpr dual operator+(dual a, const dual& b) { return a += b; };
+
+        friend constexpr dual operator-(dual a, const dual& b) { return a -= b; };
+
+        friend constexpr dual operator*(dual a, const dual& b) { return a *= b; };
+
+        friend constexpr dual operator/(dual a, const dual& b) { return a /= b; };
+
+        friend dual sqrt(const dual& a) {
+            auto root = std::sqrt(a.value);
+            return a.chain(root, 0.5 / root);
+        };
+
+        friend dual exp(const dual& a) {
+            auto e = std::exp(a.value);
+            return a.chain(e, e);
+        };
+
+        friend dual sin(const dual& a) { return a.chain(std::sin(a.value), std::cos(a.value)); };
+
+        friend dual cos(const dual& a) { return a.chain(std::cos(a.value), -std::sin(a.value)); };
+    private:
+        /// `f(*this)`, given `f` and its derivative at `value`
+        constexpr dual chain(double f, double derivative) const {
+            dual r{f};
+            for (std::size_t i = 0; i < N; i++) {
+                r.gradient[i] = gradient[i] * derivative;
+            }
+            return r;
+        };
+    };
+
+    namespace detail {
+        /**
+         * solve `a x = b` in place for symmetric positive definite `a`, by Cholesky decomposition
+         *
+         * @return `false` if `a` isn't positive definite
+         */
+        template <std::size_t N>
+        bool cholesky_solve(std::array<std::array<double, N>, N>& a, std::array<double, N>& b) {
+            for (std::size_t j = 0; j < N; j++) {
+                double d = a[j][j];
+                for (std::size_t k = 0; k < j; k++) {
+                    d -= a[j][k] * a[j][k];
+                }
+                if (!(d > 0.0)) {
+                    return false;
+                }
+                a[j][j] = std::sqrt(d);
+                for (std::size_t i = j + 1; i < N; i++) {
+                    double s = a[i][j];
+                    for (std::size_t k = 0; k < j; k++) {
+                        s -= a[i][k] * a[j][k];
+                    }
+                    a[i][j] = s / a[j][j];
+                }
+            }
+            for (std::size_t i = 0; i < N; i++) {
+                for (std::size_t k = 0; k < i; k++) {
+                    b[i] -= a[i][k] * b[k];
+                }
+                b[i] /= a[i][i];
+            }
+            for (std::size_t i = N; i-- > 0;) {
+                for (std::size_t k = i + 1; k < N; k++) {
+                    b[i] -= a[k][i] * b[k];
+                }
+                b[i] /= a[i][i];
+            }
+            return true;
+        };
+    }
+
+    struct least_squares_options {
+        /// iterations before giving up
+        std::uint32_t max_iterations = 50;
+        /// starting damping; small is close to Gauss-Newton
+        double initial_damping = 1e-3;
+        /// stop once a step changes no parameter by more than this fraction of its magnitude (or absolutely, near 0)
+        double step_tolerance = 1e-9;
+        /// stop once a step reduces the cost by less than this fraction
+        double cost_tolerance = 1e-12;
+    };
+
+    template <std::size_t P>
+    struct least_squares_result {
+        std::array<double, P> x;
+        /// sum of squared residuals at `x`
+        double cost;
+        /// number of residuals
+        std::size_t residuals;
+        std::uint32_t iterations;
+        /// whether a tolerance was met, rather than running out of iterations or damping
+        bool converged;
+    };
+
+    /**
+     * minimize a sum of squared residuals with Levenberg–Marquardt
+     *
+     * the model is called with the parameters and an `emit` function, and calls `emit(r)` once per residual `r`. it
+     * must be generic over its scalar type: it's run with `dual<P>` to linearize (the Jacobian rows are accumulated
+     * straight into the normal equations, so the residual count doesn't cost any memory) and with `double` to evaluate
+     * trial steps. it must emit the same residuals in the same order every time.
+     *
+     * each iteration solves @f$(J^T J + \lambda\,\mathrm{diag}(J^T J))\,\delta = -J^T r@f$ by Cholesky decomposition.
+     * a step that lowers the cost is taken and the damping reduced (towards Gauss-Newton); one that doesn't is
+     * rejected and the damping raised (towards gradient descent). a parameter nothing depends on makes the problem
+     * singular, so give such parameters a prior residual (a weighted distance from a nominal value).
+     *
+     * example:
+     * ```{.cpp}
+     * // fit y = a e^{b t}
+     * auto result = hotel::levenberg_marquardt<2>([&] (const auto& p, auto&& emit) {
+     *     using std::exp;
+     *     for (auto [t, y] : samples) {
+     *         emit(p[0] * exp(p[1] * t) - y);
+     *     }
+     * }, {1.0, 0.0});
+     * ```
+     *
+     * @tparam P number of parameters
+     * @param model `model(const std::array<T, P>& x, emit)`
+     * @param x0 starting point
+     * @param options iteration limits and tolerances
+     */
+    template <std::size_t P, class Model>
+    least_squares_result<P> levenberg_marquardt(Model&& model, std::array<double, P> x0,
+                                                least_squares_options options = {}) {
+        using matrix = std::array<std::array<double, P>, P>;
+        least_squares_result<P> result{x0, 0.0, 0, 0, false};
+
+        matrix jtj;
+        std::array<double, P> jtr;
+        auto linearize = [&] (const std::array<double, P>& x) {
+            std::array<dual<P>, P> xd;
+            for (std::size_t i = 0; i < P; i++) {
+                xd[i] = dual<P>::parameter(x[i], i);
+            }
+            jtj = {};
+            jtr = {};
+            double cost = 0.0;
+            std::size_t count = 0;
+            model(static_cast<const std::array<dual<P>, P>&>(xd), [&] (const dual<P>& r) {
+                for (std::size_t i = 0; i < P; i++) {
+                    for (std::size_t j = 0; j <= i; j++) {
+                        jtj[i][j] += r.gradient[i] * r.gradient[j];
+                    }
+                    jtr[i] += r.gradient[i] * r.value;
+                }
+                cost += r.value * r.value;
+                count++;
+            });
+            result.residuals = count;
+            return cost;
+        };
+        auto evaluate = [&] (const std::array<double, P>& x) {
+            double cost = 0.0;
+            model(x, [&] (double r) { cost += r * r; });
+            return cost;
+        };
+
+        auto& x = result.x;
+        double cost = linearize(x);
+        double damping = options.initial_damping;
+        while (result.iterations < options.max_iterations) {
+            result.iterations++;
+
+            matrix a;
+            std::array<double, P> step;
+            for (std::size_t i = 0; i < P; i++) {
+                for (std::size_t j = 0; j <= i; j++) {
+                    a[i][j] = jtj[i][j];
+                }
+                a[i][i] += damping * std::max(jtj[i][i], 1e-12);
+                step[i] = -jtr[i];
+            }
+            if (!detail::cholesky_solve(a, step)) {
+                damping *= 10.0;
+                if (damping > 1e12) {
+                    break;
+                }
+                continue;
+            }
+
+            std::array<double, P> trial;
+            bool small_step = true;
+            for (std::size_t i = 0; i < P; i++) {
+                trial[i] = x[i] + step[i];
+                small_step &= std::fabs(step[i]) <= options.step_tolerance * (std::fabs(x[i]) + options.step_tolerance);
+            }
+
+            double trial_cost = evaluate(trial);
+            if (trial_cost < cost) {
+                bool small_reduction = cost - trial_cost <= options.cost_tolerance * cost;
+                x = trial;
+                damping = std::max(damping / 10.0, 1e-12);
+                if (small_step || small_reduction) {
+                    cost = trial_cost;
+                    result.converged = true;
+                    break;
+                }
+                cost = linearize(x);
+            } else {
+                if (small_step) {
+                    result.converged = true;
+                    break;
+                }
+                damping *= 10.0;
+                if (damping > 1e12) {
+                    break;
+                }
+            }
+        }
+        result.cost = cost;
+        return result;
+    };
+}
+
+#endif // HOTEL_LEAST_SQUARES_HPP
@@ -0,0 +1,431 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/framing.hpp"
+#include "hotel/serial_stream.hpp"
+
+#ifndef HOTEL_LINK_MUX_HPP
+#define HOTEL_LINK_MUX_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    namespace detail {
+        /**
+         * fixed-size ring of variable-length messages, each stored behind a 2-byte length
+         */
+        template <std::size_t Bytes>
+        class message_ring {
+            std::array<std::uint8_t, Bytes> bytes{};
+            std::size_t head = 0;
+            std::size_t tail = 0;
+
+            void copy_in(std::size_t at, const std::uint8_t* data, std::size_t n) noexcept {
+                auto p = at % Bytes;
+                auto low = std::min(n, Bytes - p);
+                std::memcpy(&bytes[p], data, low);
+                std::memcpy(&bytes[0], data + low, n - low);
+            };
+
+            void copy_out(std::size_t at, std::uint8_t* data, std::size_t n) const noexcept {
+                auto p = at % Bytes;
+                auto low = std::min(n, Bytes - p);
+                std::memcpy(data, &bytes[p], low);
+                std::memcpy(data + low, &bytes[0], n - low);
+            };
+        public:
+            /// space a message of `n` bytes takes up in the ring
+            static constexpr std::size_t cost(std::size_t n) noexcept { return n + 2; };
+
+            bool push(std::span<const std::uint8_t> message) noexcept {
+                if (Bytes - (tail - head) < cost(message.size())) {
+                    return false;
+                }
+                std::uint8_t length[2] = {static_cast<std::uint8_t>(message.size()),
+                                          static_cast<std::uint8_t>(message.size() >> 8)};
+                copy_in(tail, length, 2);
+                copy_in(tail + 2, message.data(), message.size());
+                tail += cost(message.size());
+                return true;
+            };
+
+            /// size of the oldest message; the ring must not be empty
+            std::size_t front_size() const noexcept {
+                std::uint8_t length[2];
+                copy_out(head, length, 2);
+                return length[0] | length[1] << 8;
+            };
+
+            /// copy out the oldest message without removing it
+            std::size_t peek(std::uint8_t* out) const noexcept {
+                auto n = front_size();
+                copy_out(head + 2, out, n);
+                return n;
+            };
+
+            void pop() noexcept { head += cost(front_size()); };
+
+            bool empty() const noexcept { return head == tail; };
+
+            /// bytes in use, including length prefixes
+            std::size_t used() const noexcept { return tail - head; };
+        };
+    }
+
+    /**
+     * several logical channels over one serial link, with priorities, bandwidth budgets and flow control
+     *
+     * each channel is a queue of messages. every `service()` call reads whatever has arrived and then fills the link's
+     * transmit buffer (as reported by `get_write_free()`) with whole frames, choosing what to send by:
+     *  - priority: a channel with something sendable always goes ahead of any lower-priority channel
+     *  - budget: a channel with a byte rate can't exceed it, beyond a small burst
+     *  - weighted fair queuing: channels at the same priority share what's left in proportion to their weights
+     *  - credit: nothing is sent unless the peer has room for it in that channel's receive queue
+     *
+     * so a log download on a low-priority, budgeted channel can never hold up live telemetry, and can't overrun a peer
+     * that isn't reading it.
+     *
+     * both ends of the link run a `link_mux` with the same channel count and queue size. credit is carried as each
+     * channel's running byte offset rather than as increments, so a corrupted data or credit frame can't leak any of
+     * it; the next update fixes it up. credit updates are repeated every `credit_refresh_us`, and a channel that's out
+     * of credit sends its offset at the same rate, so losses can't stall a channel for good.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Serial port{11, 230400};
+     * hotel::link_mux<pros::Serial, 3> mux{port, {{
+     *     {.priority = 2},                                 // 0: control telemetry
+     *     {.priority = 1},                                 // 1: tuning commands
+     *     {.priority = 0, .bytes_per_second = 8000},       // 2: log download
+     * }}};
+     *
+     * while (true) {
+     *     mux.send(0, telemetry_bytes);
+     *     std::uint8_t command[hotel::link_mux<pros::Serial, 3>::max_message];
+     *     if (auto n = mux.receive(1, command)) {
+     *         apply_tuning({command, n});
+     *     }
+     *     mux.service();
+     *     pros::delay(5);
+     * }
+     * ```
+     *
+     * @tparam Link serial link type (`pros::Serial`, or a stand-in)
+     * @tparam Channels number of logical channels (at most 127)
+     * @tparam QueueBytes size of each channel's transmit and receive queues
+     * @tparam Clock clock budgets and credit refreshes are measured against
+     */
+    template <concepts::SerialLink Link, std::size_t Channels = 4, std::size_t QueueBytes = 1024,
+              concepts::MicrosClock Clock = micros_clock>
+        requires (Channels > 0 && Channels < 0x80 && QueueBytes < 0x8000)
+    class link_mux {
+    public:
+        /// largest message a channel can carry
+        static constexpr std::size_t max_message = 240;
+        /// data frames carry the channel and its byte offset ahead of the message
+        static constexpr std::size_t data_header = 3;
+        static constexpr std::uint8_t credit_tag = 0xff;
+        static constexpr std::uint8_t probe_flag = 0x80;
+        static constexpr std::uint64_t credit_refresh_us = 100000;
+
+        using format = framing::format<framing::sync<0xa5, 0x5a>, framing::length<std::uint8_t>, framing::crc16_ccitt,
+                                       data_header + max_message>;
+
+        struct channel_config {
+            /// higher goes first
+            std::uint8_t priority = 0;
+            /// share of the link relative to other channels at the same priority
+            std::uint16_t weight = 1;
+            /// byte rate limit; 0 for none
+            std::uint32_t bytes_per_second = 0;
+            /// bytes that can be sent at once over the rate limit after a quiet period
+            std::uint32_t burst = 512;
+        };
+
+        struct channel_stats {
+            std::uint32_t tx_messages = 0;
+            std::uint64_t tx_bytes = 0;
+            std::uint32_t rx_messages = 0;
+            std::uint64_t rx_bytes = 0;
+            /// messages refused by `send()` because the queue was full
+            std::uint32_t tx_drops = 0;
+            /// messages that arrived with no room (the peer ignored flow control)
+            std::uint32_t rx_drops = 0;
+            /// `service()` calls in which the channel had something to send but no credit
+            std::uint32_t credit_stalls = 0;
+        };
+    private:
+        using ring_t = detail::message_ring<QueueBytes>;
+
+        struct channel {
+            channel_config config;
+            channel_stats stats;
+
+            ring_t tx;
+            /// running byte offset of what we've sent, and how far the peer has told us it can take
+            std::uint16_t sent = 0;
+            std::uint16_t peer_ack = 0;
+            /// WFQ finish tag of the message at the head of the queue
+            std::uint64_t finish = 0;
+            bool finish_valid = false;
+            /// budget tokens, in bytes
+            float tokens = 0.0f;
+            std::uint64_t probed_at = 0;
+            /// whether this `service()` has already counted a credit stall
+            bool stalled = false;
+
+            ring_t rx;
+            /// running byte offset of the last message received, and the ack last sent back
+            std::uint16_t received = 0;
+            std::uint16_t acked = 0;
+            std::uint64_t acked_at = 0;
+        };
+
+        Link& link;
+        serial_stream<format, Link, 2 * format::max_frame + 256> stream;
+        std::array<channel, Channels> channels;
+        std::uint64_t virtual_time = 0;
+        std::uint64_t last_refill;
+        std::array<std::uint8_t, format::max_frame> frame{};
+        std::array<std::uint8_t, data_header + max_message> payload{};
+
+        std::uint16_t ack_of(const channel& c) const noexcept {
+            return static_cast<std::uint16_t>(c.received - c.rx.used());
+        };
+
+        void on_frame(std::span<const std::uint8_t> p) {
+            if (p.size() == 4 && p[0] == credit_tag) {
+                if (p[1] < Channels) {
+                    channels[p[1]].peer_ack = static_cast<std::uint16_t>(p[2] | p[3] << 8);
+                }
+                return;
+            }
+            if (p.size() < data_header || (p[0] & ~probe_flag) >= Channels) {
+                return;
+            }
+
+            auto& c = channels[p[0] & ~probe_flag];
+            if (p[0] & probe_flag) {
+                c.received = static_cast<std::uint16_t>(p[1] | p[2] << 8);
+                return;
+            }
+            auto message = p.subspan(data_header);
+            if (c.rx.push(message)) {
+                c.received = static_cast<std::uint16_t>(p[1] | p[2] << 8);
+                c.stats.rx_messages++;
+                c.stats.rx_bytes += message.size();
+            } else {
+                // count it as consumed so the offsets stay in step
+                c.received = static_cast<std::uint16_t>(p[1] | p[2] << 8);
+                c.stats.rx_drops++;
+            }
+        };
+
+        bool write_frame(std::size_t size, std::int32_t& room) {
+            auto n = format::encode({payload.data(), size}, frame.data());
+            if (static_cast<std::int32_t>(n) > room) {
+                return false;
+            }
+            link.write(frame.data(), static_cast<std::int32_t>(n));
+            room -= static_cast<std::int32_t>(n);
+            return true;
+        };
+
+        void send_credits(std::int32_t& room, std::uint64_t now) {
+            for (std::size_t i = 0; i < Channels; i++) {
+                auto& c = channels[i];
+                auto ack = ack_of(c);
+                auto moved = static_cast<std::uint16_t>(ack - c.acked);
+                if (moved < QueueBytes / 4 && !(moved && c.rx.empty()) && now - c.acked_at < credit_refresh_us) {
+                    continue;
+                }
+                payload[0] = credit_tag;
+                payload[1] = static_cast<std::uint8_t>(i);
+                payload[2] = static_cast<std::uint8_t>(ack);
+                payload[3] = static_cast<std::uint8_t>(ack >> 8);
+                if (!write_frame(4, room)) {
+                    return;
+                }
+                c.acked = ack;
+                c.acked_at = now;
+            }
+        };
+
+        /**
+         * tell the peer where each credit-starved channel's offset is, in case the frames that would have told it were
+         * lost on the way
+         */
+        void send_probes(std::int32_t& room, std::uint64_t now) {
+            for (std::size_t i = 0; i < Channels; i++) {
+                auto& c = channels[i];
+                if (c.tx.empty() || credit(i) >= ring_t::cost(c.tx.front_size()) ||
+                    now - c.probed_at < credit_refresh_us) {
+                    continue;
+                }
+                payload[0] = static_cast<std::uint8_t>(i | probe_flag);
+                payload[1] = static_cast<std::uint8_t>(c.sent);
+                payload[2] = static_cast<std::uint8_t>(c.sent >> 8);
+                if (!write_frame(data_header, room)) {
+                    return;
+                }
+                c.probed_at = now;
+            }
+        };
+
+        /**
+         * @return the channel that should send next, or `Channels` if none can
+         */
+        std::size_t pick(std::int32_t room) {
+            std::size_t best = Channels;
+            for (std::size_t i = 0; i < Channels; i++) {
+                auto& c = channels[i];
+                if (c.tx.empty()) {
+                    continue;
+                }
+
+                auto size = c.tx.front_size();
+                if (static_cast<std::int32_t>(format::frame_size(data_header + size)) > room) {
+                    continue;
+                }
+                if (c.config.bytes_per_second && c.tokens < static_cast<float>(size)) {
+                    continue;
+                }
+                if (static_cast<std::uint16_t>(c.peer_ack + QueueBytes - c.sent) < ring_t::cost(size)) {
+                    if (!c.stalled) {
+                        c.stats.credit_stalls++;
+                        c.stalled = true;
+                    }
+                    continue;
+                }
+
+                if (!c.finish_valid) {
+                    c.finish = std::max(virtual_time, c.finish) + (static_cast<std::uint64_t>(size) << 16) /
+                                                                   std::max<std::uint16_t>(c.config.weight, 1);
+                    c.finish_valid = true;
+                }
+
+                if (best == Channels || c.config.priority > channels[best].config.priority ||
+                    (c.config.priority == channels[best].config.priority && c.finish < channels[best].finish)) {
+                    best = i;
+                }
+            }
+            return best;
+        };
+
+        void refill(std::uint64_t now) {
+            auto dt = static_cast<float>(now - last_refill) * 1e-6f;
+            last_refill = now;
+            for (auto& c : channels) {
+                if (c.config.bytes_per_second) {
+                    c.tokens = std::min(c.tokens + dt * c.config.bytes_per_second, static_cast<float>(c.config.burst));
+                }
+            }
+        };
+    public:
+        /**
+         * @param l the link; must outlive the mux
+         * @param configs per-channel configuration
+         */
+        link_mux(Link& l, const std::array<channel_config, Channels>& configs = {}) :
+            link(l),
+            stream(l),
+            last_refill(Clock::now()) {
+            for (std::size_t i = 0; i < Channels; i++) {
+                channels[i].config = configs[i];
+                channels[i].tokens = static_cast<float>(configs[i].burst);
+            }
+        };
+
+        /**
+         * queue a message on a channel
+         *
+         * @return `false` if it's longer than `max_message` or the channel's queue is full
+         */
+        bool send(std::size_t ch, std::span<const std::uint8_t> message) {
+            auto& c = channels[ch];
+            if (message.size() > max_message || !c.tx.push(message)) {
+                c.stats.tx_drops++;
+                return false;
+            }
+            return true;
+        };
+
+        /**
+         * take the oldest message received on a channel
+         *
+         * @param out where to copy it; needs room for `max_message` bytes
+         * @return its size, or 0 if there wasn't one
+         */
+        std::size_t receive(std::size_t ch, std::span<std::uint8_t> out) {
+            auto& c = channels[ch];
+            if (c.rx.empty() || out.size() < c.rx.front_size()) {
+                return 0;
+            }
+            auto n = c.rx.peek(out.data());
+            c.rx.pop();
+            return n;
+        };
+
+        /**
+         * read what's arrived, then send as much as the link will take right now
+         */
+        void service() {
+            stream.poll([this] (std::span<const std::uint8_t> p) { on_frame(p); });
+
+            auto now = Clock::now();
+            refill(now);
+
+            auto room = link.get_write_free();
+            send_credits(room, now);
+
+            // pick() is called once per message sent, but a stall is counted once per service()
+            for (auto& c : channels) {
+                c.stalled = false;
+            }
+            for (std::size_t ch; (ch = pick(room)) != Channels;) {
+                auto& c = channels[ch];
+                auto size = c.tx.peek(payload.data() + data_header);
+                auto offset = static_cast<std::uint16_t>(c.sent + ring_t::cost(size));
+                payload[0] = static_cast<std::uint8_t>(ch);
+                payload[1] = static_cast<std::uint8_t>(offset);
+                payload[2] = static_cast<std::uint8_t>(offset >> 8);
+                write_frame(data_header + size, room);
+
+                c.tx.pop();
+                c.sent = offset;
+                c.finish_valid = false;
+                virtual_time = c.finish;
+                if (c.config.bytes_per_second) {
+                    c.tokens -= static_cast<float>(size);
+                }
+                c.stats.tx_messages++;
+                c.stats.tx_bytes += size;
+            }
+
+            send_probes(room, now);
+        };
+
+        const channel_stats& stats(std::size_t ch) const noexcept { return channels[ch].stats; };
+
+        /// bytes waiting in a channel's transmit queue, including per-message overhead
+        std::size_t queued(std::size_t ch) const noexcept { return channels[ch].tx.used(); };
+
+        /// bytes the peer can currently take on a channel
+        std::size_t credit(std::size_t ch) const noexcept {
+            const auto& c = channels[ch];
+            return static_cast<std::uint16_t>(c.peer_ack + QueueBytes - c.sent);
+        };
+
+        /// the underlying frame parser, for its error statistics
+        const auto& link_stats() const noexcept { return stream.stats(); };
+    };
+}
+
+#endif // HOTEL_LINK_MUX_HPP
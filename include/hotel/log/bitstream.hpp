@@ -0,0 +1,114 @@
+#include <array>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_LOG_BITSTREAM_HPP
+#define HOTEL_LOG_BITSTREAM_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::log {
+
+    /**
+     * append-only bit buffer with fixed capacity
+     *
+     * bits are packed most-significant first. writes past the end are dropped and latch `overflowed()`, so size the
+     * buffer for the worst case of whatever is being encoded into it.
+     *
+     * @tparam Bytes capacity, in bytes
+     */
+    template <std::size_t Bytes>
+    class bit_writer {
+        std::array<std::uint8_t, Bytes> buffer{};
+        std::size_t bits = 0;
+        bool overflow = false;
+    public:
+        /**
+         * append the low `count` bits of `value`
+         *
+         * @param value bits to write
+         * @param count number of bits, at most 64
+         */
+        void write(std::uint64_t value, unsigned count) {
+            if (bits + count > Bytes * 8) {
+                overflow = true;
+                return;
+            }
+
+            while (count) {
+                auto free = 8 - (bits & 7);
+                auto n = count < free ? count : free;
+                auto chunk = static_cast<std::uint8_t>((value >> (count - n)) & ((1u << n) - 1));
+                buffer[bits >> 3] |= static_cast<std::uint8_t>(chunk << (free - n));
+                bits += n;
+                count -= n;
+            }
+        };
+
+        void write_bit(bool bit) { write(bit, 1); };
+
+        /**
+         * forget everything written so far
+         */
+        void clear() {
+            buffer.fill(0);
+            bits = 0;
+            overflow = false;
+        };
+
+        const std::uint8_t* data() const noexcept { return buffer.data(); };
+
+        std::size_t size_bits() const noexcept { return bits; };
+
+        std::size_t size_bytes() const noexcept { return (bits + 7) / 8; };
+
+        bool overflowed() const noexcept { return overflow; };
+    };
+
+    /**
+     * reader for bits packed by `hotel::log::bit_writer`
+     *
+     * reading past the end yields zeroes and latches `exhausted()`.
+     */
+    class bit_reader {
+        const std::uint8_t* buffer;
+        std::size_t length;
+        std::size_t bits = 0;
+        bool exhausted_ = false;
+    public:
+        bit_reader(const std::uint8_t* data, std::size_t bytes) : buffer(data), length(bytes * 8) {};
+
+        /**
+         * read `count` bits
+         *
+         * @param count number of bits, at most 64
+         * @return the bits, right-aligned
+         */
+        std::uint64_t read(unsigned count) {
+            std::uint64_t value = 0;
+            if (bits + count > length) {
+                exhausted_ = true;
+                bits = length;
+                return 0;
+            }
+
+            while (count) {
+                auto available = 8 - (bits & 7);
+                auto n = count < available ? count : available;
+                auto byte = buffer[bits >> 3];
+                value = (value << n) | ((byte >> (available - n)) & ((1u << n) - 1));
+                bits += n;
+                count -= n;
+            }
+
+            return value;
+        };
+
+        bool read_bit() { return read(1); };
+
+        bool exhausted() const noexcept { return exhausted_; };
+    };
+}
+
+#endif // HOTEL_LOG_BITSTREAM_HPP
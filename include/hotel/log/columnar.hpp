@@ -0,0 +1,732 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/export.hpp"
+#include "hotel/log/bitstream.hpp"
+
+#ifndef HOTEL_LOG_COLUMNAR_HPP
+#define HOTEL_LOG_COLUMNAR_HPP
+
+/**
+ * @file columnar.hpp
+ *
+ * chunked, compressed, columnar match logs
+ *
+ * a log is a file header naming the channels, followed by self-contained chunks. each chunk has a fixed-size header
+ * (sample count, first and last timestamp) and a per-channel index entry (min, max, compressed size), followed by one
+ * compressed column for the timestamps and one per channel. a query only has to decode the columns it asks for, and
+ * can skip whole chunks from the index alone. everything is little-endian, which both the brain and any host we care
+ * about are.
+ *
+ * - timestamps (microseconds) are delta-of-delta encoded into variable-width buckets, so a fixed-rate loop costs one
+ *   bit per sample
+ * - float channels are XOR'd against the previous value and only the meaningful bits are stored (the gorilla scheme),
+ *   so slowly changing or repeated values are a handful of bits each
+ * - a channel with a deadband is passed through a swinging-door filter first, which only keeps the points needed to
+ *   reconstruct the signal to within the deadband by linear interpolation
+ *
+ * a chunk that was only partly written (e.g. the brain was switched off mid-write) is ignored by the reader, and every
+ * chunk before it is still readable.
+ */
+
+HOTEL_MODULE_EXPORT namespace hotel::log {
+
+    inline constexpr std::uint32_t file_magic = 0x314c4348;  // "HCL1"
+    inline constexpr std::uint32_t chunk_magic = 0x4b4e4843; // "CHNK"
+
+    /**
+     * describes one logged channel
+     */
+    struct channel_spec {
+        /// name the host tools find the channel by
+        const char* name;
+        /// swinging-door deadband, in channel units; 0 stores every sample exactly
+        float deadband = 0.0f;
+    };
+
+    /**
+     * fixed-size header at the start of every chunk
+     */
+    struct chunk_header {
+        std::uint32_t magic;
+        /// bytes following the header and index
+        std::uint32_t payload_bytes;
+        std::uint64_t first_us;
+        std::uint64_t last_us;
+        std::uint32_t timestamp_bytes;
+        std::uint16_t samples;
+        std::uint16_t channels;
+    };
+    static_assert(sizeof(chunk_header) == 32);
+
+    /**
+     * per-channel index entry following the chunk header
+     */
+    struct channel_index {
+        float min;
+        float max;
+        std::uint32_t bytes;
+        /// number of stored points (less than the chunk's sample count when a deadband is in use)
+        std::uint16_t points;
+        std::uint16_t reserved;
+    };
+    static_assert(sizeof(channel_index) == 16);
+
+    namespace detail {
+        // gamma code for n >= 1: floor(log2 n) zeroes, then n
+        template <class Writer>
+        void write_gamma(Writer& out, std::uint32_t n) {
+            unsigned width = std::bit_width(n) - 1;
+            out.write(0, width);
+            out.write(n, width + 1);
+        };
+
+        inline std::uint32_t read_gamma(bit_reader& in) {
+            unsigned width = 0;
+            while (!in.read_bit()) {
+                if (in.exhausted() || ++width > 31) {
+                    return 1;
+                }
+            }
+            return static_cast<std::uint32_t>((std::uint64_t{1} << width) | in.read(width));
+        };
+    }
+
+    /**
+     * delta-of-delta timestamp encoder
+     *
+     * the first timestamp lives in the chunk header; after that each sample costs 1 bit if the period didn't change,
+     * and 9, 12, 16 or 68 bits depending on how much it did.
+     */
+    class timestamp_encoder {
+        std::uint64_t previous = 0;
+        std::int64_t previous_delta = 0;
+        bool started = false;
+    public:
+        template <class Writer>
+        void encode(Writer& out, std::uint64_t t) {
+            if (!started) {
+                started = true;
+                previous = t;
+                return;
+            }
+
+            auto delta = static_cast<std::int64_t>(t - previous);
+            auto dod = delta - previous_delta;
+            previous = t;
+            previous_delta = delta;
+
+            if (dod == 0) {
+                out.write(0b0, 1);
+            } else if (dod >= -63 && dod <= 64) {
+                out.write(0b10, 2);
+                out.write(static_cast<std::uint64_t>(dod + 63), 7);
+            } else if (dod >= -255 && dod <= 256) {
+                out.write(0b110, 3);
+                out.write(static_cast<std::uint64_t>(dod + 255), 9);
+            } else if (dod >= -2047 && dod <= 2048) {
+                out.write(0b1110, 4);
+                out.write(static_cast<std::uint64_t>(dod + 2047), 12);
+            } else {
+                out.write(0b1111, 4);
+                out.write(static_cast<std::uint64_t>(dod), 64);
+            }
+        };
+
+        void reset() { *this = timestamp_encoder{}; };
+
+        /**
+         * decode `out.size()` timestamps
+         *
+         * @param in the timestamp column
+         * @param first the chunk's first timestamp
+         * @param out where to put the timestamps
+         */
+        static void decode(bit_reader& in, std::uint64_t first, std::span<std::uint64_t> out) {
+            if (out.empty()) {
+                return;
+            }
+
+            out[0] = first;
+            std::int64_t delta = 0;
+            for (std::size_t i = 1; i < out.size(); i++) {
+                std::int64_t dod;
+                if (!in.read_bit()) {
+                    dod = 0;
+                } else if (!in.read_bit()) {
+                    dod = static_cast<std::int64_t>(in.read(7)) - 63;
+                } else if (!in.read_bit()) {
+                    dod = static_cast<std::int64_t>(in.read(9)) - 255;
+                } else if (!in.read_bit()) {
+                    dod = static_cast<std::int64_t>(in.read(12)) - 2047;
+                } else {
+                    dod = static_cast<std::int64_t>(in.read(64));
+                }
+                delta += dod;
+                out[i] = out[i - 1] + delta;
+            }
+        };
+    };
+
+    /**
+     * XOR float encoder
+     *
+     * an unchanged value costs 1 bit. otherwise the XOR with the previous value is stored as just its meaningful bits,
+     * reusing the previous leading/trailing-zero window when it still fits.
+     */
+    class float_encoder {
+        std::uint32_t previous = 0;
+        unsigned leading = 0;
+        unsigned trailing = 0;
+        bool started = false;
+        bool has_window = false;
+    public:
+        template <class Writer>
+        void encode(Writer& out, float value) {
+            auto bits = std::bit_cast<std::uint32_t>(value);
+            if (!started) {
+                started = true;
+                previous = bits;
+                out.write(bits, 32);
+                return;
+            }
+
+            auto x = bits ^ previous;
+            previous = bits;
+            if (!x) {
+                out.write(0b0, 1);
+                return;
+            }
+
+            out.write(0b1, 1);
+            unsigned lead = std::min(std::countl_zero(x), 31);
+            unsigned trail = std::countr_zero(x);
+            if (has_window && lead >= leading && trail >= trailing) {
+                out.write(0b0, 1);
+                out.write(x >> trailing, 32 - leading - trailing);
+            } else {
+                unsigned significant = 32 - lead - trail;
+                out.write(0b1, 1);
+                out.write(lead, 5);
+                out.write(significant - 1, 5);
+                out.write(x >> trail, significant);
+                leading = lead;
+                trailing = trail;
+                has_window = true;
+            }
+        };
+
+        void reset() { *this = float_encoder{}; };
+
+        /**
+         * stateful decoder matching `float_encoder`
+         */
+        class decoder {
+            std::uint32_t previous = 0;
+            unsigned leading = 0;
+            unsigned trailing = 0;
+            bool started = false;
+        public:
+            float decode(bit_reader& in) {
+                if (!started) {
+                    started = true;
+                    previous = static_cast<std::uint32_t>(in.read(32));
+                } else if (in.read_bit()) {
+                    if (in.read_bit()) {
+                        leading = static_cast<unsigned>(in.read(5));
+                        auto significant = static_cast<unsigned>(in.read(5)) + 1;
+                        trailing = 32 - leading - std::min(significant, 32 - leading);
+                    }
+                    previous ^= static_cast<std::uint32_t>(in.read(32 - leading - trailing)) << trailing;
+                }
+                return std::bit_cast<float>(previous);
+            };
+        };
+    };
+
+    /**
+     * swinging-door trending filter
+     *
+     * keeps a point only when the signal can no longer be reproduced to within the deadband by a straight line from
+     * the last kept point. the point kept is the one on the middle of the feasible door at the last sample that still
+     * fit, rather than the sample itself, which is what makes the deadband a hard bound on the reconstruction error.
+     * feed it every sample with `push()`, and call `flush()` at the end of the chunk to keep the final point.
+     */
+    class swinging_door {
+    public:
+        struct point {
+            std::uint16_t index;
+            std::uint64_t t;
+            float value;
+        };
+    private:
+        float deadband;
+        point archived{};
+        point last{};
+        double slope_upper = 0.0;
+        double slope_lower = 0.0;
+        bool started = false;
+        bool pending = false;
+
+        void open_door(const point& to) {
+            double dt = static_cast<double>(to.t - archived.t);
+            dt = dt > 0.0 ? dt : 1.0;
+            slope_upper = (to.value + deadband - archived.value) / dt;
+            slope_lower = (to.value - deadband - archived.value) / dt;
+        };
+
+        point on_door(const point& p) const {
+            auto slope = (slope_upper + slope_lower) / 2.0;
+            return {p.index, p.t, static_cast<float>(archived.value + slope * static_cast<double>(p.t - archived.t))};
+        };
+    public:
+        explicit swinging_door(float deadband = 0.0f) : deadband(deadband) {};
+
+        /**
+         * offer a sample
+         *
+         * @return the point to keep, if this sample means one has to be kept
+         */
+        std::optional<point> push(point p) {
+            if (!started) {
+                started = true;
+                archived = last = p;
+                pending = false;
+                return p;
+            }
+
+            std::optional<point> kept;
+            double dt = static_cast<double>(p.t - archived.t);
+            dt = dt > 0.0 ? dt : 1.0;
+            double upper = std::min(slope_upper, (p.value + deadband - archived.value) / dt);
+            double lower = std::max(slope_lower, (p.value - deadband - archived.value) / dt);
+            if (!pending) {
+                open_door(p);
+            } else if (lower > upper) {
+                kept = archived = on_door(last);
+                open_door(p);
+            } else {
+                slope_upper = upper;
+                slope_lower = lower;
+            }
+
+            last = p;
+            pending = true;
+            return kept;
+        };
+
+        /**
+         * end the current run
+         *
+         * @return the point for the last sample, if it hasn't been kept already
+         */
+        std::optional<point> flush() {
+            std::optional<point> kept;
+            if (started && pending) {
+                kept = on_door(last);
+            }
+            started = false;
+            pending = false;
+            return kept;
+        };
+    };
+
+    /**
+     * incremental columnar log writer
+     *
+     * every `push()` encodes the sample straight into per-column bit buffers, so the cost per sample is a few dozen bit
+     * operations per channel rather than a burst of compression when the chunk fills. when it does fill, the chunk is
+     * written out with one `fwrite` and the buffers start over. all storage is fixed-size and lives in the writer.
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::log::column_writer<3> log{{{
+     *     {"heading"},
+     *     {"lift_position", 0.5f},  // only keep what's needed to stay within half a degree
+     *     {"battery", 0.01f}
+     * }}};
+     *
+     * log.open("/usd/match.hcl");
+     * while (true) {
+     *     log.push(pros::micros(), {imu.get_heading(), lift.get_position(), pros::battery::get_voltage() / 1000.0f});
+     *     pros::delay(10);
+     * }
+     * ```
+     *
+     * @tparam Channels number of float channels
+     * @tparam ChunkSamples samples per chunk; bigger chunks compress better but cost more RAM and lose more on a crash
+     */
+    template <std::size_t Channels, std::size_t ChunkSamples = 256>
+        requires (Channels > 0 && Channels <= std::numeric_limits<std::uint16_t>::max() &&
+                  ChunkSamples > 1 && ChunkSamples <= std::numeric_limits<std::uint16_t>::max())
+    class column_writer {
+        // worst cases: 68 bits per timestamp; gamma-coded index plus a full float (with window) per channel sample
+        static constexpr std::size_t timestamp_bytes = (ChunkSamples * 68 + 7) / 8;
+        static constexpr std::size_t column_bytes = (ChunkSamples * (2 * std::bit_width(ChunkSamples) + 1 + 44) + 7) / 8;
+
+        std::array<channel_spec, Channels> specs;
+        std::FILE* file = nullptr;
+
+        chunk_header header{};
+        std::array<channel_index, Channels> index{};
+        bit_writer<timestamp_bytes> timestamp_column;
+        std::array<bit_writer<column_bytes>, Channels> columns;
+        timestamp_encoder timestamps;
+        std::array<float_encoder, Channels> encoders;
+        std::array<swinging_door, Channels> doors;
+        std::array<std::uint16_t, Channels> last_index{};
+
+        void keep(std::size_t c, const swinging_door::point& p) {
+            detail::write_gamma(columns[c], static_cast<std::uint32_t>(p.index - last_index[c] + 1));
+            last_index[c] = p.index;
+            encoders[c].encode(columns[c], p.value);
+            index[c].points++;
+        };
+
+        void start_chunk() {
+            header = {chunk_magic, 0, 0, 0, 0, 0, static_cast<std::uint16_t>(Channels)};
+            timestamp_column.clear();
+            timestamps.reset();
+            for (std::size_t c = 0; c < Channels; c++) {
+                index[c] = {std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), 0, 0, 0};
+                columns[c].clear();
+                encoders[c].reset();
+                doors[c] = swinging_door{specs[c].deadband};
+                last_index[c] = 0;
+            }
+        };
+    public:
+        /**
+         * construct a writer
+         *
+         * @param channels channel names and deadbands; the names must outlive the writer
+         */
+        explicit column_writer(const std::array<channel_spec, Channels>& channels) : specs(channels) {
+            start_chunk();
+        };
+
+        ~column_writer() { close(); };
+
+        column_writer(const column_writer&) = delete;
+
+        column_writer& operator=(const column_writer&) = delete;
+
+        /**
+         * create (truncate) a log file and write its header
+         *
+         * @param path file to write, e.g. `/usd/match.hcl`
+         * @return `false` if the file couldn't be opened or written
+         */
+        bool open(const char* path) {
+            close();
+            file = std::fopen(path, "wb");
+            if (!file) {
+                return false;
+            }
+
+            std::uint32_t magic = file_magic;
+            std::uint16_t version = 1;
+            auto count = static_cast<std::uint16_t>(Channels);
+            bool ok = std::fwrite(&magic, sizeof(magic), 1, file) == 1 &&
+                      std::fwrite(&version, sizeof(version), 1, file) == 1 &&
+                      std::fwrite(&count, sizeof(count), 1, file) == 1;
+            for (const auto& spec : specs) {
+                auto length = static_cast<std::uint8_t>(std::min<std::size_t>(std::strlen(spec.name), 255));
+                ok = ok && std::fwrite(&spec.deadband, sizeof(spec.deadband), 1, file) == 1 &&
+                     std::fwrite(&length, sizeof(length), 1, file) == 1 &&
+                     std::fwrite(spec.name, 1, length, file) == length;
+            }
+            ok = ok && std::fflush(file) == 0;
+
+            start_chunk();
+            return ok;
+        };
+
+        /**
+         * append a sample, writing out the chunk if it's now full
+         *
+         * @param t_us timestamp, in microseconds (e.g. `pros::micros()`); must not go backwards
+         * @param values one value per channel
+         * @return `false` if a full chunk couldn't be written
+         */
+        bool push(std::uint64_t t_us, const std::array<float, Channels>& values) {
+            auto i = header.samples;
+            if (!i) {
+                header.first_us = t_us;
+            }
+            header.last_us = t_us;
+            timestamps.encode(timestamp_column, t_us);
+
+            for (std::size_t c = 0; c < Channels; c++) {
+                index[c].min = std::min(index[c].min, values[c]);
+                index[c].max = std::max(index[c].max, values[c]);
+
+                if (specs[c].deadband > 0.0f) {
+                    if (auto kept = doors[c].push({i, t_us, values[c]})) {
+                        keep(c, *kept);
+                    }
+                } else {
+                    encoders[c].encode(columns[c], values[c]);
+                    index[c].points++;
+                }
+            }
+
+            header.samples++;
+            return header.samples < ChunkSamples || flush();
+        };
+
+        /**
+         * write out the current (possibly partial) chunk
+         *
+         * @return `false` if the log isn't open or the write failed
+         */
+        bool flush() {
+            if (!header.samples) {
+                return file != nullptr;
+            }
+
+            for (std::size_t c = 0; c < Channels; c++) {
+                if (auto kept = doors[c].flush()) {
+                    keep(c, *kept);
+                }
+                index[c].bytes = static_cast<std::uint32_t>(columns[c].size_bytes());
+            }
+            header.timestamp_bytes = static_cast<std::uint32_t>(timestamp_column.size_bytes());
+            header.payload_bytes = header.timestamp_bytes;
+            for (const auto& entry : index) {
+                header.payload_bytes += entry.bytes;
+            }
+
+            bool ok = file &&
+                      std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                      std::fwrite(index.data(), sizeof(channel_index), Channels, file) == Channels &&
+                      std::fwrite(timestamp_column.data(), 1, header.timestamp_bytes, file) == header.timestamp_bytes;
+            for (std::size_t c = 0; c < Channels; c++) {
+                ok = ok && std::fwrite(columns[c].data(), 1, index[c].bytes, file) == index[c].bytes;
+            }
+            ok = ok && std::fflush(file) == 0;
+
+            start_chunk();
+            return ok;
+        };
+
+        /**
+         * flush and close the file
+         */
+        void close() {
+            if (file) {
+                flush();
+                std::fclose(file);
+                file = nullptr;
+            }
+        };
+    };
+
+    /**
+     * reader for columnar logs held in memory (read in, or `mmap`ed)
+     *
+     * the reader never copies the log; chunks are views into the caller's buffer, which has to outlive them.
+     */
+    class column_reader {
+    public:
+        struct channel_info {
+            std::string_view name;
+            float deadband;
+        };
+
+        /**
+         * a view of one chunk
+         */
+        class chunk {
+            friend class column_reader;
+
+            chunk_header header_;
+            const std::uint8_t* index_;
+            const std::uint8_t* payload;
+            const std::vector<channel_info>* channels;
+
+            chunk(const chunk_header& h, const std::uint8_t* i, const std::uint8_t* p, const std::vector<channel_info>* c) :
+                header_(h), index_(i), payload(p), channels(c) {};
+        public:
+            const chunk_header& header() const noexcept { return header_; };
+
+            channel_index index(std::size_t c) const noexcept {
+                channel_index entry;
+                std::memcpy(&entry, index_ + c * sizeof(channel_index), sizeof(entry));
+                return entry;
+            };
+
+            std::size_t samples() const noexcept { return header_.samples; };
+
+            /**
+             * decode the timestamps
+             *
+             * @param out buffer with room for `samples()` timestamps
+             */
+            void timestamps(std::span<std::uint64_t> out) const {
+                bit_reader in{payload, header_.timestamp_bytes};
+                timestamp_encoder::decode(in, header_.first_us, out.first(std::min(out.size(), samples())));
+            };
+
+            /**
+             * decode one channel
+             *
+             * channels with a deadband are reconstructed by linear interpolation between the kept points, which needs
+             * the chunk's timestamps.
+             *
+             * @param c channel index
+             * @param timestamps this chunk's decoded timestamps
+             * @param out buffer with room for `samples()` values
+             */
+            void values(std::size_t c, std::span<const std::uint64_t> timestamps, std::span<float> out) const {
+                auto offset = header_.timestamp_bytes;
+                for (std::size_t i = 0; i < c; i++) {
+                    offset += index(i).bytes;
+                }
+
+                auto entry = index(c);
+                bit_reader in{payload + offset, entry.bytes};
+                float_encoder::decoder decoder;
+                auto n = std::min({out.size(), timestamps.size(), samples()});
+                if (!n) {
+                    return;
+                }
+
+                if ((*channels)[c].deadband <= 0.0f) {
+                    for (std::size_t i = 0; i < n; i++) {
+                        out[i] = decoder.decode(in);
+                    }
+                    return;
+                }
+
+                std::size_t previous_index = 0;
+                float previous_value = 0.0f;
+                for (std::size_t p = 0; p < entry.points; p++) {
+                    std::size_t at = std::min<std::size_t>(previous_index + detail::read_gamma(in) - 1, n - 1);
+                    float value = decoder.decode(in);
+                    if (p == 0) {
+                        std::fill(out.begin(), out.begin() + at + 1, value);
+                    } else {
+                        double span_us = static_cast<double>(timestamps[at] - timestamps[previous_index]);
+                        for (auto i = previous_index + 1; i <= at; i++) {
+                            double f = span_us > 0 ? (timestamps[i] - timestamps[previous_index]) / span_us : 1.0;
+                            out[i] = static_cast<float>(previous_value + f * (value - previous_value));
+                        }
+                    }
+                    previous_index = at;
+                    previous_value = value;
+                }
+                std::fill(out.begin() + previous_index + 1, out.begin() + n, previous_value);
+            };
+        };
+    private:
+        const std::uint8_t* data;
+        std::size_t size;
+        std::size_t first_chunk = 0;
+        std::vector<channel_info> channels;
+    public:
+        /**
+         * parse a log's file header
+         *
+         * @param bytes the whole log
+         * @param length its size
+         */
+        column_reader(const std::uint8_t* bytes, std::size_t length) : data(bytes), size(length) {
+            std::uint32_t magic;
+            std::uint16_t count;
+            if (size < 8 || (std::memcpy(&magic, data, 4), magic != file_magic)) {
+                return;
+            }
+            std::memcpy(&count, data + 6, 2);
+
+            std::size_t offset = 8;
+            for (std::uint16_t c = 0; c < count; c++) {
+                if (offset + 5 > size || offset + 5 + data[offset + 4] > size) {
+                    channels.clear();
+                    return;
+                }
+                float deadband;
+                std::memcpy(&deadband, data + offset, 4);
+                std::size_t length = data[offset + 4];
+                channels.push_back({{reinterpret_cast<const char*>(data + offset + 5), length}, deadband});
+                offset += 5 + length;
+            }
+            first_chunk = offset;
+        };
+
+        /**
+         * @return `false` if this doesn't look like a columnar log
+         */
+        bool valid() const noexcept { return first_chunk != 0; };
+
+        const std::vector<channel_info>& channel_list() const noexcept { return channels; };
+
+        /**
+         * find a channel by name
+         *
+         * @return its index, if there is one by that name
+         */
+        std::optional<std::size_t> find(std::string_view name) const {
+            for (std::size_t c = 0; c < channels.size(); c++) {
+                if (channels[c].name == name) {
+                    return c;
+                }
+            }
+            return std::nullopt;
+        };
+
+        /**
+         * visit every complete chunk in order, skipping any whose index claims more bytes than its payload has
+         *
+         * @param fn called with each `chunk`; return `false` from it to stop early
+         */
+        template <class F>
+        void for_each_chunk(F&& fn) const {
+            if (!valid()) {
+                return;
+            }
+
+            auto index_bytes = channels.size() * sizeof(channel_index);
+            for (std::size_t offset = first_chunk; offset + sizeof(chunk_header) + index_bytes <= size;) {
+                // chunks follow a variable-length file header, so nothing in them is guaranteed to be aligned
+                chunk_header header;
+                std::memcpy(&header, data + offset, sizeof(header));
+                auto* index = data + offset + sizeof(chunk_header);
+                auto* payload = index + index_bytes;
+                if (header.magic != chunk_magic || header.channels != channels.size() ||
+                    header.payload_bytes > size - (payload - data)) {
+                    return;
+                }
+
+                // the columns have to fit in the payload, or decoding them would read past it; a chunk whose index
+                // doesn't add up is skipped, since its header still says where the next one starts
+                chunk c{header, index, payload, &channels};
+                std::uint64_t used = header.timestamp_bytes;
+                for (std::size_t i = 0; i < channels.size(); i++) {
+                    used += c.index(i).bytes;
+                }
+                offset += sizeof(chunk_header) + index_bytes + header.payload_bytes;
+                if (used > header.payload_bytes) {
+                    continue;
+                }
+
+                if (!fn(c)) {
+                    return;
+                }
+            }
+        };
+    };
+}
+
+#endif // HOTEL_LOG_COLUMNAR_HPP
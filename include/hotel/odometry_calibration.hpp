@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <numbers>
+#include <optional>
+#include <type_traits>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/least_squares.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_ODOMETRY_CALIBRATION_HPP
+#define HOTEL_ODOMETRY_CALIBRATION_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * geometry of a tracking-wheel odometry setup: two parallel wheels, one perpendicular wheel and an IMU
+     *
+     * headings are clockwise-positive, as `pros::Imu::get_rotation` reports them. wheel travel is positive forwards for
+     * the parallel wheels, and in whichever direction the perpendicular wheel's encoder counts up for that one.
+     */
+    struct odometry_geometry {
+        static constexpr std::uint32_t magic = 0x31444f48; // "HOD1"
+
+        /// wheel diameters, in inches
+        double left_diameter = 2.75;
+        double right_diameter = 2.75;
+        double side_diameter = 2.75;
+        /// distance of each parallel wheel from the tracking center, in inches (both positive)
+        double left_offset = 5.0;
+        double right_offset = 5.0;
+        /// perpendicular wheel travel per radian of clockwise rotation, in inches (its signed distance from the
+        /// tracking center along the robot)
+        double side_offset = 0.0;
+        /// true rotation per degree the IMU reports
+        double imu_scale = 1.0;
+
+        /**
+         * write to a file, e.g. on the SD card
+         *
+         * @return whether it was written in full
+         */
+        bool save(const char* path) const {
+            auto* f = std::fopen(path, "wb");
+            if (!f) {
+                return false;
+            }
+            auto values = as_array();
+            bool ok = std::fwrite(&magic, sizeof(magic), 1, f) == 1 &&
+                      std::fwrite(values.data(), sizeof(double), values.size(), f) == values.size();
+            return std::fclose(f) == 0 && ok;
+        };
+
+        /**
+         * read back what `save()` wrote
+         *
+         * @return the geometry, or nothing if the file is missing, short or isn't one of ours
+         */
+        static std::optional<odometry_geometry> load(const char* path) {
+            auto* f = std::fopen(path, "rb");
+            if (!f) {
+                return std::nullopt;
+            }
+            std::uint32_t m = 0;
+            std::array<double, 7> values;
+            bool ok = std::fread(&m, sizeof(m), 1, f) == 1 && m == magic &&
+                      std::fread(values.data(), sizeof(double), values.size(), f) == values.size();
+            std::fclose(f);
+            if (!ok) {
+                return std::nullopt;
+            }
+            return from_array(values);
+        };
+
+        std::array<double, 7> as_array() const {
+            return {left_diameter, right_diameter, side_diameter, left_offset, right_offset, side_offset, imu_scale};
+        };
+
+        static odometry_geometry from_array(const std::array<double, 7>& v) {
+            return {v[0], v[1], v[2], v[3], v[4], v[5], v[6]};
+        };
+    };
+
+    /**
+     * one reading of the odometry sensors
+     */
+    struct odometry_sample {
+        /// encoder positions, in degrees
+        double left;
+        double right;
+        double side;
+        /// IMU rotation, in degrees (clockwise-positive, unwrapped)
+        double rotation;
+    };
+
+    /**
+     * on-robot calibration of tracking-wheel geometry and IMU scale
+     *
+     * the robot runs a short script of maneuvers whose true result is known, while the sensors are logged into a fixed
+     * buffer:
+     *
+     * - spins in place through a known angle: start squared against a wall, turn whole revolutions, and square up
+     *   against it again. every sample constrains each parallel wheel's offset and the perpendicular wheel's (against
+     *   the IMU's rotation), and the end result pins the IMU's scale
+     * - straight runs over a known distance (e.g. between two wall-squared positions a measured number of tiles apart).
+     *   the end result pins the parallel wheels' diameters, and every sample checks the wheels' idea of rotation against
+     *   the IMU's
+     *
+     * `solve()` then fits all seven parameters of `odometry_geometry` to the log with `levenberg_marquardt`, with a
+     * prior pulling each one towards its nominal (measured-with-a-ruler) value. the prior is what keeps the
+     * perpendicular wheel's diameter defined, since none of these maneuvers can separate it from its offset. nothing
+     * allocates, and a full buffer solves in well under a second.
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::odometry_calibration<> calibration{[&] {
+     *     return hotel::odometry_sample{left.get_position() / 100.0, right.get_position() / 100.0,
+     *                                   side.get_position() / 100.0, imu.get_rotation()};
+     * }, {.left_offset = 5.25, .right_offset = 5.25, .side_offset = -3.0}};
+     *
+     * // square against the wall, five turns clockwise, square against it again
+     * calibration.spin(1800.0, [&] { return spin_and_square(1800.0); });
+     * calibration.straight(48.0, [&] { return drive_between_walls(); });
+     * ...
+     * auto fit = hotel::calibrate_odometry(calibration, "/usd/odometry.bin");
+     * calibration.report(stdout, fit);
+     *
+     * // and from then on, at startup
+     * auto geometry = hotel::odometry_geometry::load("/usd/odometry.bin").value_or(measured);
+     * ```
+     *
+     * @tparam MaxSamples size of the sample buffer, across all maneuvers
+     * @tparam MaxManeuvers number of maneuvers the script can have
+     * @tparam Clock clock the sampling is paced by
+     */
+    template <std::size_t MaxSamples = 2048, std::size_t MaxManeuvers = 16, concepts::MicrosClock Clock = micros_clock>
+    class odometry_calibration {
+    public:
+        enum class kind : std::uint8_t { spin, straight };
+
+        struct maneuver {
+            kind type;
+            /// the true rotation (degrees, clockwise) or distance (inches) covered
+            double truth;
+            /// samples in the buffer (the first is the starting point)
+            std::size_t first;
+            std::size_t count;
+        };
+
+        struct options {
+            /// uncertainty of a single sample's wheel travel, in inches
+            double sample_sigma = 0.05;
+            /// uncertainty of a spin's true rotation, in degrees
+            double angle_sigma = 0.5;
+            /// uncertainty of a straight run's true distance, in inches
+            double distance_sigma = 0.125;
+            /// how far each parameter can plausibly be from its nominal value, in the same order as
+            /// `odometry_geometry::as_array()`
+            std::array<double, 7> prior_sigma = {0.1, 0.1, 0.1, 0.5, 0.5, 0.5, 0.02};
+            /// time between samples during a maneuver, in microseconds
+            std::uint32_t sample_period_us = 10000;
+        };
+
+        struct fit {
+            odometry_geometry geometry;
+            /// RMS residual at the solution, in units of `sample_sigma` and converted back to inches
+            double rms_error;
+            least_squares_result<7> solver;
+            /// time the solve took, in microseconds
+            std::uint64_t solve_us;
+        };
+    private:
+        std::function<odometry_sample()> read;
+        odometry_geometry nominal;
+        options opts;
+        std::array<odometry_sample, MaxSamples> samples;
+        std::array<maneuver, MaxManeuvers> maneuvers;
+        std::size_t sample_count = 0;
+        std::size_t maneuver_count = 0;
+
+        /**
+         * the residuals, with the parameters in `odometry_geometry::as_array()` order
+         */
+        template <class T, class Emit>
+        void residuals(const std::array<T, 7>& p, Emit&& emit) const {
+            constexpr double degrees = std::numbers::pi / 180.0;
+            constexpr double travel = std::numbers::pi / 360.0;
+            const auto& [dl, dr, ds, lo, ro, so, k] = p;
+            // wheel travel per encoder degree, and back
+            auto left_scale = dl * travel;
+            auto right_scale = dr * travel;
+            auto left_inverse = 1.0 / left_scale;
+            auto right_inverse = 1.0 / right_scale;
+            auto side_inverse = 1.0 / (ds * travel);
+
+            // where a wheel's rotation is predicted from the geometry, the residual is taken in encoder degrees (and
+            // scaled back to nominal inches). taken in fitted inches, shrinking a diameter would also shrink the
+            // encoder's noise, and the fit would be biased towards small wheels
+            const double weight = 1.0 / opts.sample_sigma;
+            const double left_weight = nominal.left_diameter * travel * weight;
+            const double right_weight = nominal.right_diameter * travel * weight;
+            const double side_weight = nominal.side_diameter * travel * weight;
+
+            for (std::size_t m = 0; m < maneuver_count; m++) {
+                const auto& man = maneuvers[m];
+                const auto& start = samples[man.first];
+                T left{}, right{}, theta{};
+                for (std::size_t i = 1; i < man.count; i++) {
+                    const auto& s = samples[man.first + i];
+                    theta = k * ((s.rotation - start.rotation) * degrees);
+
+                    if (man.type == kind::spin) {
+                        // the tracking center stays put, so each wheel only sees the rotation
+                        emit(((s.left - start.left) - lo * theta * left_inverse) * left_weight);
+                        emit(((s.right - start.right) + ro * theta * right_inverse) * right_weight);
+                    } else {
+                        // the difference between the parallel wheels is the rotation
+                        left = left_scale * (s.left - start.left);
+                        right = right_scale * (s.right - start.right);
+                        emit((left - right - (lo + ro) * theta) * weight);
+                    }
+                    // there's no sideways motion in either, so the perpendicular wheel only sees the rotation
+                    emit(((s.side - start.side) - so * theta * side_inverse) * side_weight);
+                }
+
+                if (man.count < 2) {
+                    continue;
+                }
+                if (man.type == kind::spin) {
+                    emit((theta * (1.0 / degrees) - man.truth) * (1.0 / opts.angle_sigma));
+                } else {
+                    auto forward = (ro * left + lo * right) / (lo + ro);
+                    emit((forward - man.truth) * (1.0 / opts.distance_sigma));
+                }
+            }
+
+            auto prior = nominal.as_array();
+            for (std::size_t i = 0; i < 7; i++) {
+                emit((p[i] - prior[i]) * (1.0 / opts.prior_sigma[i]));
+            }
+        };
+
+        template <class F>
+        bool record(kind type, double truth, F&& drive) {
+            static_assert(std::is_invocable_r_v<bool, F>);
+            if (!begin(type, truth)) {
+                return false;
+            }
+            auto next = Clock::now();
+            while (!drive()) {
+                next += opts.sample_period_us;
+                Clock::wait_until(next);
+                sample(read());
+            }
+            sample(read());
+            return true;
+        };
+    public:
+        /**
+         * @param r reads the sensors
+         * @param n nominal geometry, as measured
+         * @param o weights and sampling
+         */
+        template <class F>
+            requires std::is_invocable_r_v<odometry_sample, F>
+        odometry_calibration(F&& r, odometry_geometry n = {}, options o = {}) :
+            read(std::forward<F>(r)),
+            nominal(n),
+            opts(o) {};
+
+        /**
+         * run a spin in place, logging as it goes
+         *
+         * @param degrees the true rotation the spin covers (clockwise-positive)
+         * @param drive called once per sample period to drive the maneuver; returns `true` once it's over and the robot
+         *              has stopped
+         * @return `false` if the script is already full
+         */
+        template <class F>
+        bool spin(double degrees, F&& drive) { return record(kind::spin, degrees, std::forward<F>(drive)); };
+
+        /**
+         * run a straight line, logging as it goes
+         *
+         * @param inches the true distance the run covers (negative for backwards)
+         * @param drive as for `spin()`
+         * @return `false` if the script is already full
+         */
+        template <class F>
+        bool straight(double inches, F&& drive) { return record(kind::straight, inches, std::forward<F>(drive)); };
+
+        /**
+         * start logging a maneuver by hand, for a script that drives the robot itself; takes the first sample
+         *
+         * @return `false` if the script or the buffer is already full
+         */
+        bool begin(kind type, double truth) {
+            if (maneuver_count >= MaxManeuvers || sample_count >= MaxSamples) {
+                return false;
+            }
+            maneuvers[maneuver_count++] = {type, truth, sample_count, 0};
+            sample(read());
+            return true;
+        };
+
+        /**
+         * log a sample for the current maneuver
+         *
+         * once the buffer is full, each sample replaces the last one, so a maneuver's end point is always kept.
+         */
+        void sample(const odometry_sample& s) {
+            if (!maneuver_count) {
+                return;
+            }
+            auto& m = maneuvers[maneuver_count - 1];
+            if (sample_count < MaxSamples) {
+                samples[sample_count++] = s;
+                m.count++;
+            } else if (m.count > 1) {
+                samples[sample_count - 1] = s;
+            }
+        };
+
+        /// drop everything logged so far
+        void clear() {
+            sample_count = 0;
+            maneuver_count = 0;
+        };
+
+        std::size_t size() const noexcept { return sample_count; };
+
+        /**
+         * fit the geometry to everything logged so far
+         *
+         * @param o solver limits
+         */
+        fit solve(least_squares_options o = {}) const {
+            auto start = Clock::now();
+            auto result = levenberg_marquardt<7>([this] (const auto& p, auto&& emit) {
+                residuals(p, emit);
+            }, nominal.as_array(), o);
+            auto elapsed = Clock::now() - start;
+
+            auto rms = result.residuals ? std::sqrt(result.cost / result.residuals) * opts.sample_sigma : 0.0;
+            return {odometry_geometry::from_array(result.x), rms, result, elapsed};
+        };
+
+        /**
+         * write a fit as an `odometry_geometry` telemetry record
+         *
+         * fields are: the seven parameters (as in `odometry_geometry`), RMS error, iterations, whether it converged,
+         * samples used and solve time (in microseconds).
+         *
+         * @param out stream to write to
+         * @param f result of `solve()`
+         */
+        void report(std::FILE* out, const fit& f) const {
+            const auto& g = f.geometry;
+            telemetry::write(out, "odometry_geometry", g.left_diameter, g.right_diameter, g.side_diameter,
+                             g.left_offset, g.right_offset, g.side_offset, g.imu_scale, f.rms_error,
+                             f.solver.iterations, f.solver.converged, sample_count, f.solve_us);
+        };
+    };
+
+    /**
+     * solve a logged calibration script, and save the geometry if the solver converged
+     *
+     * @param calibration the logged script
+     * @param path where to save the geometry (see `odometry_geometry::load`)
+     * @param o solver limits
+     * @return the fit, whether or not it was saved
+     */
+    template <std::size_t MaxSamples, std::size_t MaxManeuvers, class Clock>
+    auto calibrate_odometry(const odometry_calibration<MaxSamples, MaxManeuvers, Clock>& calibration,
+                            const char* path, least_squares_options o = {}) {
+        auto f = calibration.solve(o);
+        if (f.solver.converged) {
+            f.geometry.save(path);
+        }
+        return f;
+    };
+}
+
+#endif // HOTEL_ODOMETRY_CALIBRATION_HPP
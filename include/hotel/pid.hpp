@@ -10,11 +10,45 @@
 
 #include "hotel/concepts.hpp"
 #include "hotel/coro/generator.hpp"
+#include "hotel/export.hpp"
 
 #ifndef HOTEL_PID_HPP
 #define HOTEL_PID_HPP
 
-namespace hotel {
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * the control law `pid_controller` runs, on its own
+     *
+     * this is the arithmetic of one iteration, with the controller's state passed in, so it can be evaluated anywhere
+     * the controller can't run: in constant expressions, or against a simulated plant.
+     *
+     * @tparam Kp_t `std::ratio` representing the proportional gain
+     * @tparam Ki_t `std::ratio` representing the integral gain
+     * @tparam Kd_t `std::ratio` representing the derivative gain
+     */
+    template <concepts::Ratio Kp_t, concepts::Ratio Ki_t, concepts::Ratio Kd_t>
+    struct pid_law {
+        static constexpr float Kp = Kp_t::num / static_cast<float>(Kp_t::den);
+        static constexpr float Ki = Ki_t::num / static_cast<float>(Ki_t::den);
+        static constexpr float Kd = Kd_t::num / static_cast<float>(Kd_t::den);
+
+        /**
+         * @param error this iteration's error
+         * @param accumulated sum of every error so far, including this one
+         * @param last_error the previous iteration's error
+         * @param dT time since the previous iteration, in milliseconds
+         * @return the output according to @f$K_p * e(T) + K_i * \int_0^T e(T)dT + K_d * \frac{dE}{dT}@f$, without the
+         *         derivative term if no time has passed
+         */
+        template <class T>
+        static constexpr auto output(T error, T accumulated, T last_error, T dT) {
+            if (dT <= T{0}) {
+                return Kp * error + Ki * accumulated * dT + Kd * T{0};
+            }
+            return Kp * error + Ki * accumulated * dT + Kd * ((last_error - error) / (dT));
+        };
+    };
 
     /**
      * PID controller object
@@ -41,13 +75,32 @@ namespace hotel {
         _target_t error_accumulator;
         _target_t last_error;
         std::chrono::time_point<pros::Clock> last_iteration;
+        /// the last nonzero iteration period
+        std::chrono::milliseconds last_period{10};
 
-        static constexpr float Kp = Kp_t::num / static_cast<float>(Kp_t::den);
-        static constexpr float Ki = Ki_t::num / static_cast<float>(Ki_t::den);
-        static constexpr float Kd = Kd_t::num / static_cast<float>(Kd_t::den);
+        using law = pid_law<Kp_t, Ki_t, Kd_t>;
 
         FeedbackFn feedback_fn;
         SettledFn is_settled;
+
+        _output_t iterate(_target_t error) {
+            error_accumulator += error;
+
+            auto now = pros::Clock::now();
+            auto period = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_iteration);
+            // two iterations inside one clock tick carry on at the last period, rather than a dT of 0
+            if (period.count() > 0) {
+                last_period = period;
+            }
+
+            auto value = static_cast<_output_t>(
+                law::output(error, error_accumulator, last_error, static_cast<_target_t>(last_period.count())));
+
+            last_iteration = now;
+            last_error = error;
+
+            return value;
+        };
     public:
         using target_t = _target_t;
         using output_t = _output_t;
@@ -109,20 +162,20 @@ namespace hotel {
                     break;
                 }
 
-                error_accumulator += error;
-
-                auto now = pros::Clock::now();
-                auto dT = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_iteration).count();
-
-                auto value = static_cast<output_t>(Kp * error + Ki * error_accumulator * dT + Kd * ((last_error - error) / (dT)));
-
-                last_iteration = now;
-                last_error = error;
-
-                co_yield value;
+                co_yield iterate(error);
             }
         };
 
+        /**
+         * run one iteration, whether or not the controller has settled
+         *
+         * this is what `run()` does between settled checks, for holding the controller in something that steps it
+         * directly (e.g. `hotel::controller_registry`) instead of iterating its generator.
+         *
+         * @return the output according to @f$K_p * e(T) + K_i * \int_0^T e(T)dT + K_d * \frac{dE}{dT}@f$
+         */
+        output_t step() { return iterate(error()); };
+
         /**
          * set a new target for this controller
          *
@@ -146,6 +199,54 @@ namespace hotel {
 
             return *this;
         };
+
+        /**
+         * move the setpoint without resetting anything, e.g. to follow a motion profile one sample per iteration
+         *
+         * unlike `target()`, the accumulated error and the derivative and timing state are kept, so the output carries
+         * on smoothly as the setpoint moves.
+         *
+         * @param setpoint the new setpoint
+         * @return this instance
+         */
+        pid_controller& follow(target_t setpoint) {
+            current_setpoint = setpoint;
+
+            return *this;
+        };
+
+        /**
+         * read the current error without stepping the controller
+         *
+         * @return the setpoint minus the current feedback value
+         */
+        target_t error() { return current_setpoint - feedback_fn(); };
+
+        /**
+         * evaluate this controller's settled function
+         *
+         * @param error an error value (e.g. from `error()`)
+         * @return whether the controller would consider itself settled at that error
+         */
+        bool settled(target_t error) { return is_settled(error); };
+
+        /**
+         * prepare to `run()` again after a pause, without a bump in the output
+         *
+         * unlike `target()`, the accumulated error is kept (it's usually what's holding the mechanism up), and the
+         * derivative and timing state are brought up to date so the first iteration doesn't see a kick from the error
+         * having moved, or a huge @f$dT@f$ from the time spent paused. the last iteration is placed one period (as last
+         * measured) before now, so the first iteration runs with the same @f$dT@f$ as the ones before the pause, rather
+         * than none at all.
+         *
+         * @return this instance
+         */
+        pid_controller& resume() {
+            last_error = error();
+            last_iteration = pros::Clock::now() - last_period;
+
+            return *this;
+        };
     };
 
     /**
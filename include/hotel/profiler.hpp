@@ -0,0 +1,226 @@
+#include <array>
+#include <atomic>
+#include <cstring>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "pros/rtos.h"
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/histogram.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_PROFILER_HPP
+#define HOTEL_PROFILER_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * per-section execution time and period accounting
+     *
+     * a section is any periodic piece of work (usually the body of a task's loop). each measurement records how long
+     * the body took, how long it's been since it last started, and a running total of busy time, which is enough to
+     * tell how much of the CPU each loop is using and how regularly it actually runs.
+     *
+     * sections are registered by name into a fixed table. registration is safe from any task, including two
+     * registering the same name at once (both get the same section), but each section should only be measured from
+     * one.
+     *
+     * example:
+     * ```{.cpp}
+     * auto& odometry = hotel::default_profiler().section("odometry");
+     * odometry.bind(pros::c::task_get_current());
+     *
+     * while (true) {
+     *     {
+     *         auto scope = odometry.measure();
+     *         update_odometry();
+     *     }
+     *     pros::delay(10);
+     * }
+     *
+     * // elsewhere
+     * hotel::default_profiler().report(stdout);
+     * ```
+     *
+     * @tparam MaxSections number of sections that can be registered
+     * @tparam Clock clock used for measurements
+     */
+    template <std::size_t MaxSections = 16, concepts::MicrosClock Clock = micros_clock>
+    class basic_profiler {
+    public:
+        /// execution times, 0-5ms in 100us buckets
+        using exec_histogram = histogram<50, 100>;
+        /// start-to-start periods, 0-100ms in 1ms buckets
+        using period_histogram = histogram<100, 1000>;
+
+        class section_t;
+
+        /**
+         * RAII measurement of one run of a section
+         */
+        class scope {
+            section_t* owner;
+            std::uint64_t start;
+        public:
+            explicit scope(section_t& s) : owner(&s), start(Clock::now()) {};
+
+            scope(const scope&) = delete;
+
+            scope& operator=(const scope&) = delete;
+
+            ~scope() { owner->record(start, Clock::now()); };
+        };
+
+        class section_t {
+            // claimed by swapping it in from null; the name is never changed after that
+            std::atomic<const char*> name_{nullptr};
+            pros::task_t task_ = nullptr;
+            exec_histogram exec_;
+            period_histogram period_;
+            std::uint64_t busy_ = 0;
+            std::uint64_t first_start = 0;
+            std::uint64_t last_start = 0;
+            std::uint64_t last_end = 0;
+
+            friend class basic_profiler;
+
+            explicit section_t(const char* name) : name_(name) {};
+        public:
+            section_t() = default;
+
+            /**
+             * record one run
+             *
+             * @param start when the run started
+             * @param end when it finished
+             */
+            void record(std::uint64_t start, std::uint64_t end) {
+                if (exec_.count()) {
+                    period_.add(static_cast<std::uint32_t>(start - last_start));
+                } else {
+                    first_start = start;
+                }
+                exec_.add(static_cast<std::uint32_t>(end - start));
+                busy_ += end - start;
+                last_start = start;
+                last_end = end;
+            };
+
+            /**
+             * @return a scope that measures until it's destroyed
+             */
+            [[nodiscard]] scope measure() { return scope{*this}; };
+
+            /**
+             * associate the section with the task that runs it, for tools that act on tasks (e.g. priority assignment)
+             *
+             * @param task the task handle
+             */
+            void bind(pros::task_t task) { task_ = task; };
+
+            const char* name() const noexcept { return name_.load(std::memory_order_acquire); };
+
+            pros::task_t task() const noexcept { return task_; };
+
+            const exec_histogram& exec() const noexcept { return exec_; };
+
+            const period_histogram& period() const noexcept { return period_; };
+
+            /// total time spent inside the section, in microseconds
+            std::uint64_t busy() const noexcept { return busy_; };
+
+            /// time from the first measured start to the last measured end, in microseconds
+            std::uint64_t elapsed() const noexcept { return last_end - first_start; };
+
+            /// fraction of the elapsed time spent inside the section
+            float utilization() const noexcept { return elapsed() ? static_cast<float>(busy_) / elapsed() : 0.0f; };
+
+            void clear() {
+                exec_.clear();
+                period_.clear();
+                busy_ = first_start = last_start = last_end = 0;
+            };
+        };
+    private:
+        // claimed in order, so the registered sections are always a prefix of the table
+        std::array<section_t, MaxSections> sections;
+        section_t overflow{"overflow"};
+    public:
+        /**
+         * find or register a section
+         *
+         * slots are claimed in order with a compare-and-swap of the name, so a task that loses the race for a slot
+         * sees the winner's name in it: if that's the name it was registering it uses that section, and otherwise it
+         * moves on to the next slot.
+         *
+         * if the table is full, a shared overflow section (named `overflow`) is returned, so measuring never fails
+         *
+         * @param name section name; must outlive the profiler (a string literal, usually)
+         * @return the section
+         */
+        section_t& section(const char* name) {
+            for (auto& s : sections) {
+                const char* claimed = nullptr;
+                if (s.name_.compare_exchange_strong(claimed, name, std::memory_order_acq_rel,
+                                                    std::memory_order_acquire)) {
+                    return s;
+                }
+                if (std::strcmp(claimed, name) == 0) {
+                    return s;
+                }
+            }
+            return overflow;
+        };
+
+        /**
+         * visit every registered section
+         *
+         * @param fn called with each `section_t&`
+         */
+        template <class F>
+        void for_each(F&& fn) {
+            for (auto& s : sections) {
+                if (!s.name()) {
+                    break;
+                }
+                fn(s);
+            }
+        };
+
+        /**
+         * write every section as `profile` telemetry records
+         *
+         * fields are: name, runs, utilization, mean exec, p99 exec, max exec, mean period, max period (times in
+         * microseconds)
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) {
+            for_each([out] (const section_t& s) {
+                telemetry::write(out, "profile", s.name(), s.exec().count(), s.utilization(),
+                                 s.exec().mean(), s.exec().percentile(0.99f), s.exec().max(),
+                                 s.period().mean(), s.period().max());
+            });
+        };
+    };
+
+    /**
+     * the profiler used by default throughout libhotel
+     */
+    using profiler = basic_profiler<>;
+
+    /**
+     * @return the shared profiler instance
+     */
+    inline profiler& default_profiler() {
+        static profiler instance;
+        return instance;
+    };
+}
+
+#endif // HOTEL_PROFILER_HPP
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cmath>
+#include <span>
+
+#include <cstddef>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_QUATERNION_HPP
+#define HOTEL_QUATERNION_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    namespace detail {
+        /// four floats as one GCC vector: an SSE register on the host, scalar VFP on the brain (see `quaternion`)
+        typedef float float4 __attribute__((vector_size(16)));
+        typedef int int4 __attribute__((vector_size(16)));
+    }
+
+    struct vector3 {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+
+        friend vector3 operator+(const vector3& a, const vector3& b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; };
+
+        friend vector3 operator-(const vector3& a, const vector3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; };
+
+        friend vector3 operator*(const vector3& a, float s) { return {a.x * s, a.y * s, a.z * s}; };
+
+        float dot(const vector3& o) const { return x * o.x + y * o.y + z * o.z; };
+
+        vector3 cross(const vector3& o) const { return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x}; };
+
+        float norm() const { return std::sqrt(dot(*this)); };
+    };
+
+    /**
+     * angles extracted from an orientation, in radians (aerospace order: yaw, then pitch, then roll)
+     */
+    struct euler_angles {
+        float roll;
+        float pitch;
+        float yaw;
+    };
+
+    /**
+     * unit quaternion for 3D orientation
+     *
+     * the four components live in one GCC vector, so a product is four lane-wise multiply-adds against shuffled copies
+     * of the other operand, and normalizing is one multiply by a broadcast reciprocal square root. on the host that's
+     * SSE. on the brain it isn't NEON: without `-ffast-math` GCC won't put ARMv7 float vector arithmetic on NEON (which
+     * flushes denormals, so isn't IEEE-compliant), and splits it into scalar VFP instructions, which is what the
+     * batch functions below run as too. the vector form is kept because it's compact, and the arithmetic is the same.
+     *
+     * example:
+     * ```{.cpp}
+     * auto q = hotel::quaternion::from_rotation_vector({0.0f, 0.0f, rate_z * dt});
+     * orientation = (orientation * q).normalized();
+     * float yaw = orientation.to_euler().yaw;
+     * ```
+     */
+    struct quaternion {
+        /// w, x, y, z
+        detail::float4 v = {1.0f, 0.0f, 0.0f, 0.0f};
+
+        quaternion() = default;
+
+        quaternion(float w, float x, float y, float z) : v{w, x, y, z} {};
+
+        explicit quaternion(detail::float4 components) : v(components) {};
+
+        float w() const { return v[0]; };
+
+        float x() const { return v[1]; };
+
+        float y() const { return v[2]; };
+
+        float z() const { return v[3]; };
+
+        /**
+         * rotation by `|r|` radians about `r` (the exponential map), as integrated from an angular rate over a step
+         */
+        static quaternion from_rotation_vector(const vector3& r) {
+            float angle = r.norm();
+            float half = 0.5f * angle;
+            // sin(half) / angle, with the series near 0 so small steps stay accurate
+            float s = angle > 1e-4f ? std::sin(half) / angle : 0.5f - angle * angle / 48.0f;
+            return {std::cos(half), r.x * s, r.y * s, r.z * s};
+        };
+
+        /**
+         * shortest rotation taking unit vector `from` to unit vector `to`
+         */
+        static quaternion between(const vector3& from, const vector3& to) {
+            auto c = from.cross(to);
+            return quaternion{1.0f + from.dot(to), c.x, c.y, c.z}.normalized();
+        };
+
+        quaternion conjugate() const { return quaternion{v * detail::float4{1.0f, -1.0f, -1.0f, -1.0f}}; };
+
+        float dot(const quaternion& o) const {
+            auto p = v * o.v;
+            return (p[0] + p[1]) + (p[2] + p[3]);
+        };
+
+        quaternion normalized() const {
+            float n = dot(*this);
+            return quaternion{v * (n > 0.0f ? 1.0f / std::sqrt(n) : 0.0f)};
+        };
+
+        /// Hamilton product: the rotation `o` followed by this one, in this one's frame
+        friend quaternion operator*(const quaternion& a, const quaternion& b) {
+            using detail::float4;
+            using detail::int4;
+            auto r = a.v[0] * b.v;
+            r += a.v[1] * __builtin_shuffle(b.v, int4{1, 0, 3, 2}) * float4{-1.0f, 1.0f, -1.0f, 1.0f};
+            r += a.v[2] * __builtin_shuffle(b.v, int4{2, 3, 0, 1}) * float4{-1.0f, 1.0f, 1.0f, -1.0f};
+            r += a.v[3] * __builtin_shuffle(b.v, int4{3, 2, 1, 0}) * float4{-1.0f, -1.0f, 1.0f, 1.0f};
+            return quaternion{r};
+        };
+
+        /**
+         * rotate a vector from this quaternion's frame into the reference frame
+         */
+        vector3 rotate(const vector3& p) const {
+            auto r = *this * quaternion{0.0f, p.x, p.y, p.z} * conjugate();
+            return {r.x(), r.y(), r.z()};
+        };
+
+        euler_angles to_euler() const {
+            float w = v[0], x = v[1], y = v[2], z = v[3];
+            return {
+                std::atan2(2.0f * (w * x + y * z), 1.0f - 2.0f * (x * x + y * y)),
+                std::asin(std::clamp(2.0f * (w * y - z * x), -1.0f, 1.0f)),
+                std::atan2(2.0f * (w * z + x * y), 1.0f - 2.0f * (y * y + z * z))
+            };
+        };
+    };
+
+    /**
+     * spherical linear interpolation between two unit quaternions, along the shorter arc
+     *
+     * @param t 0 for `a`, 1 for `b`
+     */
+    inline quaternion slerp(const quaternion& a, quaternion b, float t) {
+        float d = a.dot(b);
+        if (d < 0.0f) {
+            b.v = -b.v;
+            d = -d;
+        }
+        if (d > 0.9995f) {
+            // nearly parallel: a normalized lerp is as good and doesn't divide by ~0
+            return quaternion{a.v + (b.v - a.v) * t}.normalized();
+        }
+        float theta = std::acos(d);
+        float s = 1.0f / std::sin(theta);
+        return quaternion{a.v * (std::sin((1.0f - t) * theta) * s) + b.v * (std::sin(t * theta) * s)};
+    };
+
+    /**
+     * normalize a batch of quaternions in place
+     */
+    inline void normalize(std::span<quaternion> qs) {
+        for (auto& q : qs) {
+            q = q.normalized();
+        }
+    };
+
+    /**
+     * multiply two batches of quaternions pairwise
+     *
+     * @param out `a[i] * b[i]`; may alias either input
+     */
+    inline void multiply(std::span<const quaternion> a, std::span<const quaternion> b, std::span<quaternion> out) {
+        auto n = std::min({a.size(), b.size(), out.size()});
+        for (std::size_t i = 0; i < n; i++) {
+            out[i] = a[i] * b[i];
+        }
+    };
+}
+
+#endif // HOTEL_QUATERNION_HPP
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "pros/rtos.hpp"
+
+#include "hotel/export.hpp"
+#include "hotel/profiler.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_SCHEDULABILITY_HPP
+#define HOTEL_SCHEDULABILITY_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * rate-monotonic priority assignment and response-time analysis for a set of periodic tasks
+     *
+     * tasks are described by their period, worst-case execution time and deadline, either by hand or straight from
+     * profiler sections. `assign_rate_monotonic()` gives shorter periods higher PROS priorities, and `analyze()` runs
+     * the standard fixed-priority response-time recurrence
+     *
+     * @f[R_i = C_i + B_i + \sum_{j \in hp(i)} \left\lceil \frac{R_i}{T_j} \right\rceil C_j@f]
+     *
+     * to get each task's worst-case response time and flag any that can miss their deadline. tasks sharing a priority
+     * level (there are only so many) are counted as interfering with each other, which is what FreeRTOS's round-robin
+     * can do to them in the worst case.
+     *
+     * example:
+     * ```{.cpp}
+     * // after running the robot for a while with every loop measured by the default profiler...
+     * hotel::task_set<> tasks;
+     * tasks.add_from(hotel::default_profiler());
+     * tasks.assign_rate_monotonic();
+     * if (!tasks.analyze()) {
+     *     pros::lcd::set_text(0, "task set is not schedulable!");
+     * }
+     * tasks.report(stdout);
+     * tasks.apply();
+     * ```
+     *
+     * @tparam MaxTasks number of tasks that can be analyzed
+     */
+    template <std::size_t MaxTasks = 16>
+    class task_set {
+    public:
+        struct task {
+            const char* name = nullptr;
+            /// release period, in microseconds
+            std::uint32_t period_us = 0;
+            /// worst-case execution time, in microseconds
+            std::uint32_t wcet_us = 0;
+            /// relative deadline, in microseconds; 0 means the period, and it can't be longer than that
+            std::uint32_t deadline_us = 0;
+            /// worst-case blocking from lower-priority tasks (e.g. a shared mutex), in microseconds
+            std::uint32_t blocking_us = 0;
+            /// task to apply the assigned priority to, if any
+            pros::task_t handle = nullptr;
+
+            /// assigned PROS priority
+            std::uint32_t priority = TASK_PRIORITY_DEFAULT;
+            /// worst-case response time from the last `analyze()`, in microseconds (0 if it diverged)
+            std::uint32_t response_us = 0;
+            bool schedulable = false;
+
+            std::uint32_t deadline() const noexcept { return deadline_us ? deadline_us : period_us; };
+        };
+    private:
+        std::array<task, MaxTasks> tasks{};
+        std::size_t count = 0;
+    public:
+        /**
+         * add a task
+         *
+         * the recurrence in `analyze()` only considers a task's first job, which is only its worst one when every job
+         * finishes before the next is released; with a deadline past the period a job can still be running when the
+         * next one arrives, and the whole busy period would have to be analyzed instead. those tasks are refused.
+         *
+         * @return `false` if the set is full, the task has no period, or its deadline is longer than its period
+         */
+        bool add(const task& t) {
+            if (count == MaxTasks || !t.period_us || t.deadline() > t.period_us) {
+                return false;
+            }
+            tasks[count++] = t;
+            return true;
+        };
+
+        /**
+         * add every section of a profiler that has run at least twice
+         *
+         * the period is the mean measured period, and the execution time is taken at the given percentile of the
+         * execution-time histogram (the default, 1, is the maximum ever seen). sections bound to a task carry the
+         * handle over so `apply()` can act on them.
+         *
+         * @param p the profiler
+         * @param percentile execution-time percentile to use as the WCET
+         */
+        template <std::size_t MaxSections, class Clock>
+        void add_from(basic_profiler<MaxSections, Clock>& p, float percentile = 1.0f) {
+            p.for_each([&] (const auto& section) {
+                if (section.period().count() < 1) {
+                    return;
+                }
+                add({
+                    .name = section.name(),
+                    .period_us = static_cast<std::uint32_t>(section.period().mean()),
+                    .wcet_us = percentile >= 1.0f ? section.exec().max() : section.exec().percentile(percentile),
+                    .handle = section.task()
+                });
+            });
+        };
+
+        /**
+         * assign priorities rate-monotonically: the shorter the period, the higher the priority
+         *
+         * each distinct period gets its own level, counting down from `highest`; if the periods outnumber the levels,
+         * the longest ones share `lowest`.
+         *
+         * @param highest priority for the shortest period
+         * @param lowest lowest priority to hand out
+         */
+        void assign_rate_monotonic(std::uint32_t highest = TASK_PRIORITY_DEFAULT + 4,
+                                   std::uint32_t lowest = TASK_PRIORITY_MIN + 1) {
+            std::sort(tasks.begin(), tasks.begin() + count, [] (const task& a, const task& b) {
+                return a.period_us < b.period_us;
+            });
+
+            auto level = highest;
+            for (std::size_t i = 0; i < count; i++) {
+                if (i && tasks[i].period_us != tasks[i - 1].period_us && level > lowest) {
+                    level--;
+                }
+                tasks[i].priority = level;
+            }
+        };
+
+        /**
+         * run response-time analysis with the current priorities
+         *
+         * @return whether every task meets its deadline
+         */
+        bool analyze() {
+            bool all = true;
+            for (std::size_t i = 0; i < count; i++) {
+                auto& t = tasks[i];
+                std::uint64_t response = t.wcet_us + t.blocking_us;
+                std::uint64_t previous = 0;
+
+                while (response != previous && response <= t.deadline()) {
+                    previous = response;
+                    response = t.wcet_us + t.blocking_us;
+                    for (std::size_t j = 0; j < count; j++) {
+                        if (j != i && tasks[j].priority >= t.priority) {
+                            response += (previous + tasks[j].period_us - 1) / tasks[j].period_us * tasks[j].wcet_us;
+                        }
+                    }
+                }
+
+                t.schedulable = response <= t.deadline();
+                t.response_us = t.schedulable ? static_cast<std::uint32_t>(response) : 0;
+                all = all && t.schedulable;
+            }
+            return all;
+        };
+
+        /**
+         * @return total processor utilization, @f$\sum C_i / T_i@f$
+         */
+        float utilization() const noexcept {
+            float u = 0.0f;
+            for (std::size_t i = 0; i < count; i++) {
+                u += static_cast<float>(tasks[i].wcet_us) / tasks[i].period_us;
+            }
+            return u;
+        };
+
+        /**
+         * @return the Liu & Layland utilization bound for this many tasks, below which RM is always schedulable
+         */
+        float utilization_bound() const noexcept {
+            return count ? count * (std::pow(2.0f, 1.0f / count) - 1.0f) : 1.0f;
+        };
+
+        /**
+         * set every task that has a handle to its assigned priority
+         */
+        void apply() const {
+            for (std::size_t i = 0; i < count; i++) {
+                if (tasks[i].handle) {
+                    pros::Task{tasks[i].handle}.set_priority(tasks[i].priority);
+                }
+            }
+        };
+
+        /**
+         * write the analysis as `rta` telemetry records, plus one `rta_total` record
+         *
+         * fields are: name, period, wcet, deadline, priority, response, schedulable (times in microseconds); then
+         * utilization, bound, all schedulable
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            bool all = true;
+            for (std::size_t i = 0; i < count; i++) {
+                const auto& t = tasks[i];
+                telemetry::write(out, "rta", t.name ? t.name : "?", t.period_us, t.wcet_us, t.deadline(), t.priority,
+                                 t.response_us, t.schedulable);
+                all = all && t.schedulable;
+            }
+            telemetry::write(out, "rta_total", utilization(), utilization_bound(), all);
+        };
+
+        std::size_t size() const noexcept { return count; };
+
+        const task& operator[](std::size_t i) const noexcept { return tasks[i]; };
+
+        task& operator[](std::size_t i) noexcept { return tasks[i]; };
+    };
+}
+
+#endif // HOTEL_SCHEDULABILITY_HPP
@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <optional>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/concepts.hpp"
+#include "hotel/coro/generator.hpp"
+#include "hotel/export.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_SELF_TUNING_HPP
+#define HOTEL_SELF_TUNING_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * PI controller that identifies its plant while it runs, and re-places its poles as the plant changes
+     *
+     * the plant is modeled as first order with a bias, @f$y_{k+1} = a y_k + b u_{k-d} + c@f$, per tick: a motor's
+     * velocity against its command, with @f$c@f$ soaking up gravity or friction so they don't bias the rest. every
+     * tick, recursive least squares with a forgetting factor updates @f$(a, b, c)@f$ from the last measurement (a
+     * fixed 3x3 update, about 40 multiply-adds); every `retune_ticks` ticks the PI gains are recomputed for the
+     * current @f$(a, b)@f$, so they follow the plant's gain and time constant as they drift (a warmer motor, a sagging
+     * battery, a freer or stickier mechanism). the dead time @f$d@f$ is not estimated: it's taken from the options.
+     *
+     * the gains put a double pole of the closed loop at @f$e^{-T/\tau_{cl}}@f$, with the dead time included: the
+     * characteristic polynomial is @f$(z - 1)(z - a) z^d + b (k_p (z - 1) + k_i z)@f$, of degree @f$d + 2@f$, and two
+     * gains can only place two of its roots. the other @f$d@f$ fall where they may, so the result (after the gains are
+     * clamped) is checked for stability, and if any pole is on or outside the unit circle, @f$\tau_{cl}@f$ is doubled
+     * and the design tried again. a closed-loop time constant much shorter than a few dead times isn't reachable with
+     * PI, and is slowed down this way rather than turned into an oscillating loop.
+     *
+     * the loop runs in incremental form, so clamping the output can't wind anything up. an estimate is only used if
+     * it's physically plausible (@f$a@f$ in @f$(0, 1)@f$, @f$b@f$ of the expected sign and not vanishingly small) and
+     * the gains it produces are clamped; otherwise the last good gains stay. the covariance is capped, so long
+     * stretches without excitation (holding still) don't leave the estimator ready to jump on the next bit of noise.
+     * nothing is allocated.
+     *
+     * it has the same interface as `hotel::pid_controller`, plus `step()` for loops that would rather call it directly.
+     *
+     * example:
+     * ```{.cpp}
+     * pros::Motor intake{6};
+     * // nominal: ~4.7 rpm per unit of move(), 150ms time constant, at 10ms
+     * hotel::self_tuning_controller<> controller{
+     *     {.nominal_gain = 4.7f, .nominal_time_constant = 0.15f, .closed_loop_time_constant = 0.1f},
+     *     [&intake] { return static_cast<float>(intake.get_actual_velocity()); },
+     *     [] (float error) { return std::fabs(error) < 5.0f; },
+     *     400.0f
+     * };
+     *
+     * for (float output : controller.run()) {
+     *     intake.move(static_cast<std::int32_t>(output));
+     *     pros::delay(10);
+     * }
+     * ```
+     *
+     * @tparam FeedbackFn type representing a feedback function (e.g. `std::function<float()>`)
+     * @tparam SettledFn type representing a function that evaluates whether the controller has settled
+     * @tparam MaxDelay largest dead time it can model, in ticks
+     */
+    template <class FeedbackFn = std::function<float()>, class SettledFn = std::function<bool(float)>,
+              std::size_t MaxDelay = 4>
+        requires concepts::FeedbackFunction<float, FeedbackFn> && concepts::SettledFunction<float, SettledFn>
+    class self_tuning_controller {
+    public:
+        using target_t = float;
+        using output_t = float;
+
+        struct options {
+            /// controller period, in milliseconds; the model and gains are per tick of this
+            std::uint32_t period_ms = 10;
+            /// initial model: steady-state output per unit of command
+            float nominal_gain = 1.0f;
+            /// initial model: time constant, in seconds
+            float nominal_time_constant = 0.1f;
+            /// dead time, in ticks
+            std::size_t delay = 1;
+            /// desired closed-loop time constant, in seconds; doubled (up to `max_slowdowns` times) if the dead time
+            /// leaves no stable gains for it
+            float closed_loop_time_constant = 0.1f;
+            /// RLS forgetting factor: about `1 / (1 - forgetting)` ticks of memory
+            float forgetting = 0.99f;
+            /// initial covariance of each parameter: small, so the nominal model is trusted until data disagrees
+            float initial_covariance = 0.01f;
+            /// cap on the covariance's trace
+            float max_covariance = 10.0f;
+            /// prediction errors smaller than this (measurement noise) don't update the model
+            float dead_zone = 0.0f;
+            /// ticks between gain recomputations
+            std::uint32_t retune_ticks = 25;
+            /// output limit (127 for `pros::Motor::move`)
+            float output_limit = 127.0f;
+            /// largest gains the tuner may choose
+            float max_kp = 10.0f;
+            float max_ki = 2.0f;
+            /// times the closed-loop time constant may be doubled in search of a stable design
+            std::uint32_t max_slowdowns = 6;
+            /// smallest plausible |b|, as a fraction of the nominal
+            float min_gain_fraction = 0.2f;
+        };
+
+        struct model {
+            float a;
+            float b;
+            float c;
+
+            /// @return steady-state output per unit of command
+            float gain() const { return b / (1.0f - a); };
+        };
+
+        struct gains {
+            /// per unit of error
+            float kp;
+            /// per unit of error per tick
+            float ki;
+        };
+
+        struct statistics {
+            std::uint32_t updates = 0;
+            /// updates skipped for being inside the dead zone
+            std::uint32_t skipped = 0;
+            std::uint32_t retunes = 0;
+            /// retunes whose estimate was implausible, or had no stable design, and kept the old gains
+            std::uint32_t rejected = 0;
+        };
+    private:
+        FeedbackFn feedback_fn;
+        SettledFn is_settled;
+        options opts;
+        target_t current_setpoint;
+
+        std::array<float, 3> theta;
+        std::array<std::array<float, 3>, 3> P{};
+        gains current;
+        float nominal_b;
+
+        std::array<float, MaxDelay + 1> commands{};
+        std::size_t head = 0;
+        float last_y = 0.0f;
+        float last_error = 0.0f;
+        float last_output = 0.0f;
+        bool primed = false;
+        std::uint32_t ticks = 0;
+        statistics stats_;
+
+        float delayed_command() const {
+            auto d = std::min(opts.delay, MaxDelay);
+            return commands[(head + MaxDelay + 1 - 1 - d) % (MaxDelay + 1)];
+        };
+
+        void reset_covariance() {
+            for (std::size_t i = 0; i < 3; i++) {
+                P[i] = {};
+                P[i][i] = opts.initial_covariance;
+            }
+        };
+
+        void estimate(float y) {
+            std::array<float, 3> phi{last_y, delayed_command(), 1.0f};
+            float predicted = theta[0] * phi[0] + theta[1] * phi[1] + theta[2] * phi[2];
+            float e = y - predicted;
+            if (std::fabs(e) < opts.dead_zone) {
+                stats_.skipped++;
+                return;
+            }
+
+            std::array<float, 3> Pphi{};
+            for (std::size_t i = 0; i < 3; i++) {
+                Pphi[i] = P[i][0] * phi[0] + P[i][1] * phi[1] + P[i][2] * phi[2];
+            }
+            float denominator = opts.forgetting + phi[0] * Pphi[0] + phi[1] * Pphi[1] + phi[2] * Pphi[2];
+            float trace = 0.0f;
+            for (std::size_t i = 0; i < 3; i++) {
+                float k = Pphi[i] / denominator;
+                theta[i] += k * e;
+                for (std::size_t j = 0; j < 3; j++) {
+                    P[i][j] = (P[i][j] - k * Pphi[j]) / opts.forgetting;
+                }
+                trace += P[i][i];
+            }
+            if (!std::isfinite(trace) || trace <= 0.0f) {
+                reset_covariance();
+            } else if (trace > opts.max_covariance) {
+                float scale = opts.max_covariance / trace;
+                for (auto& row : P) {
+                    for (auto& p : row) {
+                        p *= scale;
+                    }
+                }
+            }
+            stats_.updates++;
+        };
+
+        /// PI gains placing a double closed-loop pole at `pole` for the plant `b z^-d / (z - a)`
+        static gains place(float a, float b, std::size_t d, float pole) {
+            // q(z) = (z - 1)(z - a) z^d; q(z) + b((kp + ki) z - kp) has to vanish at the pole, along with its derivative
+            float pd = std::pow(pole, static_cast<float>(d));
+            float q = (pole - 1.0f) * (pole - a) * pd;
+            float dq = (2.0f * pole - 1.0f - a) * pd + static_cast<float>(d) * q / pole;
+            float kp = (q - pole * dq) / b;
+            float ki = -dq / b - kp;
+            return {kp, ki};
+        };
+
+        /// whether every root of (z - 1)(z - a) z^d + b((kp + ki) z - kp) is inside the unit circle
+        static bool stable(float a, float b, std::size_t d, gains g) {
+            // coefficients, constant term first; then the Schur-Cohn-Jury recursion, one degree at a time
+            std::array<float, MaxDelay + 3> c{};
+            std::size_t n = d + 2;
+            c[d] = a;
+            c[d + 1] = -(1.0f + a);
+            c[d + 2] = 1.0f;
+            c[0] -= b * g.kp;
+            c[1] += b * (g.kp + g.ki);
+            for (; n > 0; n--) {
+                if (!(std::fabs(c[0]) < std::fabs(c[n]))) {
+                    return false;
+                }
+                std::array<float, MaxDelay + 3> reduced{};
+                for (std::size_t i = 0; i < n; i++) {
+                    reduced[i] = c[n] * c[i + 1] - c[0] * c[n - 1 - i];
+                }
+                c = reduced;
+            }
+            return true;
+        };
+
+        /// clamped gains for the model `(a, b)` whose closed loop is stable, slowing it down as far as it has to
+        std::optional<gains> design(float a, float b) const {
+            auto d = std::min(opts.delay, MaxDelay);
+            float p = pole();
+            for (std::uint32_t i = 0; i <= opts.max_slowdowns; i++, p = std::sqrt(p)) {
+                auto g = place(a, b, d, p);
+                if (!std::isfinite(g.kp) || !std::isfinite(g.ki)) {
+                    return std::nullopt;
+                }
+                gains clamped{std::clamp(g.kp, 0.0f, opts.max_kp), std::clamp(g.ki, 0.0f, opts.max_ki)};
+                if (clamped.ki > 0.0f && stable(a, b, d, clamped)) {
+                    return clamped;
+                }
+            }
+            return std::nullopt;
+        };
+
+        void retune() {
+            stats_.retunes++;
+            float a = theta[0], b = theta[1];
+            bool plausible = std::isfinite(a) && std::isfinite(b) && a > 0.0f && a < 1.0f &&
+                             b * nominal_b > 0.0f && std::fabs(b) >= opts.min_gain_fraction * std::fabs(nominal_b);
+            if (!plausible) {
+                stats_.rejected++;
+                return;
+            }
+            auto g = design(a, b);
+            if (!g) {
+                stats_.rejected++;
+                return;
+            }
+            current = *g;
+        };
+
+        float pole() const {
+            return std::exp(-(opts.period_ms * 1e-3f) / opts.closed_loop_time_constant);
+        };
+    public:
+        /**
+         * @param o period, nominal model, tuning and limits
+         * @param ffn a feedback function
+         * @param sfn a predicate on the error that's true once settled
+         * @param setpoint the initial setpoint
+         */
+        self_tuning_controller(options o, FeedbackFn ffn, SettledFn sfn, target_t setpoint = 0.0f) :
+            feedback_fn(ffn),
+            is_settled(sfn),
+            opts(o),
+            current_setpoint(setpoint) {
+            float a = std::exp(-(o.period_ms * 1e-3f) / o.nominal_time_constant);
+            nominal_b = (1.0f - a) * o.nominal_gain;
+            theta = {a, nominal_b, 0.0f};
+            reset_covariance();
+            // with no stable design for the nominal model, start from a slow integrator and let retuning find one
+            current = design(a, nominal_b).value_or(gains{0.0f, 0.01f * (1.0f - a) / nominal_b});
+        };
+
+        /**
+         * run one iteration: read the feedback, update the model (and, every `retune_ticks`, the gains), and produce
+         * an output
+         *
+         * @return the output, clamped to `output_limit`
+         */
+        output_t step() {
+            float y = feedback_fn();
+            if (primed) {
+                estimate(y);
+                if (++ticks % opts.retune_ticks == 0) {
+                    retune();
+                }
+            }
+
+            float error = current_setpoint - y;
+            float u = std::clamp(last_output + current.kp * (error - last_error) + current.ki * error,
+                                 -opts.output_limit, opts.output_limit);
+
+            commands[head] = u;
+            head = (head + 1) % (MaxDelay + 1);
+            last_y = y;
+            last_error = error;
+            last_output = u;
+            primed = true;
+            return u;
+        };
+
+        /**
+         * create the control loop as a generator coroutine; it finishes when the settled function evaluates to `true`
+         *
+         * @return a generator producing one output per iteration
+         */
+        coro::generator<output_t> run() {
+            while (true) {
+                if (is_settled(error())) {
+                    break;
+                }
+                co_yield step();
+            }
+        };
+
+        /**
+         * set a new target
+         *
+         * the model is kept (it's the plant, not the setpoint), and so is the output, which the incremental law carries
+         * on from
+         *
+         * @param setpoint the new setpoint
+         * @return this instance
+         */
+        self_tuning_controller& target(target_t setpoint) {
+            current_setpoint = setpoint;
+            return *this;
+        };
+
+        target_t setpoint() const noexcept { return current_setpoint; };
+
+        target_t error() { return current_setpoint - feedback_fn(); };
+
+        bool settled(target_t error) { return is_settled(error); };
+
+        /**
+         * prepare to `run()` again after a pause, without a bump in the output or a bogus model update from the gap
+         *
+         * @return this instance
+         */
+        self_tuning_controller& resume() {
+            last_y = feedback_fn();
+            last_error = current_setpoint - last_y;
+            commands.fill(last_output);
+            return *this;
+        };
+
+        /**
+         * @return the current plant estimate, per tick
+         */
+        model plant() const noexcept { return {theta[0], theta[1], theta[2]}; };
+
+        /**
+         * @return the gains in use
+         */
+        gains tuning() const noexcept { return current; };
+
+        const statistics& stats() const noexcept { return stats_; };
+
+        /**
+         * write the counters, the model and the gains as one telemetry record
+         *
+         * @param out stream to write to
+         */
+        void report(FILE* out) const {
+            telemetry::write(out, "self_tuning", stats_.updates, stats_.skipped, stats_.retunes, stats_.rejected,
+                             theta[0], theta[1], theta[2], current.kp, current.ki);
+        };
+    };
+}
+
+#endif // HOTEL_SELF_TUNING_HPP
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/concepts.hpp"
+#include "hotel/coro/generator.hpp"
+#include "hotel/export.hpp"
+#include "hotel/framing.hpp"
+#include "hotel/spsc_queue.hpp"
+
+#ifndef HOTEL_SERIAL_STREAM_HPP
+#define HOTEL_SERIAL_STREAM_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * streaming parser for framed binary protocols on a serial link
+     *
+     * bytes are pulled off the link with bulk `read()`s into a mirrored ring (every byte is stored twice, `RingBytes`
+     * apart), so any frame in the ring is contiguous in memory however it wraps. frames are found, length-checked and
+     * checksummed where they sit, and handed out as spans into the ring: nothing is copied between the link and the
+     * consumer.
+     *
+     * when a frame is corrupt (bad length or checksum) the parser drops just its first byte and searches the rest of
+     * what it already has for the next sync sequence, so it resyncs without losing any good frame that follows.
+     *
+     * parsed frames come out three ways: a callback per frame (`poll`), a generator of frames (`frames`), or decoded
+     * into a lock-free queue for another task (`pump`).
+     *
+     * example:
+     * ```{.cpp}
+     * using tfmini = hotel::framing::format<hotel::framing::sync<0x59, 0x59>, hotel::framing::fixed_length<6>,
+     *                                       hotel::framing::sum8, 6, true>;
+     *
+     * pros::Serial port{10, 115200};
+     * hotel::serial_stream<tfmini, pros::Serial> lidar{port};
+     * hotel::spsc_queue<std::uint16_t, 16> distances;
+     *
+     * pros::Task reader{[&] {
+     *     while (true) {
+     *         lidar.pump(distances, [] (std::span<const std::uint8_t> payload) {
+     *             return std::optional<std::uint16_t>{payload[0] | payload[1] << 8};
+     *         });
+     *         pros::delay(5);
+     *     }
+     * }};
+     * ```
+     *
+     * @tparam Format `hotel::framing::format<...>` describing the protocol
+     * @tparam Link serial link type (`pros::Serial`, or a stand-in)
+     * @tparam RingBytes ring size; must hold at least two of the largest frame
+     */
+    template <class Format, concepts::SerialLink Link, std::size_t RingBytes = 1024>
+        requires (RingBytes >= 2 * Format::max_frame)
+    class serial_stream {
+    public:
+        using frame_t = std::span<const std::uint8_t>;
+
+        struct statistics {
+            /// bytes read off the link
+            std::uint64_t bytes = 0;
+            /// frames parsed
+            std::uint32_t frames = 0;
+            /// frames dropped for a bad checksum
+            std::uint32_t checksum_errors = 0;
+            /// frames dropped for an impossible length
+            std::uint32_t length_errors = 0;
+            /// bytes skipped while searching for sync
+            std::uint32_t discarded = 0;
+            /// decoded messages dropped because the queue was full
+            std::uint32_t queue_drops = 0;
+        };
+    private:
+        Link& link;
+        std::array<std::uint8_t, 2 * RingBytes> ring{};
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        statistics stats_;
+
+        const std::uint8_t* at(std::size_t offset) const noexcept { return &ring[offset % RingBytes]; };
+
+        /**
+         * skip ahead to the next possible start of a frame, at least `skip` bytes on
+         */
+        void resync(std::size_t skip) noexcept {
+            auto avail = tail - head;
+            auto* start = at(head);
+            auto* found = skip < avail ? static_cast<const std::uint8_t*>(
+                std::memchr(start + skip, Format::sync_t::bytes[0], avail - skip)) : nullptr;
+            auto dropped = found ? static_cast<std::size_t>(found - start) : avail;
+            stats_.discarded += dropped;
+            head += dropped;
+        };
+    public:
+        /**
+         * @param l the link to read from; must outlive the stream
+         */
+        explicit serial_stream(Link& l) : link(l) {};
+
+        /**
+         * read whatever the link has into the ring
+         *
+         * @return bytes read
+         */
+        std::size_t fill() {
+            auto space = RingBytes - (tail - head);
+            auto avail = link.get_read_avail();
+            if (avail <= 0 || !space) {
+                return 0;
+            }
+
+            auto want = std::min<std::size_t>(static_cast<std::size_t>(avail), space);
+            auto p = tail % RingBytes;
+            auto got = link.read(&ring[p], static_cast<std::int32_t>(want));
+            if (got <= 0) {
+                return 0;
+            }
+
+            // keep both copies of every byte in step
+            auto n = static_cast<std::size_t>(got);
+            auto low = std::min(n, RingBytes - p);
+            std::memcpy(&ring[p + RingBytes], &ring[p], low);
+            if (n > low) {
+                std::memcpy(&ring[0], &ring[RingBytes], n - low);
+            }
+
+            tail += n;
+            stats_.bytes += n;
+            return n;
+        };
+
+        /**
+         * parse the next complete frame already in the ring
+         *
+         * the returned span points into the ring, and is only valid until the next call to `fill()` (or anything that
+         * calls it)
+         *
+         * @return the frame's payload, or nothing if there isn't a complete frame yet
+         */
+        std::optional<frame_t> next() noexcept {
+            constexpr auto& sync = Format::sync_t::bytes;
+            while (tail - head >= Format::header_size) {
+                auto* frame = at(head);
+                if (std::memcmp(frame, sync.data(), sync.size()) != 0) {
+                    resync(1);
+                    continue;
+                }
+
+                auto payload = Format::payload_size(frame);
+                if (payload > Format::max_payload) {
+                    stats_.length_errors++;
+                    resync(1);
+                    continue;
+                }
+
+                auto size = Format::frame_size(payload);
+                if (tail - head < size) {
+                    return std::nullopt;
+                }
+
+                if (!Format::verify(frame, payload)) {
+                    stats_.checksum_errors++;
+                    resync(1);
+                    continue;
+                }
+
+                head += size;
+                stats_.frames++;
+                return frame_t{frame + Format::header_size, payload};
+            }
+
+            // a partial sync sequence at the end might still turn into a frame
+            auto avail = tail - head;
+            if (avail && std::memcmp(at(head), sync.data(), std::min(avail, sync.size())) != 0) {
+                resync(1);
+            }
+            return std::nullopt;
+        };
+
+        /**
+         * read from the link and hand every complete frame to a callback
+         *
+         * @param on_frame called with each payload (a `std::span<const std::uint8_t>` into the ring)
+         * @return number of frames parsed
+         */
+        template <class F>
+        std::size_t poll(F&& on_frame) {
+            std::size_t count = 0;
+            do {
+                while (auto frame = next()) {
+                    on_frame(*frame);
+                    count++;
+                }
+            } while (fill());
+            return count;
+        };
+
+        /**
+         * read from the link and decode every complete frame into a queue
+         *
+         * @param queue where decoded messages go
+         * @param decode called with each payload; returns `std::optional<T>`, empty to drop the frame
+         * @return number of messages queued
+         */
+        template <class T, std::size_t N, class Decode>
+        std::size_t pump(spsc_queue<T, N>& queue, Decode&& decode) {
+            std::size_t count = 0;
+            poll([&] (frame_t payload) {
+                if (std::optional<T> message = decode(payload)) {
+                    if (queue.push(*message)) {
+                        count++;
+                    } else {
+                        stats_.queue_drops++;
+                    }
+                }
+            });
+            return count;
+        };
+
+        /**
+         * generator over every frame available now, reading from the link as it goes
+         *
+         * it finishes once the link has nothing more to read, and each payload is only valid until the generator is
+         * advanced
+         */
+        coro::generator<frame_t> frames() {
+            do {
+                while (auto frame = next()) {
+                    co_yield *frame;
+                }
+            } while (fill());
+        };
+
+        const statistics& stats() const noexcept { return stats_; };
+
+        /// bytes waiting in the ring
+        std::size_t buffered() const noexcept { return tail - head; };
+    };
+}
+
+#endif // HOTEL_SERIAL_STREAM_HPP
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_SIM_PLANT_HPP
+#define HOTEL_SIM_PLANT_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::sim {
+
+    /**
+     * manually advanced microsecond clock for host-side simulation
+     *
+     * satisfies `hotel::concepts::MicrosClock`. `wait_until` doesn't block, it just jumps time forward, so anything
+     * templated on a clock runs as fast as the host can go when given this one.
+     */
+    struct virtual_clock {
+        static inline std::uint64_t current = 0;
+
+        static std::uint64_t now() noexcept { return current; };
+
+        static void wait_until(std::uint64_t t) noexcept { current = std::max(current, t); };
+
+        static void advance(std::uint64_t dt) noexcept { current += dt; };
+
+        static void reset(std::uint64_t t = 0) noexcept { current = t; };
+    };
+
+    /**
+     * first-order plant with dead time, evaluated lazily against a clock
+     *
+     * models @f$\tau \dot{y} = K u(t - t_d) - y@f$, which is a reasonable stand-in for a V5 motor's velocity response
+     * (and, with a small time constant, for the bus and sensor latency in front of an encoder). the state is only
+     * advanced when `output()` is read, in fixed sub-steps using the exact zero-order-hold discretization, so it doesn't
+     * matter how irregularly the caller polls it.
+     *
+     * example:
+     * ```{.cpp}
+     * using clock = hotel::sim::virtual_clock;
+     * hotel::sim::first_order_plant<clock> motor{{.gain = 1.0f, .time_constant = 0.08f, .dead_time_us = 12000}};
+     *
+     * motor.command(100.0f);
+     * clock::advance(20000);
+     * float y = motor.output();
+     * ```
+     *
+     * @tparam Clock clock the plant reads time from
+     * @tparam MaxPending number of commands that can be in flight inside the dead time at once; if more are issued the
+     *                    oldest is applied early
+     */
+    template <concepts::MicrosClock Clock = virtual_clock, std::size_t MaxPending = 16>
+    class first_order_plant {
+    public:
+        struct parameters {
+            /// steady-state gain from command to output
+            float gain = 1.0f;
+            /// time constant, in seconds
+            float time_constant = 0.05f;
+            /// pure delay between `command()` and the plant starting to respond, in microseconds
+            std::uint32_t dead_time_us = 0;
+            /// output quantization (e.g. encoder resolution); 0 disables it
+            float resolution = 0.0f;
+            /// integration sub-step, in microseconds
+            std::uint32_t step_us = 100;
+        };
+    private:
+        struct pending_command {
+            std::uint64_t due;
+            float value;
+        };
+
+        parameters params;
+        float y;
+        float u = 0.0f;
+        float load = 0.0f;
+        std::uint64_t last_update;
+
+        std::array<pending_command, MaxPending> pending{};
+        std::size_t pending_head = 0;
+        std::size_t pending_size = 0;
+
+        void apply_due(std::uint64_t t) {
+            while (pending_size && pending[pending_head].due <= t) {
+                u = pending[pending_head].value;
+                pending_head = (pending_head + 1) % MaxPending;
+                pending_size--;
+            }
+        };
+
+        void advance(std::uint64_t t) {
+            while (last_update < t) {
+                apply_due(last_update);
+                auto next = std::min<std::uint64_t>(last_update + params.step_us, t);
+                if (pending_size) {
+                    next = std::min(next, std::max(pending[pending_head].due, last_update + 1));
+                }
+
+                float dt = (next - last_update) * 1e-6f;
+                y += (params.gain * u - load - y) * (1.0f - std::exp(-dt / params.time_constant));
+                last_update = next;
+            }
+            apply_due(t);
+        };
+    public:
+        /**
+         * construct a plant
+         *
+         * @param p plant parameters
+         * @param initial initial output
+         */
+        explicit first_order_plant(parameters p, float initial = 0.0f) :
+            params(p),
+            y(initial),
+            last_update(Clock::now()) {};
+
+        /**
+         * issue a command; it takes effect `dead_time_us` from now
+         *
+         * @param value the command
+         */
+        void command(float value) {
+            auto now = Clock::now();
+            advance(now);
+
+            if (pending_size == MaxPending) {
+                u = pending[pending_head].value;
+                pending_head = (pending_head + 1) % MaxPending;
+                pending_size--;
+            }
+            pending[(pending_head + pending_size) % MaxPending] = {now + params.dead_time_us, value};
+            pending_size++;
+        };
+
+        /**
+         * apply a constant load disturbance, in output units at steady state (takes effect immediately)
+         *
+         * @param value the load
+         */
+        void disturb(float value) {
+            advance(Clock::now());
+            load = value;
+        };
+
+        /**
+         * read the (quantized) output at the current time
+         *
+         * @return the output
+         */
+        float output() {
+            advance(Clock::now());
+            return params.resolution > 0.0f ? std::round(y / params.resolution) * params.resolution : y;
+        };
+    };
+}
+
+#endif // HOTEL_SIM_PLANT_HPP
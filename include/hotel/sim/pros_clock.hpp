@@ -0,0 +1,32 @@
+#include "pros/rtos.hpp"
+
+#include "hotel/sim/plant.hpp"
+
+#ifndef HOTEL_SIM_PROS_CLOCK_HPP
+#define HOTEL_SIM_PROS_CLOCK_HPP
+
+/**
+ * host-side stand-in for `pros::Clock`, following `hotel::sim::virtual_clock`
+ *
+ * outside PROS, `pros::Clock::now()` (which `hotel::pid_controller` times its iterations with) is only declared, so
+ * anything using it can't link on the host. this defines it as the virtual clock's time in whole milliseconds, the way
+ * `pros::millis()` counts on the brain, so advancing the virtual clock advances both.
+ *
+ * it's a definition, not a declaration: include it from exactly one translation unit of a host program (a tool's
+ * source file), and never from anything built for the brain, or from hotel.cppm, where PROS supplies the real one.
+ *
+ * example:
+ * ```{.cpp}
+ * #include "hotel/pid.hpp"
+ * #include "hotel/sim/pros_clock.hpp"
+ *
+ * hotel::sim::virtual_clock::reset();
+ * // ...
+ * hotel::sim::virtual_clock::advance(10000); // pros::Clock::now() moves on by 10ms
+ * ```
+ */
+pros::Clock::time_point pros::Clock::now() {
+    return time_point{duration{static_cast<rep>(hotel::sim::virtual_clock::now() / 1000)}};
+}
+
+#endif // HOTEL_SIM_PROS_CLOCK_HPP
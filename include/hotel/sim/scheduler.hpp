@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+#include "hotel/schedulability.hpp"
+
+#ifndef HOTEL_SIM_SCHEDULER_HPP
+#define HOTEL_SIM_SCHEDULER_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::sim {
+
+    /**
+     * event-driven simulation of a preemptive fixed-priority scheduler, for checking a `hotel::task_set` on the host
+     *
+     * every task is released periodically (all at time 0 by default, which is the critical instant the analysis
+     * assumes) and each job runs for exactly its WCET. the highest-priority ready job always runs; jobs at the same
+     * priority run in release order. a job that's still running when the next one is released (an overrun) delays the
+     * next one, just like a loop paced with `pros::Task::delay_until` would.
+     *
+     * the observed worst-case response time of every task should never exceed what `task_set::analyze()` computed;
+     * if it does, the analysis (or the task set description) is wrong.
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::task_set<> tasks;
+     * tasks.add({.name = "odometry", .period_us = 5000, .wcet_us = 900});
+     * tasks.add({.name = "drive", .period_us = 10000, .wcet_us = 2500});
+     * tasks.add({.name = "lift", .period_us = 20000, .wcet_us = 6000});
+     * tasks.assign_rate_monotonic();
+     * tasks.analyze();
+     *
+     * hotel::sim::fixed_priority_scheduler sim{tasks};
+     * sim.run(1000000);
+     * for (std::size_t i = 0; i < tasks.size(); i++) {
+     *     assert(sim.worst_response(i) <= tasks[i].response_us);
+     * }
+     * ```
+     *
+     * @tparam MaxTasks number of tasks
+     */
+    template <std::size_t MaxTasks = 16>
+    class fixed_priority_scheduler {
+        struct state {
+            std::uint32_t period_us = 0;
+            std::uint32_t wcet_us = 0;
+            std::uint32_t deadline_us = 0;
+            std::uint32_t priority = 0;
+
+            std::uint64_t next_release = 0;
+            /// release time of the job currently running or waiting
+            std::uint64_t job_release = 0;
+            std::uint32_t remaining = 0;
+            /// jobs released but not yet started, behind the current one
+            std::uint32_t queued = 0;
+            bool active = false;
+
+            std::uint32_t worst = 0;
+            std::uint32_t best = std::numeric_limits<std::uint32_t>::max();
+            std::uint32_t jobs = 0;
+            std::uint32_t misses = 0;
+        };
+
+        std::array<state, MaxTasks> tasks{};
+        std::size_t count = 0;
+        std::uint64_t now = 0;
+        std::uint64_t busy = 0;
+
+        void release(state& t) {
+            if (t.active) {
+                t.queued++;
+            } else {
+                t.active = true;
+                t.job_release = t.next_release;
+                t.remaining = t.wcet_us;
+            }
+            t.next_release += t.period_us;
+        };
+
+        state* pick() {
+            state* best = nullptr;
+            for (std::size_t i = 0; i < count; i++) {
+                auto& t = tasks[i];
+                if (t.active && (!best || t.priority > best->priority ||
+                                 (t.priority == best->priority && t.job_release < best->job_release))) {
+                    best = &t;
+                }
+            }
+            return best;
+        };
+
+        void complete(state& t) {
+            auto response = static_cast<std::uint32_t>(now - t.job_release);
+            t.worst = std::max(t.worst, response);
+            t.best = std::min(t.best, response);
+            t.jobs++;
+            if (response > t.deadline_us) {
+                t.misses++;
+            }
+
+            if (t.queued) {
+                t.queued--;
+                t.job_release += t.period_us;
+                t.remaining = t.wcet_us;
+            } else {
+                t.active = false;
+            }
+        };
+    public:
+        /**
+         * set up a simulation of a task set with its current priorities
+         *
+         * @param set the task set
+         * @param phases optional release offset for each task, in microseconds
+         */
+        template <std::size_t N>
+        explicit fixed_priority_scheduler(const task_set<N>& set, const std::uint32_t* phases = nullptr) {
+            count = std::min(set.size(), MaxTasks);
+            for (std::size_t i = 0; i < count; i++) {
+                tasks[i].period_us = set[i].period_us;
+                tasks[i].wcet_us = set[i].wcet_us;
+                tasks[i].deadline_us = set[i].deadline();
+                tasks[i].priority = set[i].priority;
+                tasks[i].next_release = phases ? phases[i] : 0;
+            }
+        };
+
+        /**
+         * advance the simulation
+         *
+         * @param duration_us how long to simulate for, in microseconds
+         */
+        void run(std::uint64_t duration_us) {
+            auto end = now + duration_us;
+            while (now < end) {
+                for (std::size_t i = 0; i < count; i++) {
+                    while (tasks[i].next_release <= now) {
+                        release(tasks[i]);
+                    }
+                }
+
+                auto next = end;
+                for (std::size_t i = 0; i < count; i++) {
+                    next = std::min(next, tasks[i].next_release);
+                }
+
+                auto* running = pick();
+                if (!running) {
+                    now = next;
+                    continue;
+                }
+
+                auto slice = std::min<std::uint64_t>(running->remaining, next - now);
+                now += slice;
+                busy += slice;
+                running->remaining -= static_cast<std::uint32_t>(slice);
+                if (!running->remaining) {
+                    complete(*running);
+                }
+            }
+        };
+
+        /// worst response time observed for task `i`, in microseconds
+        std::uint32_t worst_response(std::size_t i) const noexcept { return tasks[i].worst; };
+
+        /// best response time observed for task `i`, in microseconds (0 before its first job completes)
+        std::uint32_t best_response(std::size_t i) const noexcept { return tasks[i].jobs ? tasks[i].best : 0; };
+
+        /// spread between task `i`'s worst and best response times, in microseconds: how much its output moves around
+        std::uint32_t jitter(std::size_t i) const noexcept { return worst_response(i) - best_response(i); };
+
+        /// number of completed jobs of task `i`
+        std::uint32_t jobs(std::size_t i) const noexcept { return tasks[i].jobs; };
+
+        /// number of jobs of task `i` that finished after their deadline
+        std::uint32_t misses(std::size_t i) const noexcept { return tasks[i].misses; };
+
+        /// fraction of the simulated time the processor was busy
+        float utilization() const noexcept { return now ? static_cast<float>(busy) / now : 0.0f; };
+
+        std::uint64_t elapsed() const noexcept { return now; };
+
+        std::size_t size() const noexcept { return count; };
+    };
+}
+
+#endif // HOTEL_SIM_SCHEDULER_HPP
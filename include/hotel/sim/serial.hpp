@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/sim/plant.hpp"
+
+#ifndef HOTEL_SIM_SERIAL_HPP
+#define HOTEL_SIM_SERIAL_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::sim {
+
+    /**
+     * one direction of a simulated serial line: a byte FIFO with an optional byte rate and bit errors
+     *
+     * with a byte rate set, each byte only becomes readable once the time it takes to send it (after everything queued
+     * ahead of it) has passed on `Clock`. with an error rate set, bytes are corrupted at random as they're written.
+     *
+     * @tparam Capacity bytes the line can hold (what `get_write_free()` reports against)
+     * @tparam Clock clock the byte rate is measured against
+     */
+    template <std::size_t Capacity = 4096, concepts::MicrosClock Clock = virtual_clock>
+    class serial_line {
+    public:
+        struct parameters {
+            /// bytes per second the line carries; 0 for unlimited
+            std::uint32_t bytes_per_second = 0;
+            /// probability each byte is corrupted in flight
+            float error_rate = 0.0f;
+            /// seed for the corruption
+            std::uint32_t seed = 1;
+        };
+    private:
+        std::array<std::uint8_t, Capacity> bytes{};
+        std::array<std::uint64_t, Capacity> arrival{};
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        double line_free = 0.0;
+        std::uint32_t rng;
+        parameters params;
+
+        std::uint32_t random() noexcept {
+            // xorshift32
+            rng ^= rng << 13;
+            rng ^= rng >> 17;
+            rng ^= rng << 5;
+            return rng;
+        };
+    public:
+        explicit serial_line(parameters p = {}) : rng(p.seed ? p.seed : 1), params(p) {};
+
+        std::int32_t write(const std::uint8_t* buffer, std::int32_t length) {
+            auto n = std::min<std::size_t>(static_cast<std::size_t>(std::max(length, 0)), Capacity - (tail - head));
+            auto now = Clock::now();
+            for (std::size_t i = 0; i < n; i++) {
+                auto b = buffer[i];
+                if (params.error_rate > 0.0f && random() < params.error_rate * 4294967295.0f) {
+                    b ^= static_cast<std::uint8_t>(1u << (random() & 7));
+                }
+                bytes[tail % Capacity] = b;
+                if (params.bytes_per_second) {
+                    line_free = std::max(line_free, static_cast<double>(now)) + 1e6 / params.bytes_per_second;
+                    arrival[tail % Capacity] = static_cast<std::uint64_t>(std::ceil(line_free));
+                } else {
+                    arrival[tail % Capacity] = now;
+                }
+                tail++;
+            }
+            return static_cast<std::int32_t>(n);
+        };
+
+        std::int32_t read(std::uint8_t* buffer, std::int32_t length) {
+            auto n = std::min<std::size_t>(static_cast<std::size_t>(std::max(length, 0)),
+                                           static_cast<std::size_t>(get_read_avail()));
+            for (std::size_t i = 0; i < n; i++) {
+                buffer[i] = bytes[head++ % Capacity];
+            }
+            return static_cast<std::int32_t>(n);
+        };
+
+        std::int32_t get_read_avail() const {
+            // arrival times never go backwards, so binary search for the first byte still in flight
+            auto now = Clock::now();
+            std::size_t low = head, high = tail;
+            while (low < high) {
+                auto mid = low + (high - low) / 2;
+                if (arrival[mid % Capacity] <= now) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            return static_cast<std::int32_t>(low - head);
+        };
+
+        std::int32_t get_write_free() const { return static_cast<std::int32_t>(Capacity - (tail - head)); };
+
+        void set_parameters(parameters p) {
+            params = p;
+            rng = p.seed ? p.seed : 1;
+        };
+    };
+
+    /**
+     * stand-in for `pros::Serial`, reading from one `serial_line` and writing to another
+     *
+     * satisfies `hotel::concepts::SerialLink`. connect two of these across a pair of lines (or use `serial_pair`) to get
+     * two ends of a link, or point one at the same line twice for a plain loopback.
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::sim::serial_pair<> wire{{.bytes_per_second = 11520}};
+     * hotel::serial_stream<my_format, hotel::sim::loopback_serial<>> stream{wire.b};
+     * wire.a.write(frame, frame_size);
+     * hotel::sim::virtual_clock::advance(10000);
+     * stream.poll([] (auto payload) { ... });
+     * ```
+     *
+     * @tparam Capacity buffer size of each line
+     * @tparam Clock clock the lines' byte rate is measured against
+     */
+    template <std::size_t Capacity = 4096, concepts::MicrosClock Clock = virtual_clock>
+    class loopback_serial {
+    public:
+        using line_t = serial_line<Capacity, Clock>;
+    private:
+        line_t* rx;
+        line_t* tx;
+    public:
+        loopback_serial(line_t& receive, line_t& transmit) : rx(&receive), tx(&transmit) {};
+
+        std::int32_t read(std::uint8_t* buffer, std::int32_t length) { return rx->read(buffer, length); };
+
+        std::int32_t write(const std::uint8_t* buffer, std::int32_t length) { return tx->write(buffer, length); };
+
+        std::int32_t read_byte() {
+            std::uint8_t b;
+            return rx->read(&b, 1) == 1 ? b : -1;
+        };
+
+        std::int32_t write_byte(std::uint8_t b) { return tx->write(&b, 1); };
+
+        std::int32_t get_read_avail() const { return rx->get_read_avail(); };
+
+        std::int32_t get_write_free() const { return tx->get_write_free(); };
+    };
+
+    /**
+     * two `loopback_serial` ends joined by a pair of lines with the same parameters
+     */
+    template <std::size_t Capacity = 4096, concepts::MicrosClock Clock = virtual_clock>
+    struct serial_pair {
+        using line_t = serial_line<Capacity, Clock>;
+
+        line_t a_to_b;
+        line_t b_to_a;
+        loopback_serial<Capacity, Clock> a{b_to_a, a_to_b};
+        loopback_serial<Capacity, Clock> b{a_to_b, b_to_a};
+
+        explicit serial_pair(typename line_t::parameters p = {}) : a_to_b(p), b_to_a(p) {};
+    };
+}
+
+#endif // HOTEL_SIM_SERIAL_HPP
@@ -0,0 +1,85 @@
+#include <array>
+#include <atomic>
+#include <optional>
+#include <type_traits>
+
+#include <cstddef>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_SPSC_QUEUE_HPP
+#define HOTEL_SPSC_QUEUE_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * lock-free single-producer single-consumer queue
+     *
+     * a fixed ring of `N` slots with an atomic head and tail, for handing values from one task to another without a
+     * mutex (e.g. parsed sensor messages from the task that reads the port to the one that uses them). exactly one task
+     * may push and exactly one may pop.
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::spsc_queue<lidar_point, 64> points;
+     *
+     * // reader task
+     * points.push(point);
+     *
+     * // consumer task
+     * while (auto p = points.pop()) {
+     *     map.add(*p);
+     * }
+     * ```
+     *
+     * @tparam T element type
+     * @tparam N number of slots; must be a power of two
+     */
+    template <class T, std::size_t N>
+        requires std::is_trivially_copyable_v<T> && (N > 0) && ((N & (N - 1)) == 0)
+    class spsc_queue {
+        std::array<T, N> slots{};
+        std::atomic<std::size_t> head{0};
+        std::atomic<std::size_t> tail{0};
+    public:
+        /**
+         * add a value (producer only)
+         *
+         * @return `false` if the queue is full
+         */
+        bool push(const T& value) noexcept {
+            auto t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) == N) {
+                return false;
+            }
+            slots[t & (N - 1)] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        };
+
+        /**
+         * remove the oldest value (consumer only)
+         *
+         * @return the value, or nothing if the queue is empty
+         */
+        std::optional<T> pop() noexcept {
+            auto h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) {
+                return std::nullopt;
+            }
+            T value = slots[h & (N - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return value;
+        };
+
+        std::size_t size() const noexcept {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        };
+
+        bool empty() const noexcept { return !size(); };
+
+        static constexpr std::size_t capacity() noexcept { return N; };
+    };
+}
+
+#endif // HOTEL_SPSC_QUEUE_HPP
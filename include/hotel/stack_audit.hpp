@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "pros/rtos.hpp"
+
+#include "hotel/export.hpp"
+#include "hotel/telemetry.hpp"
+
+#ifndef HOTEL_STACK_AUDIT_HPP
+#define HOTEL_STACK_AUDIT_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    namespace detail {
+        inline constexpr std::uint32_t stack_paint = 0xa5a5a5a5;
+
+        /**
+         * fill a stack region with the paint pattern
+         *
+         * @param bottom lowest word of the region
+         * @param words size of the region, in words
+         */
+        inline void paint_stack(std::uint32_t* bottom, std::size_t words) {
+            volatile std::uint32_t* p = bottom;
+            for (std::size_t i = 0; i < words; i++) {
+                p[i] = stack_paint;
+            }
+        };
+
+        /**
+         * count how much of a painted stack region has never been touched
+         *
+         * stacks grow down, so this counts painted words from the bottom up until the first one that isn't
+         *
+         * @param bottom lowest word of the region
+         * @param words size of the region, in words
+         * @return number of untouched words
+         */
+        inline std::size_t untouched_words(const std::uint32_t* bottom, std::size_t words) {
+            const volatile std::uint32_t* p = bottom;
+            std::size_t i = 0;
+            while (i < words && p[i] == stack_paint) {
+                i++;
+            }
+            return i;
+        };
+    }
+
+    /**
+     * task stack high-water-mark measurement
+     *
+     * tasks created through the audit get a small trampoline that paints everything below its own frame with a known
+     * pattern before running the task's body. `scan()` then finds the deepest point each stack has ever reached by
+     * looking for the first overwritten word from the bottom, which is enough to see how much of
+     * `TASK_STACK_DEPTH_DEFAULT` a task actually needs and to recommend a smaller depth.
+     *
+     * the kernel doesn't tell us where a task's stack starts, so the region painted is worked out from the trampoline's
+     * own frame and the requested depth, leaving `entry_reserve_words` at the top for what the kernel and the
+     * trampoline use before painting. that slack is counted as used, so the reported usage errs on the high side.
+     *
+     * scanning only ever reads, and can be done from any task. a task's stack is scanned one last time when its body
+     * returns, and never again after that.
+     *
+     * example:
+     * ```{.cpp}
+     * auto& audit = hotel::default_stack_audit();
+     * audit.create([] { odometry_loop(); }, "odometry");
+     * audit.create([] { lift_loop(); }, "lift", TASK_PRIORITY_DEFAULT + 1);
+     * audit.watch(1000);
+     *
+     * // after running the robot through everything it'll do in a match
+     * audit.report(stdout);
+     * ```
+     *
+     * @tparam MaxTasks number of tasks that can be audited
+     */
+    template <std::size_t MaxTasks = 16>
+    class basic_stack_audit {
+    public:
+        /// words at the top of each stack that aren't painted (kernel entry frame and the trampoline)
+        static constexpr std::size_t entry_reserve_words = 64;
+
+        class entry {
+            enum : std::uint8_t { is_empty, is_starting, is_running, is_finished };
+
+            const char* name_ = nullptr;
+            pros::task_t handle_ = nullptr;
+            std::uint16_t depth_ = 0;
+            std::uint32_t* bottom = nullptr;
+            std::size_t painted = 0;
+            std::atomic<std::size_t> peak_{0};
+            std::atomic<std::uint8_t> state{is_empty};
+            std::function<void()> body;
+
+            friend class basic_stack_audit;
+
+            void scan() {
+                if (state.load(std::memory_order_acquire) != is_running) {
+                    return;
+                }
+                auto used = depth_ - untouched();
+                auto peak = peak_.load(std::memory_order_relaxed);
+                while (used > peak && !peak_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+                }
+            };
+
+            std::size_t untouched() const { return detail::untouched_words(bottom, painted); };
+        public:
+            const char* name() const noexcept { return name_; };
+
+            pros::task_t task() const noexcept { return handle_; };
+
+            /// depth the task was created with, in words
+            std::uint16_t depth() const noexcept { return depth_; };
+
+            /// deepest stack usage seen so far, in words
+            std::size_t peak() const noexcept { return peak_.load(std::memory_order_relaxed); };
+
+            /// fraction of the stack used at the deepest point seen so far
+            float usage() const noexcept { return depth_ ? static_cast<float>(peak()) / depth_ : 0.0f; };
+
+            /// whether the task's body has returned
+            bool finished() const noexcept { return state.load(std::memory_order_acquire) == entry::is_finished; };
+
+            /**
+             * recommend a stack depth from the usage seen so far
+             *
+             * @param headroom extra fraction on top of the peak
+             * @return depth in words, rounded up to a multiple of 128 and no smaller than `TASK_STACK_DEPTH_MIN`
+             */
+            std::uint16_t recommended_depth(float headroom = 0.25f) const noexcept {
+                auto words = static_cast<std::size_t>(peak() * (1.0f + headroom)) + 1;
+                words = (words + 127) / 128 * 128;
+                return static_cast<std::uint16_t>(std::clamp<std::size_t>(words, TASK_STACK_DEPTH_MIN, 0xff80));
+            };
+        };
+    private:
+        std::array<entry, MaxTasks> entries;
+        std::atomic<std::size_t> count{0};
+
+        static void trampoline(void* parameters) {
+            auto& e = *static_cast<entry*>(parameters);
+
+            // everything from a little below this frame down to the bottom of the stack is still unused
+            std::uint32_t marker = 0;
+            auto* top = reinterpret_cast<std::uint32_t*>(&marker);
+            e.bottom = top - (e.depth_ - entry_reserve_words);
+            e.painted = e.depth_ - 2 * entry_reserve_words;
+            detail::paint_stack(e.bottom, e.painted);
+            e.state.store(entry::is_running, std::memory_order_release);
+
+            e.body();
+
+            e.scan();
+            e.state.store(entry::is_finished, std::memory_order_release);
+        };
+    public:
+        /**
+         * create a task with a painted stack
+         *
+         * @param function task body
+         * @param name task name; must outlive the audit (a string literal, usually)
+         * @param prio task priority
+         * @param stack_depth stack depth, in words
+         * @return the task handle, or `nullptr` if the audit is full, the depth is too small to paint, or the task
+         *         couldn't be created
+         */
+        template <class F>
+        pros::task_t create(F&& function, const char* name, std::uint32_t prio = TASK_PRIORITY_DEFAULT,
+                            std::uint16_t stack_depth = TASK_STACK_DEPTH_DEFAULT) {
+            static_assert(std::is_invocable_r_v<void, F>);
+            if (stack_depth <= 4 * entry_reserve_words) {
+                return nullptr;
+            }
+
+            auto slot = count.fetch_add(1, std::memory_order_acq_rel);
+            if (slot >= MaxTasks) {
+                return nullptr;
+            }
+
+            auto& e = entries[slot];
+            e.name_ = name;
+            e.depth_ = stack_depth;
+            e.body = std::forward<F>(function);
+            e.state.store(entry::is_starting, std::memory_order_release);
+            e.handle_ = pros::c::task_create(trampoline, &e, prio, stack_depth, name);
+            if (!e.handle_) {
+                // out of memory for the stack, most likely; the slot stays used up, but nothing reports it
+                e.body = nullptr;
+                e.state.store(entry::is_empty, std::memory_order_release);
+            }
+            return e.handle_;
+        };
+
+        /**
+         * update the high-water mark of every running task
+         */
+        void scan() {
+            for_each([] (entry& e) { e.scan(); });
+        };
+
+        /**
+         * scan periodically from a low-priority task (itself audited)
+         *
+         * @param period_ms time between scans, in milliseconds
+         * @return the watcher task handle
+         */
+        pros::task_t watch(std::uint32_t period_ms = 1000) {
+            return create([this, period_ms] {
+                auto now = pros::c::millis();
+                while (true) {
+                    scan();
+                    pros::c::task_delay_until(&now, period_ms);
+                }
+            }, "stack_audit", TASK_PRIORITY_MIN, TASK_STACK_DEPTH_MIN * 2);
+        };
+
+        /**
+         * visit every audited task
+         *
+         * @param fn called with each `entry&`
+         */
+        template <class F>
+        void for_each(F&& fn) {
+            auto n = std::min(count.load(std::memory_order_acquire), MaxTasks);
+            for (std::size_t i = 0; i < n; i++) {
+                if (entries[i].state.load(std::memory_order_acquire) != entry::is_empty) {
+                    fn(entries[i]);
+                }
+            }
+        };
+
+        /**
+         * scan, then write every task as `stack` telemetry records
+         *
+         * fields are: name, depth, peak, usage, recommended depth (depths in words)
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) {
+            scan();
+            for_each([out] (const entry& e) {
+                telemetry::write(out, "stack", e.name(), e.depth(), e.peak(), e.usage(), e.recommended_depth());
+            });
+        };
+    };
+
+    /**
+     * the stack audit used by default throughout libhotel
+     */
+    using stack_audit = basic_stack_audit<>;
+
+    /**
+     * @return the shared stack audit instance
+     */
+    inline stack_audit& default_stack_audit() {
+        static stack_audit instance;
+        return instance;
+    };
+}
+
+#endif // HOTEL_STACK_AUDIT_HPP
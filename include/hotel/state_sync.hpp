@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/framing.hpp"
+#include "hotel/serial_stream.hpp"
+
+#ifndef HOTEL_STATE_SYNC_HPP
+#define HOTEL_STATE_SYNC_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    namespace detail {
+        /// whether sequence number `a` comes after `b`, allowing for wraparound
+        inline bool seq_after(std::uint16_t a, std::uint16_t b) noexcept {
+            return static_cast<std::int16_t>(a - b) > 0;
+        };
+
+        /// a 16-bit epoch from a timestamp (the splitmix64 finalizer, so neighbouring times give unrelated epochs)
+        inline std::uint16_t epoch_from(std::uint64_t t) noexcept {
+            t = (t ^ (t >> 30)) * 0xbf58476d1ce4e5b9ull;
+            t = (t ^ (t >> 27)) * 0x94d049bb133111ebull;
+            return static_cast<std::uint16_t>((t ^ (t >> 31)) >> 48);
+        };
+
+        /**
+         * encode `current` against `base` as a bitmask of changed bytes followed by the new value of each one
+         *
+         * @return bytes written to `out` (which needs room for `(size + 7) / 8 + size` bytes)
+         */
+        inline std::size_t encode_delta(const std::uint8_t* base, const std::uint8_t* current, std::size_t size,
+                                        std::uint8_t* out) noexcept {
+            auto mask_size = (size + 7) / 8;
+            std::memset(out, 0, mask_size);
+            auto n = mask_size;
+            for (std::size_t i = 0; i < size; i++) {
+                if (base[i] != current[i]) {
+                    out[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+                    out[n++] = current[i];
+                }
+            }
+            return n;
+        };
+
+        /**
+         * apply a delta from `encode_delta` to `object`, which holds the base it was taken against
+         *
+         * @return `false` (leaving `object` alone) if the delta is the wrong length for the object
+         */
+        inline bool decode_delta(std::span<const std::uint8_t> delta, std::size_t size, std::uint8_t* object) noexcept {
+            auto mask_size = (size + 7) / 8;
+            if (delta.size() < mask_size) {
+                return false;
+            }
+            std::size_t changed = 0;
+            for (std::size_t i = 0; i < mask_size; i++) {
+                changed += static_cast<std::size_t>(std::popcount(delta[i]));
+            }
+            if (delta.size() != mask_size + changed) {
+                return false;
+            }
+
+            auto n = mask_size;
+            for (std::size_t i = 0; i < size; i++) {
+                if (delta[i / 8] & (1u << (i % 8))) {
+                    object[i] = delta[n++];
+                }
+            }
+            return true;
+        };
+    }
+
+    /**
+     * replication of plain structs between two brains (or a brain and a coprocessor) over a serial link
+     *
+     * one end `publish`es an object under an id, and the other `subscribe`s its own copy to the same id. whenever the
+     * published object differs from what the other end is known to have, `service()` sends it as a delta against the
+     * last version the other end acknowledged: a bitmask of the bytes that changed and their new values, so a pose
+     * where only a few bytes move costs a fraction of the whole struct. each message carries a sequence number, and
+     * stale or out-of-order ones are ignored; the receiving end acknowledges what it applies. a full keyframe goes out
+     * every `keyframe_us`, or whenever the acknowledged version has fallen out of the sender's history, so a restart on
+     * either end recovers by itself.
+     *
+     * sequence numbers start over when a sync is recreated, so every message and ack also carries the sender's epoch,
+     * picked when the sync first services (from the clock, unless `options::epoch` sets one). a subscriber that sees a
+     * new epoch drops everything it had from the old one and waits for a keyframe, and a publisher ignores acks for any
+     * epoch but its own, so a version number from before a restart is never mistaken for one after it.
+     * tools/sync_check.cpp checks all this over a link that loses and reorders frames, with either end restarting.
+     *
+     * everything sent (messages and acks) is paced by a byte budget, which should be set to a bit under what the link
+     * can actually carry, and objects take turns so a busy one can't starve the rest.
+     *
+     * both ends need the same ids for the same types. objects are copied in and out during `service()`, so they should
+     * only be touched from the task that calls it (or under the same lock).
+     *
+     * example:
+     * ```{.cpp}
+     * struct shared_state {
+     *     float x, y, theta;
+     *     std::uint8_t intent;
+     * };
+     *
+     * pros::Serial port{12, 115200};
+     * hotel::state_sync<pros::Serial> sync{port, {.bytes_per_second = 9000}};
+     *
+     * shared_state mine{}, theirs{};
+     * sync.publish(0, mine, 20000);   // at most every 20ms
+     * sync.subscribe(1, theirs);
+     *
+     * while (true) {
+     *     mine = {odom.x, odom.y, odom.theta, current_intent};
+     *     sync.service();
+     *     if (sync.age_us(1) < 200000) {
+     *         avoid(theirs);
+     *     }
+     *     pros::delay(10);
+     * }
+     * ```
+     *
+     * @tparam Link serial link type (`pros::Serial`, or a stand-in)
+     * @tparam MaxObjects number of objects that can be published and subscribed (together)
+     * @tparam MaxObjectBytes size limit for each object
+     * @tparam History number of sent (and received) versions kept per object to delta against
+     * @tparam Clock clock the budget, periods and keyframes are measured against
+     */
+    template <concepts::SerialLink Link, std::size_t MaxObjects = 8, std::size_t MaxObjectBytes = 64,
+              std::size_t History = 8, concepts::MicrosClock Clock = micros_clock>
+        requires (MaxObjects < 0x80 && MaxObjectBytes <= 128 && History > 0)
+    class state_sync {
+    public:
+        /// id, epoch, sequence number and base sequence number
+        static constexpr std::size_t message_header = 7;
+        /// id, epoch and sequence number
+        static constexpr std::size_t ack_size = 5;
+        static constexpr std::uint8_t ack_flag = 0x80;
+        static constexpr std::size_t max_payload = message_header + (MaxObjectBytes + 7) / 8 + MaxObjectBytes;
+
+        using format = framing::format<framing::sync<0xc3, 0x3c>, framing::length<std::uint8_t>, framing::crc16_ccitt,
+                                       max_payload>;
+
+        struct options {
+            /// bytes per second the sync can use, framing included
+            std::uint32_t bytes_per_second = 9000;
+            /// time between keyframes of each object, in microseconds
+            std::uint32_t keyframe_us = 1000000;
+            /// how long to wait for an ack before sending the same version again, in microseconds
+            std::uint32_t resend_us = 100000;
+            /// this end's epoch; 0 picks one from the clock on the first `service()`, which is different enough
+            /// from boot to boot. set one (e.g. a counter kept on the SD card) if the first service happens at a fixed
+            /// time after boot
+            std::uint16_t epoch = 0;
+        };
+
+        struct statistics {
+            std::uint32_t keyframes = 0;
+            std::uint32_t deltas = 0;
+            std::uint32_t acks = 0;
+            /// bytes sent, framing included
+            std::uint64_t bytes = 0;
+            /// bytes the same messages would have taken as keyframes
+            std::uint64_t keyframe_bytes = 0;
+            /// messages received that couldn't be applied (unknown id, wrong size, missing base)
+            std::uint32_t rejected = 0;
+            /// messages received that were older than what's already applied
+            std::uint32_t stale = 0;
+        };
+    private:
+        struct version {
+            std::uint16_t seq = 0;
+            bool valid = false;
+            std::array<std::uint8_t, MaxObjectBytes> bytes{};
+        };
+
+        struct object {
+            enum : std::uint8_t { unused, published, subscribed } kind = unused;
+            std::uint8_t id = 0;
+            std::size_t size = 0;
+            const void* source = nullptr;
+            void* target = nullptr;
+            std::uint32_t period_us = 0;
+
+            std::array<version, History> history{};
+            std::uint16_t seq = 0;
+            bool sent_any = false;
+            std::uint64_t sent_at = 0;
+            std::uint64_t keyframe_at = 0;
+            /// publisher: latest version acknowledged by the other end
+            std::uint16_t acked = 0;
+            bool has_ack = false;
+            /// subscriber: the publisher's epoch (and the one before it), latest version applied, and whether the ack
+            /// for it still has to go out
+            std::uint16_t epoch = 0;
+            std::uint16_t retired_epoch = 0;
+            bool has_retired = false;
+            std::uint64_t updated_at = 0;
+            bool ack_pending = false;
+            bool has_applied = false;
+
+            version* find(std::uint16_t s) {
+                for (auto& v : history) {
+                    if (v.valid && v.seq == s) {
+                        return &v;
+                    }
+                }
+                return nullptr;
+            };
+
+            version& slot(std::uint16_t s) { return history[s % History]; };
+        };
+
+        Link& link;
+        options opts;
+        std::uint16_t epoch = 0;
+        bool has_epoch = false;
+        serial_stream<format, Link, 4 * format::max_frame> stream;
+        std::array<object, MaxObjects> objects{};
+        std::size_t next_turn = 0;
+        float tokens = 0.0f;
+        std::uint64_t last_refill;
+        statistics stats_;
+        std::array<std::uint8_t, max_payload> payload{};
+        std::array<std::uint8_t, format::max_frame> frame{};
+
+        object* lookup(std::uint8_t id) {
+            for (auto& o : objects) {
+                if (o.kind != object::unused && o.id == id) {
+                    return &o;
+                }
+            }
+            return nullptr;
+        };
+
+        object* add(std::uint8_t id, std::size_t size) {
+            if (id >= ack_flag || size > MaxObjectBytes || lookup(id)) {
+                return nullptr;
+            }
+            for (auto& o : objects) {
+                if (o.kind == object::unused) {
+                    o.id = id;
+                    o.size = size;
+                    return &o;
+                }
+            }
+            return nullptr;
+        };
+
+        bool write_frame(std::size_t size, std::int32_t& room) {
+            auto n = static_cast<std::int32_t>(format::frame_size(size));
+            if (n > room || static_cast<float>(n) > tokens) {
+                return false;
+            }
+            format::encode({payload.data(), size}, frame.data());
+            link.write(frame.data(), n);
+            room -= n;
+            tokens -= static_cast<float>(n);
+            stats_.bytes += static_cast<std::uint64_t>(n);
+            return true;
+        };
+
+        static std::uint16_t read16(const std::uint8_t* p) { return static_cast<std::uint16_t>(p[0] | p[1] << 8); };
+
+        static void write16(std::uint8_t* p, std::uint16_t v) {
+            p[0] = static_cast<std::uint8_t>(v);
+            p[1] = static_cast<std::uint8_t>(v >> 8);
+        };
+
+        void on_message(std::span<const std::uint8_t> p) {
+            if (p.size() < ack_size) {
+                stats_.rejected++;
+                return;
+            }
+            auto* o = lookup(p[0] & ~ack_flag);
+            auto message_epoch = read16(&p[1]);
+            auto seq = read16(&p[3]);
+
+            if (p[0] & ack_flag) {
+                // only acks for this epoch and for versions we still have count, so one left over from before a restart
+                // (on either end) is ignored
+                if (o && o->kind == object::published && message_epoch == epoch && o->find(seq) &&
+                    (!o->has_ack || !o->find(o->acked) || detail::seq_after(seq, o->acked))) {
+                    o->acked = seq;
+                    o->has_ack = true;
+                }
+                return;
+            }
+
+            if (!o || o->kind != object::subscribed || p.size() < message_header) {
+                stats_.rejected++;
+                return;
+            }
+            auto base_seq = read16(&p[5]);
+            if (o->has_applied && message_epoch != o->epoch) {
+                // the publisher has restarted: nothing from before means anything now, and only a keyframe can be
+                // applied. anything still in flight from the epoch it left is older than what's applied, so is stale
+                if (o->has_retired && message_epoch == o->retired_epoch) {
+                    stats_.stale++;
+                    return;
+                }
+                if (base_seq != seq) {
+                    stats_.rejected++;
+                    return;
+                }
+                for (auto& v : o->history) {
+                    v.valid = false;
+                }
+                o->retired_epoch = o->epoch;
+                o->has_retired = true;
+                o->has_applied = false;
+                o->ack_pending = false;
+            }
+            if (o->has_applied && !detail::seq_after(seq, o->seq)) {
+                stats_.stale++;
+                // a repeat of a delta, or of what's applied, probably means our ack was lost; ack again
+                o->ack_pending = o->ack_pending || base_seq != seq || seq == o->seq;
+                return;
+            }
+
+            auto body = p.subspan(message_header);
+            auto& v = o->slot(seq);
+            if (base_seq == seq) {
+                if (body.size() != o->size) {
+                    stats_.rejected++;
+                    return;
+                }
+                std::memcpy(v.bytes.data(), body.data(), o->size);
+            } else {
+                auto* base = o->find(base_seq);
+                if (!base) {
+                    stats_.rejected++;
+                    return;
+                }
+                auto decoded = base->bytes;
+                if (!detail::decode_delta(body, o->size, decoded.data())) {
+                    stats_.rejected++;
+                    return;
+                }
+                v.bytes = decoded;
+            }
+            v.seq = seq;
+            v.valid = true;
+
+            std::memcpy(o->target, v.bytes.data(), o->size);
+            o->epoch = message_epoch;
+            o->seq = seq;
+            o->has_applied = true;
+            o->ack_pending = true;
+            o->updated_at = Clock::now();
+        };
+
+        bool send_ack(object& o, std::int32_t& room) {
+            payload[0] = static_cast<std::uint8_t>(o.id | ack_flag);
+            write16(&payload[1], o.epoch);
+            write16(&payload[3], o.seq);
+            if (!write_frame(ack_size, room)) {
+                return false;
+            }
+            o.ack_pending = false;
+            stats_.acks++;
+            return true;
+        };
+
+        /**
+         * @return `false` if the object needed sending but there wasn't room or budget
+         */
+        bool send_update(object& o, std::int32_t& room, std::uint64_t now) {
+            if (o.sent_any && now - o.sent_at < o.period_us) {
+                return true;
+            }
+
+            const auto* current = static_cast<const std::uint8_t*>(o.source);
+            auto* acked = o.has_ack ? o.find(o.acked) : nullptr;
+            auto* last = o.sent_any ? o.find(o.seq) : nullptr;
+            bool keyframe_due = !o.sent_any || now - o.keyframe_at >= opts.keyframe_us;
+            if (!keyframe_due) {
+                if (acked && std::memcmp(acked->bytes.data(), current, o.size) == 0) {
+                    // the other end already has it
+                    return true;
+                }
+                if (last && last != acked && std::memcmp(last->bytes.data(), current, o.size) == 0 &&
+                    now - o.sent_at < opts.resend_us) {
+                    // already sent, still waiting to hear back
+                    return true;
+                }
+            }
+
+            auto seq = static_cast<std::uint16_t>(o.seq + 1);
+            bool keyframe = keyframe_due || !acked;
+            payload[0] = o.id;
+            write16(&payload[1], epoch);
+            write16(&payload[3], seq);
+            std::size_t size;
+            if (keyframe) {
+                write16(&payload[5], seq);
+                std::memcpy(&payload[message_header], current, o.size);
+                size = message_header + o.size;
+            } else {
+                write16(&payload[5], acked->seq);
+                size = message_header + detail::encode_delta(acked->bytes.data(), current, o.size,
+                                                             &payload[message_header]);
+                if (size >= message_header + o.size) {
+                    // a delta that big isn't worth it
+                    keyframe = true;
+                    write16(&payload[5], seq);
+                    std::memcpy(&payload[message_header], current, o.size);
+                    size = message_header + o.size;
+                }
+            }
+
+            if (!write_frame(size, room)) {
+                return false;
+            }
+
+            auto& v = o.slot(seq);
+            std::memcpy(v.bytes.data(), current, o.size);
+            v.seq = seq;
+            v.valid = true;
+            o.seq = seq;
+            o.sent_at = now;
+            o.sent_any = true;
+            if (keyframe) {
+                o.keyframe_at = now;
+                stats_.keyframes++;
+            } else {
+                stats_.deltas++;
+            }
+            stats_.keyframe_bytes += format::frame_size(message_header + o.size);
+            return true;
+        };
+    public:
+        /**
+         * @param l the link; must outlive the sync
+         * @param o budget and timing
+         */
+        explicit state_sync(Link& l, options o = {}) :
+            link(l),
+            opts(o),
+            stream(l),
+            tokens(static_cast<float>(format::max_frame)),
+            last_refill(Clock::now()) {};
+
+        /**
+         * send an object to the other end
+         *
+         * @param id id the other end subscribes to (0-127)
+         * @param source the object; must outlive the sync
+         * @param period_us minimum time between updates, in microseconds
+         * @return `false` if the id is taken or out of range, the object is too big, or there's no room
+         */
+        template <class T>
+            requires std::is_trivially_copyable_v<T>
+        bool publish(std::uint8_t id, const T& source, std::uint32_t period_us = 20000) {
+            auto* o = add(id, sizeof(T));
+            if (!o) {
+                return false;
+            }
+            o->source = &source;
+            o->period_us = period_us;
+            o->kind = object::published;
+            return true;
+        };
+
+        /**
+         * keep an object up to date with what the other end publishes
+         *
+         * @param id id the other end publishes under
+         * @param target the object; must outlive the sync
+         * @return `false` if the id is taken or out of range, the object is too big, or there's no room
+         */
+        template <class T>
+            requires std::is_trivially_copyable_v<T>
+        bool subscribe(std::uint8_t id, T& target) {
+            auto* o = add(id, sizeof(T));
+            if (!o) {
+                return false;
+            }
+            o->target = &target;
+            o->kind = object::subscribed;
+            return true;
+        };
+
+        /**
+         * apply what's arrived, acknowledge it, then send whatever's changed as far as the budget allows
+         */
+        void service() {
+            auto now = Clock::now();
+            if (!has_epoch) {
+                epoch = opts.epoch ? opts.epoch : detail::epoch_from(now);
+                has_epoch = true;
+            }
+
+            stream.poll([this] (std::span<const std::uint8_t> p) { on_message(p); });
+            now = Clock::now();
+            tokens = std::min(tokens + static_cast<float>(now - last_refill) * 1e-6f * opts.bytes_per_second,
+                              static_cast<float>(std::max<std::uint32_t>(opts.bytes_per_second / 10,
+                                                                          2 * format::max_frame)));
+            last_refill = now;
+            auto room = link.get_write_free();
+
+            // acks first: they're small, and the other end's deltas depend on them
+            for (auto& o : objects) {
+                if (o.kind == object::subscribed && o.ack_pending && !send_ack(o, room)) {
+                    return;
+                }
+            }
+
+            for (std::size_t i = 0; i < MaxObjects; i++) {
+                auto& o = objects[(next_turn + i) % MaxObjects];
+                if (o.kind == object::published && !send_update(o, room, now)) {
+                    // out of room; whoever was next goes first next time
+                    next_turn = (next_turn + i) % MaxObjects;
+                    return;
+                }
+            }
+            next_turn = (next_turn + 1) % MaxObjects;
+        };
+
+        /**
+         * @return microseconds since a subscribed object was last updated, or the maximum value if it never has been
+         */
+        std::uint64_t age_us(std::uint8_t id) {
+            auto* o = lookup(id);
+            return o && o->has_applied ? Clock::now() - o->updated_at : ~std::uint64_t{0};
+        };
+
+        const statistics& stats() const noexcept { return stats_; };
+
+        /// the underlying frame parser, for its error statistics
+        const auto& link_stats() const noexcept { return stream.stats(); };
+    };
+}
+
+#endif // HOTEL_STATE_SYNC_HPP
@@ -0,0 +1,57 @@
+#include <concepts>
+#include <type_traits>
+
+#include <cstdio>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_TELEMETRY_HPP
+#define HOTEL_TELEMETRY_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::telemetry {
+
+    namespace detail {
+        template <class T>
+        void write_field(std::FILE* out, const T& value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                std::fputc(value ? '1' : '0', out);
+            } else if constexpr (std::is_enum_v<T>) {
+                std::fprintf(out, "%lld", static_cast<long long>(value));
+            } else if constexpr (std::signed_integral<T>) {
+                std::fprintf(out, "%lld", static_cast<long long>(value));
+            } else if constexpr (std::unsigned_integral<T>) {
+                std::fprintf(out, "%llu", static_cast<unsigned long long>(value));
+            } else if constexpr (std::floating_point<T>) {
+                std::fprintf(out, "%g", static_cast<double>(value));
+            } else {
+                std::fputs(value, out);
+            }
+        };
+    }
+
+    /**
+     * write one telemetry record
+     *
+     * records are single lines of the form `#channel,field,field,...`, which is trivial to split on the host and easy
+     * to pick out of the rest of the terminal output. on the brain `stdout` goes over the USB serial link; pass a file
+     * opened on `/usd/` to log to the SD card instead (the format is the same, so the same tools read both).
+     *
+     * example:
+     * ```{.cpp}
+     * hotel::telemetry::write(stdout, "lift", pros::millis(), lift.get_position(), output);
+     * ```
+     *
+     * @param out stream to write to
+     * @param channel record name
+     * @param fields arithmetic values, enums or C strings
+     */
+    template <class... Ts>
+    void write(std::FILE* out, const char* channel, const Ts&... fields) {
+        std::fputc('#', out);
+        std::fputs(channel, out);
+        ((std::fputc(',', out), detail::write_field(out, fields)), ...);
+        std::fputc('\n', out);
+    };
+}
+
+#endif // HOTEL_TELEMETRY_HPP
@@ -0,0 +1,326 @@
+#include <array>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/coro/generator.hpp"
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_TIMESERIES_HPP
+#define HOTEL_TIMESERIES_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    namespace detail {
+        /**
+         * fixed-capacity double-ended queue of ring positions, used for the monotonic min/max queues
+         */
+        template <std::size_t N>
+        class position_deque {
+            std::array<std::size_t, N> slots{};
+            std::size_t first = 0;
+            std::size_t length = 0;
+        public:
+            bool empty() const noexcept { return !length; };
+
+            std::size_t front() const noexcept { return slots[first]; };
+
+            std::size_t back() const noexcept { return slots[(first + length - 1) % N]; };
+
+            void push_back(std::size_t p) noexcept { slots[(first + length++) % N] = p; };
+
+            void pop_front() noexcept {
+                first = (first + 1) % N;
+                length--;
+            };
+
+            void pop_back() noexcept { length--; };
+
+            void clear() noexcept { first = length = 0; };
+        };
+    }
+
+    /**
+     * sliding window over the most recent samples of a signal, with O(1) min, max, mean and variance
+     *
+     * samples are kept in a fixed-capacity ring (values and timestamps in separate arrays), and the window is whichever
+     * is shorter of the last `N` samples and, if a duration is given, the last `window_us` microseconds. every push (or
+     * `expire()`) updates a pair of monotonic queues for the min and max and a running sum and sum of squares, so every
+     * statistic is available in constant time no matter how big the window is.
+     *
+     * for floating-point samples the running sums are recomputed from scratch once every `N` evictions, so rounding
+     * error can't build up over a long match.
+     *
+     * example:
+     * ```{.cpp}
+     * // peak current over the last 500ms
+     * hotel::timeseries<float, 64> current{500000};
+     *
+     * while (true) {
+     *     current.push(pros::micros(), lift.get_current_draw() / 1000.0f);
+     *     if (current.max() > 2.2f) {
+     *         lift.move(0);
+     *     }
+     *     pros::delay(10);
+     * }
+     * ```
+     *
+     * @tparam T sample type
+     * @tparam N capacity, in samples
+     */
+    template <class T, std::size_t N>
+        requires std::is_arithmetic_v<T> && (N > 0)
+    class timeseries {
+    public:
+        /// type of the running sum: `double` for floating-point samples, otherwise a 64-bit integer
+        using sum_t = std::conditional_t<std::is_floating_point_v<T>, double, std::int64_t>;
+    private:
+        std::array<T, N> values{};
+        std::array<std::uint64_t, N> times{};
+        std::size_t first = 0;
+        std::size_t length = 0;
+        std::uint64_t window_us;
+
+        detail::position_deque<N> min_queue;
+        detail::position_deque<N> max_queue;
+        sum_t running_sum = 0;
+        double running_squares = 0.0;
+        std::size_t evictions = 0;
+
+        std::size_t position(std::size_t i) const noexcept { return (first + i) % N; };
+
+        void evict() {
+            auto p = first;
+            if (!min_queue.empty() && min_queue.front() == p) {
+                min_queue.pop_front();
+            }
+            if (!max_queue.empty() && max_queue.front() == p) {
+                max_queue.pop_front();
+            }
+            running_sum -= values[p];
+            running_squares -= static_cast<double>(values[p]) * values[p];
+            first = (first + 1) % N;
+            length--;
+
+            if constexpr (std::is_floating_point_v<T>) {
+                if (++evictions == N) {
+                    evictions = 0;
+                    running_sum = 0;
+                    running_squares = 0.0;
+                    for (std::size_t i = 0; i < length; i++) {
+                        running_sum += values[position(i)];
+                        running_squares += static_cast<double>(values[position(i)]) * values[position(i)];
+                    }
+                }
+            }
+        };
+    public:
+        /**
+         * construct an empty series
+         *
+         * @param window_us maximum age of a sample relative to the newest one, in microseconds; 0 keeps the last `N`
+         *                  samples regardless of age
+         */
+        explicit timeseries(std::uint64_t window_us = 0) : window_us(window_us) {};
+
+        /**
+         * add a sample, evicting whatever falls out of the window
+         *
+         * @param t sample time, in microseconds; must not go backwards
+         * @param value the sample
+         */
+        void push(std::uint64_t t, T value) {
+            if (length == N) {
+                evict();
+            }
+            expire(t);
+
+            auto p = position(length++);
+            values[p] = value;
+            times[p] = t;
+
+            while (!min_queue.empty() && !(values[min_queue.back()] < value)) {
+                min_queue.pop_back();
+            }
+            min_queue.push_back(p);
+            while (!max_queue.empty() && !(value < values[max_queue.back()])) {
+                max_queue.pop_back();
+            }
+            max_queue.push_back(p);
+
+            running_sum += value;
+            running_squares += static_cast<double>(value) * value;
+        };
+
+        /**
+         * add a sample to a count-only series (`window_us` of 0)
+         *
+         * @param value the sample
+         */
+        void push(T value) { push(length ? times[position(length - 1)] : 0, value); };
+
+        /**
+         * drop samples that have aged out of the window without adding one
+         *
+         * useful when a signal stops updating but its window should keep moving (e.g. a sensor that's dropped out)
+         *
+         * @param now the current time, in microseconds
+         */
+        void expire(std::uint64_t now) {
+            if (!window_us) {
+                return;
+            }
+            while (length && now - times[first] > window_us) {
+                evict();
+            }
+        };
+
+        void clear() {
+            first = length = evictions = 0;
+            min_queue.clear();
+            max_queue.clear();
+            running_sum = 0;
+            running_squares = 0.0;
+        };
+
+        std::size_t size() const noexcept { return length; };
+
+        bool empty() const noexcept { return !length; };
+
+        bool full() const noexcept { return length == N; };
+
+        static constexpr std::size_t capacity() noexcept { return N; };
+
+        /**
+         * @param i sample index, 0 being the oldest in the window
+         * @return the sample
+         */
+        T operator[](std::size_t i) const noexcept { return values[position(i)]; };
+
+        /**
+         * @param i sample index, 0 being the oldest in the window
+         * @return the sample's timestamp, in microseconds
+         */
+        std::uint64_t time(std::size_t i) const noexcept { return times[position(i)]; };
+
+        /// newest sample; the series must not be empty
+        T latest() const noexcept { return values[position(length - 1)]; };
+
+        /// oldest sample in the window; the series must not be empty
+        T oldest() const noexcept { return values[first]; };
+
+        /// time between the oldest and newest samples, in microseconds
+        std::uint64_t span() const noexcept { return length ? times[position(length - 1)] - times[first] : 0; };
+
+        /// smallest sample in the window; the series must not be empty
+        T min() const noexcept { return values[min_queue.front()]; };
+
+        /// largest sample in the window; the series must not be empty
+        T max() const noexcept { return values[max_queue.front()]; };
+
+        sum_t sum() const noexcept { return running_sum; };
+
+        double mean() const noexcept { return length ? static_cast<double>(running_sum) / length : 0.0; };
+
+        /// population variance of the window
+        double variance() const noexcept {
+            if (!length) {
+                return 0.0;
+            }
+            auto m = mean();
+            auto v = running_squares / length - m * m;
+            return v > 0.0 ? v : 0.0;
+        };
+
+        double stddev() const noexcept { return std::sqrt(variance()); };
+    };
+
+    /**
+     * settled function that requires the error to have stayed within a band for a whole window
+     *
+     * satisfies `hotel::concepts::SettledFunction`, so it can be handed straight to a controller in place of the usual
+     * instantaneous check. the window has to fill before the controller is considered settled, which stops a controller
+     * that's just passing through the setpoint from finishing early.
+     *
+     * example:
+     * ```{.cpp}
+     * // settled once the error has been within 5 ticks for the last 20 iterations
+     * hotel::motor_position_controller<std::ratio<1, 2>, std::ratio<0, 1>, std::ratio<1, 100>> controller{
+     *     [&lift] { return lift.get_position(); },
+     *     hotel::settled_window<double, 20>{5.0},
+     *     600.0
+     * };
+     * ```
+     *
+     * @tparam T error type
+     * @tparam N number of consecutive samples the error has to stay within the band for
+     */
+    template <class T, std::size_t N>
+    class settled_window {
+        timeseries<T, N> errors;
+        T tolerance;
+    public:
+        /**
+         * @param tolerance largest absolute error that counts as settled
+         */
+        explicit settled_window(T tolerance) : tolerance(tolerance) {};
+
+        bool operator()(T error) {
+            errors.push(error);
+            return errors.full() && errors.max() <= tolerance && -errors.min() <= tolerance;
+        };
+    };
+
+    /**
+     * generator adaptor that yields a statistic of the trailing window after every value of another generator
+     *
+     * example:
+     * ```{.cpp}
+     * // 10-sample moving average of a controller's output
+     * for (auto output : hotel::windowed<10>(controller.run(), [] (const auto& w) { return w.mean(); })) {
+     *     motor.move(output);
+     * }
+     * ```
+     *
+     * @tparam N window size, in values
+     * @param source generator to read from
+     * @param statistic called with the `timeseries<T, N>` after each value; its result is yielded
+     */
+    template <std::size_t N, class T, class F>
+    coro::generator<std::invoke_result_t<F&, const timeseries<T, N>&>> windowed(coro::generator<T> source, F statistic) {
+        timeseries<T, N> window;
+        for (auto value : source) {
+            window.push(value);
+            co_yield statistic(window);
+        }
+    };
+
+    /**
+     * generator adaptor yielding the moving average of the last `N` values of another generator
+     */
+    template <std::size_t N, class T>
+    coro::generator<double> moving_mean(coro::generator<T> source) {
+        return windowed<N>(std::move(source), [] (const timeseries<T, N>& w) { return w.mean(); });
+    };
+
+    /**
+     * generator adaptor yielding the minimum of the last `N` values of another generator
+     */
+    template <std::size_t N, class T>
+    coro::generator<T> moving_min(coro::generator<T> source) {
+        return windowed<N>(std::move(source), [] (const timeseries<T, N>& w) { return w.min(); });
+    };
+
+    /**
+     * generator adaptor yielding the maximum of the last `N` values of another generator
+     */
+    template <std::size_t N, class T>
+    coro::generator<T> moving_max(coro::generator<T> source) {
+        return windowed<N>(std::move(source), [] (const timeseries<T, N>& w) { return w.max(); });
+    };
+}
+
+#endif // HOTEL_TIMESERIES_HPP
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <span>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/export.hpp"
+
+#ifndef HOTEL_TRAJECTORY_HPP
+#define HOTEL_TRAJECTORY_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * a point the path passes through, in inches
+     */
+    struct waypoint {
+        double x = 0.0;
+        double y = 0.0;
+    };
+
+    /**
+     * limits a trajectory is profiled against
+     */
+    struct trajectory_constraints {
+        /// top speed, in inches per second
+        double max_velocity = 60.0;
+        /// largest change of speed, in inches per second squared
+        double max_acceleration = 120.0;
+        /// largest centripetal acceleration, which sets how fast curves are taken, in inches per second squared
+        double max_lateral_acceleration = 80.0;
+        /// distance between samples along the path, in inches
+        double spacing = 0.5;
+    };
+
+    /**
+     * one point of a profiled trajectory
+     *
+     * headings are in radians, counter-clockwise from +x; curvature is positive turning left.
+     */
+    struct trajectory_sample {
+        float x;
+        float y;
+        float heading;
+        float curvature;
+        /// distance along the path, in inches
+        float distance;
+        /// target speed, in inches per second
+        float velocity;
+        /// time from the start, in seconds
+        float time;
+    };
+
+    namespace detail {
+        /// uniform Catmull-Rom segment between `p1` and `p2`, and its first and second derivatives
+        struct catmull_rom {
+            waypoint p0, p1, p2, p3;
+
+            static double blend(double a, double b, double c, double d, double t) {
+                return 0.5 * ((2.0 * b) + (-a + c) * t + (2.0 * a - 5.0 * b + 4.0 * c - d) * t * t +
+                              (-a + 3.0 * b - 3.0 * c + d) * t * t * t);
+            };
+
+            static double slope(double a, double b, double c, double d, double t) {
+                return 0.5 * ((-a + c) + 2.0 * (2.0 * a - 5.0 * b + 4.0 * c - d) * t +
+                              3.0 * (-a + 3.0 * b - 3.0 * c + d) * t * t);
+            };
+
+            static double bend(double a, double b, double c, double d, double t) {
+                return (2.0 * a - 5.0 * b + 4.0 * c - d) + 3.0 * (-a + 3.0 * b - 3.0 * c + d) * t;
+            };
+
+            waypoint at(double t) const {
+                return {blend(p0.x, p1.x, p2.x, p3.x, t), blend(p0.y, p1.y, p2.y, p3.y, t)};
+            };
+
+            waypoint d1(double t) const {
+                return {slope(p0.x, p1.x, p2.x, p3.x, t), slope(p0.y, p1.y, p2.y, p3.y, t)};
+            };
+
+            waypoint d2(double t) const {
+                return {bend(p0.x, p1.x, p2.x, p3.x, t), bend(p0.y, p1.y, p2.y, p3.y, t)};
+            };
+        };
+    }
+
+    /**
+     * generate a time-parameterized trajectory through a list of waypoints
+     *
+     * the path is a Catmull-Rom spline through every waypoint, resampled every `spacing` inches of arc length. each
+     * sample's speed is capped by `max_velocity` and by the curvature there (so the centripetal acceleration stays under
+     * `max_lateral_acceleration`), then a forward and a backward pass limit acceleration and deceleration so the
+     * trajectory starts and ends at rest.
+     *
+     * this is what `hotel::trajectory_cache` runs on a miss; it's also usable directly.
+     *
+     * example:
+     * ```{.cpp}
+     * std::array<hotel::waypoint, 3> points{{{0, 0}, {24, 24}, {48, 24}}};
+     * std::array<hotel::trajectory_sample, 256> samples;
+     * auto n = hotel::generate_trajectory(points, {}, samples);
+     * ```
+     *
+     * @param waypoints the points to pass through, in order
+     * @param constraints speed and acceleration limits, and sample spacing
+     * @param out where to write the samples; the path is cut short if it doesn't fit
+     * @return number of samples written, or 0 given fewer than two waypoints
+     */
+    inline std::size_t generate_trajectory(std::span<const waypoint> waypoints, const trajectory_constraints& constraints,
+                                           std::span<trajectory_sample> out) {
+        if (waypoints.size() < 2 || out.empty() || !(constraints.spacing > 0.0)) {
+            return 0;
+        }
+
+        // arc length is integrated over sub-steps, and a sample dropped wherever it crosses the next multiple of the
+        // spacing
+        constexpr int substeps = 256;
+        auto last = waypoints.size() - 1;
+        std::size_t n = 0;
+        double travelled = 0.0, next = 0.0;
+        auto emit = [&] (const detail::catmull_rom& seg, double t) {
+            auto p = seg.at(t), d = seg.d1(t), dd = seg.d2(t);
+            double speed = std::hypot(d.x, d.y);
+            double curvature = speed > 1e-9 ? (d.x * dd.y - d.y * dd.x) / (speed * speed * speed) : 0.0;
+            out[n++] = {static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(std::atan2(d.y, d.x)),
+                        static_cast<float>(curvature), static_cast<float>(next), 0.0f, 0.0f};
+            next += constraints.spacing;
+        };
+        for (std::size_t i = 0; i < last && n < out.size(); i++) {
+            detail::catmull_rom seg{waypoints[i ? i - 1 : 0], waypoints[i], waypoints[i + 1],
+                                    waypoints[std::min(i + 2, last)]};
+            auto previous = seg.at(0.0);
+            for (int k = 1; k <= substeps && n < out.size(); k++) {
+                double t = static_cast<double>(k) / substeps;
+                auto p = seg.at(t);
+                double step = std::hypot(p.x - previous.x, p.y - previous.y);
+                while (n < out.size() && travelled + step >= next) {
+                    double f = step > 0.0 ? (next - travelled) / step : 0.0;
+                    emit(seg, t - (1.0 - f) / substeps);
+                }
+                travelled += step;
+                previous = p;
+            }
+        }
+        if (n < out.size() && travelled > out[n - 1].distance + 1e-6) {
+            // the end of the path, which is rarely a whole number of spacings away
+            next = travelled;
+            detail::catmull_rom seg{waypoints[last > 1 ? last - 2 : 0], waypoints[last - 1], waypoints[last],
+                                    waypoints[last]};
+            emit(seg, 1.0);
+        }
+
+        // speed limits: the curve, then acceleration forwards from rest, then deceleration backwards to rest
+        for (std::size_t i = 0; i < n; i++) {
+            double k = std::fabs(out[i].curvature);
+            double limit = k > 1e-9 ? std::sqrt(constraints.max_lateral_acceleration / k) : constraints.max_velocity;
+            out[i].velocity = static_cast<float>(std::min(constraints.max_velocity, limit));
+        }
+        out[0].velocity = 0.0f;
+        out[n - 1].velocity = 0.0f;
+        for (std::size_t i = 1; i < n; i++) {
+            double d = out[i].distance - out[i - 1].distance;
+            double v = out[i - 1].velocity;
+            out[i].velocity = static_cast<float>(
+                std::min<double>(out[i].velocity, std::sqrt(v * v + 2.0 * constraints.max_acceleration * d)));
+        }
+        for (std::size_t i = n - 1; i > 0; i--) {
+            double d = out[i].distance - out[i - 1].distance;
+            double v = out[i].velocity;
+            out[i - 1].velocity = static_cast<float>(
+                std::min<double>(out[i - 1].velocity, std::sqrt(v * v + 2.0 * constraints.max_acceleration * d)));
+        }
+
+        // time, assuming the speed changes linearly between samples
+        for (std::size_t i = 1; i < n; i++) {
+            double d = out[i].distance - out[i - 1].distance;
+            double v = out[i].velocity + out[i - 1].velocity;
+            out[i].time = out[i - 1].time + static_cast<float>(v > 0.0 ? 2.0 * d / v : 0.0);
+        }
+        return n;
+    };
+}
+
+#endif // HOTEL_TRAJECTORY_HPP
@@ -0,0 +1,459 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <span>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "pros/rtos.hpp"
+
+#include "hotel/clock.hpp"
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/telemetry.hpp"
+#include "hotel/trajectory.hpp"
+
+#ifndef HOTEL_TRAJECTORY_CACHE_HPP
+#define HOTEL_TRAJECTORY_CACHE_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel {
+
+    /**
+     * profiled trajectories, stored on the SD card under a hash of what they were generated from
+     *
+     * paths that depend on runtime choices (the selected routine, a measured field offset) can't be generated at
+     * compile time, and generating them again on every boot costs time the robot could spend doing something else. this
+     * hashes the waypoints, the constraints and a version number into a 64-bit key, and keeps the samples generated
+     * from them in a file named after it:
+     *
+     * - on a hit, `request()` loads the file with a single read, straight into the slot the samples are served from
+     * - on a miss, the slot is left pending, and `service()` (run from `start()`'s task, or an `auton_preload` step)
+     *   generates the samples and writes them back for next time
+     *
+     * a file only counts as a hit if its header matches the full key and its checksum matches the samples, so a
+     * collision in the file name, a torn write or a stale file from an older `version` is just a miss.
+     *
+     * `request()` should only be called from one task, and `service()` from one (which may be a different one);
+     * `ready()`, `samples()` and `stats()` can be called from any.
+     *
+     * example:
+     * ```{.cpp}
+     * auto& cache = hotel::default_trajectory_cache();
+     * cache.start();
+     *
+     * // once the selector has settled
+     * std::array<hotel::waypoint, 3> points{{{0, 0}, {24, offset}, {48, offset}}};
+     * auto path = cache.request(points, {.max_velocity = 50.0});
+     *
+     * // in autonomous
+     * cache.wait(path, 500000);
+     * follow(cache.samples(path));
+     * ```
+     *
+     * @tparam MaxSamples largest number of samples in one trajectory
+     * @tparam MaxPaths number of trajectories held in memory at once
+     * @tparam MaxWaypoints largest number of waypoints in one request
+     * @tparam Clock clock used to time loads and generation
+     */
+    template <std::size_t MaxSamples = 512, std::size_t MaxPaths = 8, std::size_t MaxWaypoints = 16,
+              concepts::MicrosClock Clock = micros_clock>
+    class basic_trajectory_cache {
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        /// what to run on a miss; same signature as `hotel::generate_trajectory`
+        using generator_fn = std::function<std::size_t(std::span<const waypoint>, const trajectory_constraints&,
+                                                       std::span<trajectory_sample>)>;
+
+        struct options {
+            /// directory the files go in
+            const char* directory = "/usd";
+            /// folded into every key; bump it when the generator changes, so old files stop matching
+            std::uint32_t version = 1;
+            /// whether to write generated trajectories back to the card
+            bool write_back = true;
+        };
+
+        enum class status : std::uint8_t {
+            empty,
+            pending,
+            ready,
+            failed
+        };
+
+        struct statistics {
+            /// requests answered from a file
+            std::uint32_t hits = 0;
+            /// requests answered from a trajectory already in memory
+            std::uint32_t shared = 0;
+            /// requests that had to be generated
+            std::uint32_t misses = 0;
+            /// files that were there but didn't match (collision, stale version, torn write)
+            std::uint32_t rejected = 0;
+            std::uint32_t write_failures = 0;
+            /// time spent loading (and checking) hits, generating misses and writing them back, in microseconds
+            std::uint64_t load_us = 0;
+            std::uint64_t generate_us = 0;
+            std::uint64_t write_us = 0;
+            std::uint32_t longest_load_us = 0;
+            std::uint32_t longest_generate_us = 0;
+        };
+    private:
+        static constexpr std::uint32_t magic = 0x31435448; // "HTC1"
+
+        struct header {
+            std::uint32_t magic;
+            std::uint32_t count;
+            std::uint64_t key;
+            std::uint16_t sample_size;
+            std::uint16_t reserved;
+            std::uint32_t checksum;
+        };
+
+        /// exactly what's in a file, so a hit is one `fread` into it
+        struct blob {
+            header head;
+            std::array<trajectory_sample, MaxSamples> samples;
+        };
+
+        /// each counter is only ever written by one side (`request()` or `service()`), and read from anywhere
+        struct counters {
+            std::atomic<std::uint32_t> hits{0};
+            std::atomic<std::uint32_t> shared{0};
+            std::atomic<std::uint32_t> misses{0};
+            std::atomic<std::uint32_t> rejected{0};
+            std::atomic<std::uint32_t> write_failures{0};
+            std::atomic<std::uint64_t> load_us{0};
+            std::atomic<std::uint64_t> generate_us{0};
+            std::atomic<std::uint64_t> write_us{0};
+            std::atomic<std::uint32_t> longest_load_us{0};
+            std::atomic<std::uint32_t> longest_generate_us{0};
+        };
+
+        enum class worker_state : std::uint8_t {
+            idle,
+            running,
+            /// asked to stop, and finishing the `service()` call in progress
+            stopping
+        };
+
+        struct slot {
+            std::atomic<status> state{status::empty};
+            std::uint64_t key = 0;
+            std::array<waypoint, MaxWaypoints> waypoints{};
+            std::size_t waypoint_count = 0;
+            trajectory_constraints constraints{};
+            blob data{};
+        };
+
+        options opts;
+        generator_fn generator;
+        std::array<slot, MaxPaths> slots;
+        std::size_t used = 0;
+        counters stats_;
+        std::atomic<worker_state> worker{worker_state::idle};
+
+        template <class T>
+        static void add(std::atomic<T>& counter, T amount) { counter.fetch_add(amount, std::memory_order_relaxed); };
+
+        /// only for counters with a single writer
+        static void raise(std::atomic<std::uint32_t>& longest, std::uint32_t value) {
+            if (value > longest.load(std::memory_order_relaxed)) {
+                longest.store(value, std::memory_order_relaxed);
+            }
+        };
+
+        /// Fletcher-style sums over whole words: a CRC over a byte at a time costs more than the read it's checking
+        static std::uint32_t checksum(const trajectory_sample* samples, std::size_t n) {
+            static_assert(sizeof(trajectory_sample) % sizeof(std::uint32_t) == 0);
+            std::uint32_t a = 0, b = 0;
+            auto words = n * sizeof(trajectory_sample) / sizeof(std::uint32_t);
+            auto* bytes = reinterpret_cast<const std::uint8_t*>(samples);
+            for (std::size_t i = 0; i < words; i++) {
+                std::uint32_t w;
+                std::memcpy(&w, bytes + i * sizeof(w), sizeof(w));
+                a += w;
+                b += a;
+            }
+            return a ^ (b << 16 | b >> 16);
+        };
+
+        void path(std::uint64_t key, char* out, std::size_t size) const {
+            // FAT 8.3 names: 32 bits of the key in the name, all 64 in the header
+            std::snprintf(out, size, "%s/%08lx.trj", opts.directory,
+                          static_cast<unsigned long>(static_cast<std::uint32_t>(key ^ key >> 32)));
+        };
+
+        bool load(slot& s) {
+            char name[128];
+            path(s.key, name, sizeof(name));
+            auto start = Clock::now();
+            auto* f = std::fopen(name, "rb");
+            if (!f) {
+                return false;
+            }
+            auto bytes = std::fread(&s.data, 1, sizeof(s.data), f);
+            std::fclose(f);
+
+            const auto& h = s.data.head;
+            bool ok = bytes >= sizeof(header) && h.magic == magic && h.key == s.key &&
+                      h.sample_size == sizeof(trajectory_sample) && h.count > 0 && h.count <= MaxSamples &&
+                      bytes == sizeof(header) + h.count * sizeof(trajectory_sample) &&
+                      h.checksum == checksum(s.data.samples.data(), h.count);
+            auto elapsed = static_cast<std::uint32_t>(Clock::now() - start);
+            if (!ok) {
+                add(stats_.rejected, 1u);
+                return false;
+            }
+            add(stats_.load_us, std::uint64_t{elapsed});
+            raise(stats_.longest_load_us, elapsed);
+            return true;
+        };
+
+        bool write(const slot& s) {
+            char name[128];
+            path(s.key, name, sizeof(name));
+            auto* f = std::fopen(name, "wb");
+            if (!f) {
+                return false;
+            }
+            auto bytes = sizeof(header) + s.data.head.count * sizeof(trajectory_sample);
+            bool ok = std::fwrite(&s.data, 1, bytes, f) == bytes;
+            return std::fclose(f) == 0 && ok;
+        };
+    public:
+        /**
+         * @param o where files go, and the key version
+         * @param g generator to run on a miss
+         */
+        explicit basic_trajectory_cache(options o = {}, generator_fn g = generate_trajectory) :
+            opts(o), generator(std::move(g)) {};
+
+        basic_trajectory_cache(const basic_trajectory_cache&) = delete;
+
+        basic_trajectory_cache& operator=(const basic_trajectory_cache&) = delete;
+
+        /// stops `start()`'s task first, if it's running
+        ~basic_trajectory_cache() { stop(); };
+
+        /**
+         * hash a request the way the cache keys it
+         *
+         * FNV-1a over the version, the waypoint count, the waypoints and the constraints
+         */
+        static std::uint64_t key(std::span<const waypoint> waypoints, const trajectory_constraints& constraints,
+                                 std::uint32_t version) {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            auto mix = [&h] (const void* data, std::size_t n) {
+                auto* bytes = static_cast<const std::uint8_t*>(data);
+                for (std::size_t i = 0; i < n; i++) {
+                    h = (h ^ bytes[i]) * 0x100000001b3ull;
+                }
+            };
+            std::uint32_t count = static_cast<std::uint32_t>(waypoints.size());
+            mix(&version, sizeof(version));
+            mix(&count, sizeof(count));
+            mix(waypoints.data(), waypoints.size_bytes());
+            mix(&constraints, sizeof(constraints));
+            return h;
+        };
+
+        /**
+         * get a trajectory, from memory, the card, or (later) the generator
+         *
+         * a hit on the card is loaded before this returns; a miss returns a pending handle right away
+         *
+         * @param waypoints the points to pass through
+         * @param constraints speed and acceleration limits, and sample spacing
+         * @return a handle for `samples()`, or `npos` if every slot is taken or there are too many waypoints
+         */
+        std::size_t request(std::span<const waypoint> waypoints, const trajectory_constraints& constraints) {
+            if (waypoints.size() > MaxWaypoints) {
+                return npos;
+            }
+            auto k = key(waypoints, constraints, opts.version);
+            for (std::size_t i = 0; i < used; i++) {
+                if (slots[i].key == k) {
+                    add(stats_.shared, 1u);
+                    return i;
+                }
+            }
+            if (used == MaxPaths) {
+                return npos;
+            }
+
+            auto& s = slots[used];
+            s.key = k;
+            std::copy(waypoints.begin(), waypoints.end(), s.waypoints.begin());
+            s.waypoint_count = waypoints.size();
+            s.constraints = constraints;
+            if (load(s)) {
+                add(stats_.hits, 1u);
+                s.state.store(status::ready, std::memory_order_release);
+            } else {
+                add(stats_.misses, 1u);
+                s.state.store(status::pending, std::memory_order_release);
+            }
+            return used++;
+        };
+
+        /**
+         * generate (and write back) one pending trajectory
+         *
+         * @return `true` if nothing is left pending
+         */
+        bool service() {
+            for (std::size_t i = 0; i < MaxPaths; i++) {
+                auto& s = slots[i];
+                if (s.state.load(std::memory_order_acquire) != status::pending) {
+                    continue;
+                }
+
+                auto start = Clock::now();
+                auto n = generator(std::span<const waypoint>{s.waypoints.data(), s.waypoint_count}, s.constraints,
+                                   s.data.samples);
+                auto elapsed = static_cast<std::uint32_t>(Clock::now() - start);
+                add(stats_.generate_us, std::uint64_t{elapsed});
+                raise(stats_.longest_generate_us, elapsed);
+                if (n == 0 || n > MaxSamples) {
+                    s.state.store(status::failed, std::memory_order_release);
+                    return false;
+                }
+
+                s.data.head = {magic, static_cast<std::uint32_t>(n), s.key, sizeof(trajectory_sample), 0,
+                               checksum(s.data.samples.data(), n)};
+                s.state.store(status::ready, std::memory_order_release);
+
+                if (opts.write_back) {
+                    start = Clock::now();
+                    if (!write(s)) {
+                        add(stats_.write_failures, 1u);
+                    }
+                    add(stats_.write_us, Clock::now() - start);
+                }
+                return false;
+            }
+            return true;
+        };
+
+        /**
+         * run `service()` from a new task until `stop()`, or until the cache is destroyed
+         *
+         * @param prio task priority; below anything time-critical, since generating can take a while
+         * @param idle_ms how long to sleep when nothing is pending
+         * @return `false` if the task was already running (it's left as it was, but not stopped if it was stopping)
+         */
+        bool start(std::uint32_t prio = TASK_PRIORITY_DEFAULT - 1, std::uint32_t idle_ms = 20) {
+            auto expected = worker_state::stopping;
+            if (worker.compare_exchange_strong(expected, worker_state::running, std::memory_order_acq_rel)) {
+                return false;
+            }
+            if (expected == worker_state::running) {
+                return false;
+            }
+            worker.store(worker_state::running, std::memory_order_release);
+            pros::Task{[this, idle_ms] {
+                while (true) {
+                    auto state = worker_state::stopping;
+                    if (worker.compare_exchange_strong(state, worker_state::idle, std::memory_order_acq_rel)) {
+                        return;
+                    }
+                    if (service()) {
+                        pros::delay(idle_ms);
+                    }
+                }
+            }, prio, TASK_STACK_DEPTH_DEFAULT, "trajectory_cache"};
+            return true;
+        };
+
+        /**
+         * stop `start()`'s task, waiting for the trajectory it's generating (if any) to be finished and written
+         *
+         * does nothing if the task isn't running.
+         */
+        void stop() {
+            auto expected = worker_state::running;
+            worker.compare_exchange_strong(expected, worker_state::stopping, std::memory_order_acq_rel);
+            while (worker.load(std::memory_order_acquire) != worker_state::idle) {
+                Clock::wait_until(Clock::now() + 1000);
+            }
+        };
+
+        status state(std::size_t handle) const {
+            return handle < MaxPaths ? slots[handle].state.load(std::memory_order_acquire) : status::empty;
+        };
+
+        bool ready(std::size_t handle) const { return state(handle) == status::ready; };
+
+        /**
+         * block until a trajectory is ready
+         *
+         * @param handle what `request()` returned
+         * @param timeout_us how long to wait, in microseconds
+         * @return whether it's ready
+         */
+        bool wait(std::size_t handle, std::uint64_t timeout_us) const {
+            auto deadline = Clock::now() + timeout_us;
+            while (state(handle) == status::pending && Clock::now() < deadline) {
+                Clock::wait_until(std::min(Clock::now() + 1000, deadline));
+            }
+            return ready(handle);
+        };
+
+        /**
+         * @return the samples, or nothing if the trajectory isn't ready
+         */
+        std::span<const trajectory_sample> samples(std::size_t handle) const {
+            if (!ready(handle)) {
+                return {};
+            }
+            const auto& d = slots[handle].data;
+            return {d.samples.data(), d.head.count};
+        };
+
+        /**
+         * @return a snapshot of the counters
+         */
+        statistics stats() const {
+            auto get = [] (const auto& counter) { return counter.load(std::memory_order_relaxed); };
+            return {get(stats_.hits), get(stats_.shared), get(stats_.misses), get(stats_.rejected),
+                    get(stats_.write_failures), get(stats_.load_us), get(stats_.generate_us), get(stats_.write_us),
+                    get(stats_.longest_load_us), get(stats_.longest_generate_us)};
+        };
+
+        /**
+         * write the cache's counters as a `trajectory_cache` telemetry record
+         *
+         * fields are: hits, shared, misses, rejected, write failures, mean and longest load time, mean and longest
+         * generation time, total write time (times in microseconds)
+         *
+         * @param out stream to write to
+         */
+        void report(std::FILE* out) const {
+            auto s = stats();
+            auto generated = s.misses ? s.misses : 1u;
+            telemetry::write(out, "trajectory_cache", s.hits, s.shared, s.misses, s.rejected, s.write_failures,
+                             s.hits ? s.load_us / s.hits : 0ull, s.longest_load_us, s.generate_us / generated,
+                             s.longest_generate_us, s.write_us);
+        };
+    };
+
+    /**
+     * the trajectory cache used by default throughout libhotel
+     */
+    using trajectory_cache = basic_trajectory_cache<>;
+
+    /**
+     * @return the shared trajectory cache, keeping its files in `/usd`
+     */
+    inline trajectory_cache& default_trajectory_cache() {
+        static trajectory_cache instance;
+        return instance;
+    };
+}
+
+#endif // HOTEL_TRAJECTORY_CACHE_HPP
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <array>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hotel/concepts.hpp"
+#include "hotel/export.hpp"
+#include "hotel/pid.hpp"
+
+#ifndef HOTEL_VERIFY_HPP
+#define HOTEL_VERIFY_HPP
+
+HOTEL_MODULE_EXPORT namespace hotel::verify {
+
+    namespace detail {
+        /// @f$e^x@f$ for the plant discretizations; `std::exp` isn't usable in constant expressions before C++26
+        constexpr double exp(double x) {
+            // halve until small, sum the series, then square back up
+            int halvings = 0;
+            while (x > 0.5 || x < -0.5) {
+                x /= 2.0;
+                halvings++;
+            }
+            double term = 1.0, sum = 1.0;
+            for (int n = 1; n < 16; n++) {
+                term *= x / n;
+                sum += term;
+            }
+            while (halvings--) {
+                sum *= sum;
+            }
+            return sum;
+        };
+
+        constexpr double abs(double x) { return x < 0.0 ? -x : x; };
+
+        /// fixed-length delay line, for dead time measured in ticks
+        template <std::size_t N>
+        struct delay_line {
+            std::array<double, N + 1> values{};
+            std::size_t length = 0;
+            std::size_t head = 0;
+
+            /// push `u`, get back what was pushed `length` calls ago (0 until then)
+            constexpr double shift(double u) {
+                values[head] = u;
+                head = (head + 1) % (length + 1);
+                return values[head];
+            };
+        };
+
+        constexpr std::size_t ticks(std::uint32_t dead_time_us, std::uint32_t period_ms) {
+            std::uint32_t period_us = period_ms * 1000u;
+            return period_us ? (dead_time_us + period_us - 1) / period_us : 0;
+        };
+    }
+
+    /**
+     * plant parameters; the same meaning as `hotel::sim::first_order_plant::parameters`
+     */
+    struct plant_parameters {
+        /// steady-state gain from command to rate (or, for `first_order_plant`, to output)
+        double gain = 1.0;
+        /// time constant, in seconds
+        double time_constant = 0.05;
+        /// pure delay between a command and the plant starting to respond, in microseconds (rounded up to whole ticks)
+        std::uint32_t dead_time_us = 0;
+    };
+
+    /**
+     * first-order plant with dead time, discretized exactly under a zero-order hold
+     *
+     * @f$y_{k+1} = a y_k + (1 - a) K u_{k-d}@f$ with @f$a = e^{-T/\tau}@f$: a V5 motor's velocity against its command.
+     *
+     * @tparam MaxDelay largest dead time it can represent, in ticks
+     */
+    template <std::size_t MaxDelay = 16>
+    class first_order_plant {
+        plant_parameters params;
+        double a = 0.0;
+        double y = 0.0;
+        detail::delay_line<MaxDelay> delay;
+    public:
+        constexpr explicit first_order_plant(plant_parameters p) : params(p) {};
+
+        /**
+         * reset to rest at `initial`, for steps of `period_ms`
+         */
+        constexpr void start(double initial, std::uint32_t period_ms) {
+            a = params.time_constant > 0.0 ? detail::exp(-(period_ms * 1e-3) / params.time_constant) : 0.0;
+            y = initial;
+            delay = {};
+            delay.length = std::min(detail::ticks(params.dead_time_us, period_ms), MaxDelay);
+        };
+
+        /**
+         * hold `u` for one period
+         *
+         * @return the output at the end of the period
+         */
+        constexpr double step(double u) {
+            y = a * y + (1.0 - a) * params.gain * delay.shift(u);
+            return y;
+        };
+
+        constexpr double output() const { return y; };
+    };
+
+    /**
+     * first-order rate integrated into a position, with dead time
+     *
+     * the velocity responds as in `first_order_plant`, and the output is its exact integral over each period: a V5
+     * motor's encoder position against its command, or a lift's height.
+     *
+     * @tparam MaxDelay largest dead time it can represent, in ticks
+     */
+    template <std::size_t MaxDelay = 16>
+    class integrating_plant {
+        plant_parameters params;
+        double a = 0.0;
+        double T = 0.0;
+        double v = 0.0;
+        double x = 0.0;
+        detail::delay_line<MaxDelay> delay;
+    public:
+        constexpr explicit integrating_plant(plant_parameters p) : params(p) {};
+
+        constexpr void start(double initial, std::uint32_t period_ms) {
+            T = period_ms * 1e-3;
+            a = params.time_constant > 0.0 ? detail::exp(-T / params.time_constant) : 0.0;
+            v = 0.0;
+            x = initial;
+            delay = {};
+            delay.length = std::min(detail::ticks(params.dead_time_us, period_ms), MaxDelay);
+        };
+
+        constexpr double step(double u) {
+            double target = params.gain * delay.shift(u);
+            // integral of target + (v - target) e^{-t/tau} over the period
+            x += target * T + (v - target) * params.time_constant * (1.0 - a);
+            v = a * v + (1.0 - a) * target;
+            return x;
+        };
+
+        constexpr double output() const { return x; };
+    };
+
+    /**
+     * the closed loop to simulate
+     */
+    struct scenario {
+        /// output the plant starts at, at rest
+        double initial = 0.0;
+        /// target it's commanded to
+        double setpoint = 0.0;
+        /// controller period, in milliseconds; `pid_controller` sees this as its @f$dT@f$
+        std::uint32_t period_ms = 10;
+        /// number of periods to simulate
+        std::uint32_t ticks = 300;
+        /// half-width of the band around the setpoint that counts as settled
+        double tolerance = 1.0;
+        /// commands are clamped to this magnitude (127 for `pros::Motor::move`)
+        double output_limit = 127.0;
+        /// output magnitude past which the loop is taken to have diverged
+        double divergence = 1e9;
+    };
+
+    /**
+     * how a simulated step went
+     */
+    struct step_response {
+        /// period after which the output stayed within tolerance until the end; `ticks` if it never did
+        std::uint32_t settling_ticks = 0;
+        /// how far the output went past the setpoint, as a fraction of the step
+        double overshoot = 0.0;
+        /// distance from the setpoint at the end
+        double final_error = 0.0;
+        /// largest error over the last quarter of the run, and over the quarter before it
+        double late_error = 0.0;
+        double earlier_error = 0.0;
+        /// `false` if the output ran past `divergence`
+        bool bounded = true;
+        std::uint32_t ticks = 0;
+
+        constexpr bool settles_within(std::uint32_t n) const { return bounded && settling_ticks <= n; };
+
+        constexpr bool overshoot_below(double fraction) const { return bounded && overshoot < fraction; };
+
+        /**
+         * @return `true` if the output stayed bounded and the error isn't growing by the end of the run (a sustained
+         *         oscillation of constant amplitude counts as stable, but won't settle)
+         */
+        constexpr bool stable() const { return bounded && late_error <= earlier_error * 1.001 + 1e-9; };
+    };
+
+    /**
+     * run `pid_controller`'s law against a plant model for a step in setpoint, at compile time
+     *
+     * meant to be evaluated inside a `static_assert`, so gains that don't settle, overshoot too far or diverge on the
+     * nominal model stop the build instead of the robot; nothing is left behind in the binary.
+     *
+     * each period does what `pid_controller::run()` does: the plant's output is read as a `target_t`, the error is
+     * taken and accumulated in `target_t`, `hotel::pid_law` is evaluated on them with @f$dT@f$ being the period in
+     * milliseconds (also as a `target_t`, so an integer controller's derivative term divides as an integer, the same
+     * way it does on the robot), and the result is converted to `output_t`. the command is then
+     * clamped to `output_limit` (as the motor would) and held on the plant for the period. the controller's own settled
+     * function isn't modeled: it runs for the whole scenario.
+     *
+     * example:
+     * ```{.cpp}
+     * // a 200rpm motor's position in degrees: ~9.4 deg/s per unit of `move()`, 80ms time constant, 10ms of latency
+     * constexpr hotel::verify::integrating_plant<> lift{{.gain = 9.4, .time_constant = 0.08, .dead_time_us = 10000}};
+     * constexpr auto response = hotel::verify::simulate<std::ratio<1, 2>, std::ratio<0>, std::ratio<0>>(
+     *     lift, {.setpoint = 360.0, .tolerance = 5.0});
+     *
+     * static_assert(response.stable());
+     * static_assert(response.settles_within(100));
+     * static_assert(response.overshoot_below(0.05));
+     * ```
+     *
+     * @tparam Kp_t `std::ratio` representing the proportional gain
+     * @tparam Ki_t `std::ratio` representing the integral gain
+     * @tparam Kd_t `std::ratio` representing the derivative gain
+     * @tparam output_t the controller's output type (`std::int32_t` for the motor controllers, which truncates)
+     * @tparam target_t the controller's setpoint type (what its feedback function returns, e.g. `std::int32_t` for
+     *                  `hotel::motor_torque_controller`)
+     * @tparam Plant plant model, e.g. `first_order_plant` or `integrating_plant`
+     * @param plant the nominal plant
+     * @param s the step to simulate
+     * @return the step response
+     */
+    template <concepts::Ratio Kp_t, concepts::Ratio Ki_t, concepts::Ratio Kd_t, class output_t = std::int32_t,
+              class target_t = double, class Plant>
+    constexpr step_response simulate(Plant plant, scenario s) {
+        using law = pid_law<Kp_t, Ki_t, Kd_t>;
+        step_response r{.settling_ticks = s.ticks, .ticks = s.ticks};
+        plant.start(s.initial, s.period_ms);
+
+        double step = s.setpoint - s.initial;
+        double direction = step < 0.0 ? -1.0 : 1.0;
+        auto dT = static_cast<target_t>(s.period_ms);
+        target_t accumulator{0}, last_error{0};
+        double y = s.initial;
+        bool inside = false;
+        for (std::uint32_t k = 0; k < s.ticks; k++) {
+            target_t error = static_cast<target_t>(s.setpoint) - static_cast<target_t>(y);
+            accumulator += error;
+            double u = static_cast<double>(static_cast<output_t>(law::output(error, accumulator, last_error, dT)));
+            last_error = error;
+            y = plant.step(std::clamp(u, -s.output_limit, s.output_limit));
+
+            if (detail::abs(y) > s.divergence) {
+                r.bounded = false;
+                r.settling_ticks = s.ticks;
+                r.final_error = detail::abs(s.setpoint - y);
+                return r;
+            }
+
+            double e = detail::abs(s.setpoint - y);
+            if (e > s.tolerance) {
+                inside = false;
+            } else if (!inside) {
+                inside = true;
+                r.settling_ticks = k + 1;
+            }
+            if (step != 0.0) {
+                r.overshoot = std::max(r.overshoot, (y - s.setpoint) * direction / detail::abs(step));
+            }
+            if (k >= s.ticks - s.ticks / 4) {
+                r.late_error = std::max(r.late_error, e);
+            } else if (k >= s.ticks - s.ticks / 2) {
+                r.earlier_error = std::max(r.earlier_error, e);
+            }
+        }
+        if (!inside) {
+            r.settling_ticks = s.ticks;
+        }
+        r.final_error = detail::abs(s.setpoint - y);
+        return r;
+    };
+}
+
+#endif // HOTEL_VERIFY_HPP
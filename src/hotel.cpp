@@ -1,2 +1,55 @@
+#include "hotel/auton_checkpoint.hpp"
+#include "hotel/auton_preload.hpp"
+#include "hotel/controller_registry.hpp"
 #include "hotel/coro/generator.hpp"
+#include "hotel/coro/introspection.hpp"
+#include "hotel/coro/task.hpp"
+#include "hotel/disturbance_observer.hpp"
+#include "hotel/feedforward.hpp"
+#include "hotel/field_index.hpp"
+#include "hotel/flywheel.hpp"
+#include "hotel/governor.hpp"
+#include "hotel/idle_wake.hpp"
+#include "hotel/imu_pipeline.hpp"
+#include "hotel/latency_probe.hpp"
+#include "hotel/least_squares.hpp"
+#include "hotel/link_mux.hpp"
+#include "hotel/log/columnar.hpp"
+#include "hotel/odometry_calibration.hpp"
 #include "hotel/pid.hpp"
+#include "hotel/profiler.hpp"
+#include "hotel/quaternion.hpp"
+#include "hotel/schedulability.hpp"
+#include "hotel/self_tuning.hpp"
+#include "hotel/serial_stream.hpp"
+#include "hotel/stack_audit.hpp"
+#include "hotel/state_sync.hpp"
+#include "hotel/timeseries.hpp"
+#include "hotel/trajectory.hpp"
+#include "hotel/trajectory_cache.hpp"
+#include "hotel/verify.hpp"
+
+// `verify::simulate` is only ever run by the compiler, so it's checked here, on every build, against loops whose
+// outcome is known: the example from hotel/verify.hpp, and the same plant with the gain turned up until it oscillates
+namespace {
+    namespace verify = hotel::verify;
+
+    constexpr verify::integrating_plant<> lift{{.gain = 9.4, .time_constant = 0.08, .dead_time_us = 10000}};
+
+    constexpr auto nominal = verify::simulate<std::ratio<1, 2>, std::ratio<0>, std::ratio<0>>(
+        lift, {.setpoint = 360.0, .tolerance = 5.0});
+    static_assert(nominal.stable());
+    static_assert(nominal.settles_within(100));
+    static_assert(nominal.overshoot_below(0.05));
+
+    // twenty times the gain against the same 10ms of dead time: the oscillation grows without bound...
+    constexpr auto too_hot = verify::simulate<std::ratio<10>, std::ratio<0>, std::ratio<0>>(
+        lift, {.setpoint = 360.0, .tolerance = 5.0, .output_limit = 1e9});
+    static_assert(!too_hot.stable());
+
+    // ...until the motor's output limit caps it, which leaves a steady oscillation that's bounded but never settles
+    constexpr auto limited = verify::simulate<std::ratio<10>, std::ratio<0>, std::ratio<0>>(
+        lift, {.setpoint = 360.0, .tolerance = 5.0});
+    static_assert(limited.stable());
+    static_assert(limited.settling_ticks == limited.ticks);
+}
@@ -1,5 +1,32 @@
 #include "main.h"
+
+#ifdef HOTEL_USE_MODULES
+import hotel;
+#else
+#include "hotel/auton_checkpoint.hpp"
+#include "hotel/auton_preload.hpp"
 #include "hotel/pid.hpp"
+#endif
+
+pros::Motor lift{2};
+
+struct auton_state {
+    double lift;
+};
+
+// kept outside the autonomous task, so a restart after dropped comms resumes at the step it was cut off in
+static hotel::resumable_auton<auton_state> auton{[] { return auton_state{lift.get_position()}; }};
+
+/**
+ * Moves the lift to an absolute position and waits until it gets there, so
+ * rerunning it after a restart picks up from wherever the lift ended up.
+ */
+void lift_to(double position) {
+    lift.move_absolute(position, 100);
+    while (std::fabs(lift.get_position() - position) > 5) {
+        pros::delay(10);
+    }
+}
 
 /**
  * A callback function for LLEMU's center button.
@@ -28,6 +55,14 @@ void initialize() {
 	pros::lcd::set_text(1, "Hello PROS User!");
 
 	pros::lcd::register_btn1_cb(on_center_button);
+
+    hotel::default_auton_preload().add_routine("lift", [] {
+        auton.begin();
+        hotel::default_auton_preload().first_command();
+        auton.step([] { lift_to(600); });
+        auton.step([] { pros::delay(500); });
+        auton.step([] { lift_to(0); });
+    });
 }
 
 /**
@@ -35,7 +70,9 @@ void initialize() {
  * the VEX Competition Switch, following either autonomous or opcontrol. When
  * the robot is enabled, this task will exit.
  */
-void disabled() {}
+void disabled() {
+    hotel::default_auton_preload().start();
+}
 
 /**
  * Runs after initialize(), and before autonomous when connected to the Field
@@ -46,7 +83,10 @@ void disabled() {}
  * This task will exit when the robot is enabled and autonomous or opcontrol
  * starts.
  */
-void competition_initialize() {}
+void competition_initialize() {
+    // trajectories, tables and the like for the selected routine are built from here rather than in autonomous()
+    hotel::default_auton_preload().start();
+}
 
 /**
  * Runs the user autonomous code. This function will be started in its own task
@@ -59,7 +99,9 @@ void competition_initialize() {}
  * will be stopped. Re-enabling the robot will restart the task, not re-start it
  * from where it left off.
  */
-void autonomous() {}
+void autonomous() {
+    hotel::default_auton_preload().run();
+}
 
 /**
  * Runs the operator control code. This function will be started in its own task
@@ -75,6 +117,11 @@ void autonomous() {}
  * task, not resume it from where it left off.
  */
 [[noreturn]] void opcontrol() {
+    // autonomous() stops preparation itself, but driver control can start without it
+    hotel::default_auton_preload().stop();
+    // autonomous is over, so the next one starts from its first step
+    auton.reset();
+
 	pros::Motor motor{1};
 
     hotel::motor_position_controller<std::ratio<1, 2>, std::ratio<0, 1>, std::ratio<1, 100>> motor_controller{
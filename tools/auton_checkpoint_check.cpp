@@ -0,0 +1,163 @@
+/**
+ * @file auton_checkpoint_check.cpp
+ *
+ * host-side check that `hotel::resumable_auton` (see hotel/auton_checkpoint.hpp) resumes a routine whose task was
+ * deleted partway through
+ *
+ * a five-step routine runs on `hotel::sim::virtual_clock`, each step taking a second and moving a stand-in robot to an
+ * absolute position. deleting the autonomous task is stood in for by throwing out of the routine: like a deletion, that
+ * abandons `step()` or the checkpoint in progress without anything in the object being cleaned up after it, and the
+ * routine is then started again from the top, as re-enabling would. the routine is cut off in the middle of a step, in
+ * the middle of the capture a checkpoint is taken with (after the spare slot has been half written), twice in one run,
+ * and once more after the resume window has closed.
+ *
+ * for every case the steps each invocation actually ran are compared with the ones it should have (the completed ones
+ * skipped, the interrupted one run again from scratch), along with `skipped()`, `restarts()`, whether `begin()`
+ * resumed, and the checkpoint `last()` holds after the interruption, which has to be exactly the one published before
+ * it. exits with a non-zero status if any of them is off.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/auton_checkpoint_check
+ * ```
+ */
+#include <string>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "hotel/auton_checkpoint.hpp"
+#include "hotel/sim/plant.hpp"
+
+namespace {
+    using sim_clock = hotel::sim::virtual_clock;
+
+    struct robot_state {
+        /// last step completed, counting from 1
+        std::uint32_t step;
+        float x;
+    };
+
+    using auton_t = hotel::resumable_auton<robot_state, sim_clock>;
+
+    constexpr std::uint32_t step_count = 5;
+
+    /// stands in for the autonomous task being deleted
+    struct task_deleted {};
+
+    robot_state robot{};
+
+    /// throw from inside this step's body, or from the capture of the checkpoint after it; `step_count` for never
+    std::uint32_t fail_in_step = step_count;
+    std::uint32_t fail_in_save = step_count;
+    bool fail_next_capture = false;
+
+    auton_t auton{[] {
+        if (fail_next_capture) {
+            fail_next_capture = false;
+            throw task_deleted{};
+        }
+        return robot;
+    }};
+
+    /// the checkpoint published when the most recent step body started
+    auton_t::checkpoint published{};
+
+    /// the routine: returns the steps whose bodies ran, as digits, with a `!` where it was cut off
+    std::string routine(bool& resumed) {
+        std::string ran;
+        resumed = auton.begin();
+        try {
+            for (std::uint32_t i = 0; i < step_count; i++) {
+                auton.step([&] {
+                    published = auton.last();
+                    ran += static_cast<char>('0' + i);
+                    sim_clock::advance(500000);
+                    if (i == fail_in_step) {
+                        fail_in_step = step_count;
+                        throw task_deleted{};
+                    }
+                    sim_clock::advance(500000);
+                    robot = {i + 1, 10.0f * static_cast<float>(i + 1)};
+                    if (i == fail_in_save) {
+                        fail_in_save = step_count;
+                        fail_next_capture = true;
+                    }
+                });
+            }
+        } catch (const task_deleted&) {
+            ran += '!';
+        }
+        return ran;
+    }
+
+    struct invocation {
+        /// step bodies it should run
+        const char* ran;
+        bool resumed;
+        /// how long the robot sits disabled before it's started again, in microseconds
+        std::uint64_t gap_us = 1000000;
+    };
+
+    struct scenario {
+        const char* name;
+        std::uint32_t fail_in_step;
+        std::uint32_t fail_in_save;
+        std::vector<invocation> invocations;
+        std::uint32_t restarts;
+        std::uint32_t skipped;
+    };
+
+    bool run(const scenario& s) {
+        sim_clock::reset(5000000);
+        auton.reset();
+        robot = {};
+        fail_in_step = s.fail_in_step;
+        fail_in_save = s.fail_in_save;
+        fail_next_capture = false;
+
+        bool ok = true;
+        std::string got;
+        for (const auto& expected : s.invocations) {
+            bool resumed;
+            auto ran = routine(resumed);
+            got += (got.empty() ? "" : " ") + ran;
+            ok = ok && ran == expected.ran && resumed == expected.resumed;
+            if (ran.back() == '!') {
+                // neither a step nor a checkpoint that was cut off can have touched the one published before it
+                const auto& c = auton.last();
+                ok = ok && std::memcmp(&c, &published, sizeof(c)) == 0 && c.state.step == c.completed &&
+                     c.state.x == 10.0f * static_cast<float>(c.completed);
+            }
+            sim_clock::advance(expected.gap_us);
+        }
+
+        const auto& c = auton.last();
+        ok = ok && auton.restarts() == s.restarts && auton.skipped() == s.skipped && c.completed == step_count &&
+             c.state.step == step_count && c.state.x == 10.0f * step_count;
+        std::printf("%-26s %-20s %8u %8u %9u  %s\n", s.name, got.c_str(), auton.restarts(), auton.skipped(),
+                    c.completed, ok ? "ok" : "FAIL");
+        return ok;
+    }
+}
+
+int main() {
+    const scenario scenarios[] = {
+        {"uninterrupted", step_count, step_count, {{"01234", false}}, 0, 0},
+        {"deleted in step 2", 2, step_count, {{"012!", false}, {"234", true}}, 1, 2},
+        {"deleted in step 0", 0, step_count, {{"0!", false}, {"01234", true}}, 1, 0},
+        {"deleted in checkpoint 3", step_count, 3, {{"0123!", false}, {"34", true}}, 1, 3},
+        {"deleted in checkpoint 0", step_count, 0, {{"0!", false}, {"01234", true}}, 1, 0},
+        {"deleted twice", 1, 3, {{"01!", false}, {"123!", true}, {"34", true}}, 2, 1 + 3},
+        {"window closed", 2, step_count, {{"012!", false, 20000000}, {"01234", false}}, 0, 0},
+    };
+
+    int failures = 0;
+    std::printf("%-26s %-20s %8s %8s %9s\n", "scenario", "steps run", "restarts", "skipped", "completed");
+    for (const auto& s : scenarios) {
+        failures += !run(s);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file coro_stats_check.cpp
+ *
+ * host-side check of the generator frame statistics in hotel/coro/introspection.hpp
+ *
+ * this is built with `HOTEL_CORO_STATS` defined (it defines it itself, ahead of every include), so every generator in
+ * it records into `hotel::coro::default_frame_stats()`. a simple counter has five frames kept alive while 101 more are
+ * created, run to the end and destroyed one at a time, which has to come out as 106 created, 101 destroyed, 5 live and
+ * a peak of 6, with 4 resumes per completed frame (the first value, then two more, then the end). a template generator
+ * instantiated for two types has to show up as two sites, and a generator reading from another one has to count the
+ * resumes of both.
+ *
+ * without `HOTEL_CORO_STATS` the hook is compiled out, and hotel/coro/generator.hpp checks at compile time that the
+ * promise is no bigger than its own members; every other build of the library covers that half.
+ *
+ * reported are the `coro` telemetry records (see `basic_frame_stats::report`), then each check. exits with a non-zero
+ * status if any of them fails.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/coro_stats_check
+ * ```
+ */
+#define HOTEL_CORO_STATS
+
+#include <chrono>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "hotel/coro/generator.hpp"
+#include "hotel/coro/introspection.hpp"
+
+std::uint64_t pros::c::micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+namespace {
+    using site_t = hotel::coro::frame_stats::site_t;
+
+    hotel::coro::generator<int> counter(int n) {
+        for (int i = 0; i < n; i++) {
+            co_yield i;
+        }
+    }
+
+    template <class T>
+    hotel::coro::generator<T> scaled(T k, int n) {
+        for (int i = 0; i < n; i++) {
+            co_yield k * static_cast<T>(i);
+        }
+    }
+
+    hotel::coro::generator<int> ramp(int n) {
+        for (int i = 0; i < n; i++) {
+            co_yield i;
+        }
+    }
+
+    hotel::coro::generator<int> running_sum(hotel::coro::generator<int> source) {
+        int sum = 0;
+        for (int v : source) {
+            co_yield sum += v;
+        }
+    }
+
+    /// every site whose function name contains `name`
+    std::vector<const site_t*> sites(const char* name) {
+        std::vector<const site_t*> found;
+        hotel::coro::default_frame_stats().for_each([&] (const site_t& s) {
+            if (std::strstr(s.function(), name)) {
+                found.push_back(&s);
+            }
+        });
+        return found;
+    }
+
+    int failures = 0;
+
+    void expect(const char* what, bool ok) {
+        failures += !ok;
+        std::printf("%-60s %s\n", what, ok ? "ok" : "FAIL");
+    }
+}
+
+int main() {
+    {
+        std::vector<hotel::coro::generator<int>> kept;
+        for (int i = 0; i < 5; i++) {
+            kept.push_back(counter(3));
+        }
+        for (int i = 0; i < 101; i++) {
+            for (int v : counter(3)) {
+                (void) v;
+            }
+        }
+
+        float total = 0.0f;
+        for (float v : scaled(0.5f, 4)) {
+            total += v;
+        }
+        for (int v : scaled(2, 4)) {
+            total += v;
+        }
+
+        int last = 0;
+        for (int v : running_sum(ramp(10))) {
+            last = v;
+        }
+
+        hotel::coro::default_frame_stats().report(stdout);
+        std::printf("\n");
+
+        auto c = sites("counter");
+        expect("one site for counter()", c.size() == 1);
+        if (c.size() == 1) {
+            std::printf("counter(): %u-byte frames\n", c[0]->frame_size());
+            expect("counter(): 106 created, 101 destroyed, 5 live, peak 6",
+                   c[0]->created() == 106 && c[0]->destroyed() == 101 && c[0]->live() == 5 && c[0]->peak() == 6);
+            expect("counter(): 404 resumes", c[0]->resumes().count() == 404);
+            expect("counter(): frame holds the promise",
+                   c[0]->frame_size() >= sizeof(hotel::coro::generator<int>::promise_type));
+        }
+        expect("a site per instantiation of scaled<T>()", sites("scaled").size() == 2 && total == 15.0f);
+
+        auto source = sites("ramp"), sum = sites("running_sum");
+        expect("nested generators: 11 resumes each",
+               source.size() == 1 && sum.size() == 1 && source[0]->resumes().count() == 11 &&
+               sum[0]->resumes().count() == 11 && last == 45);
+    }
+
+    auto c = sites("counter");
+    expect("counter(): none live once the kept frames are gone", c.size() == 1 && c[0]->live() == 0);
+    return failures ? 1 : 0;
+}
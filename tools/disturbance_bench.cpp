@@ -0,0 +1,146 @@
+/**
+ * @file disturbance_bench.cpp
+ *
+ * host-side load-rejection benchmark of `hotel::disturbance_observer` (see hotel/disturbance_observer.hpp)
+ *
+ * two mechanisms, each a `hotel::verify` plant model run at 10 ms by a `hotel::pid_law` loop, are given 10 s to reach
+ * steady state and then hit with a step load:
+ *
+ * - a lift holding 360 degrees against gravity picks up a game object, adding 75% to the load
+ * - one side of a drivetrain cruising at 30 in/s is pushed back by another robot for a second, then let go
+ *
+ * each runs with the PID loop alone, then with the same gains behind an observer whose nominal model is 10% off in
+ * gain and 20% off in time constant. reported are the peak error after each step, the time until it's back within
+ * tolerance for good, and the integrated absolute error over the second after it.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/disturbance_bench
+ * ```
+ */
+#include <algorithm>
+#include <cmath>
+#include <ratio>
+#include <vector>
+
+#include <cstdio>
+
+#include "hotel/disturbance_observer.hpp"
+#include "hotel/pid.hpp"
+#include "hotel/verify.hpp"
+
+namespace {
+    constexpr std::uint32_t period_ms = 10;
+    constexpr double limit = 127.0;
+
+    struct step_load {
+        /// tick the load changes at
+        std::uint32_t at;
+        double load;
+    };
+
+    struct recovery {
+        double peak = 0.0;
+        double settle_ms = 0.0;
+        bool settled = true;
+        double iae = 0.0;
+    };
+
+    /**
+     * hold `setpoint` through a sequence of load steps, and measure the recovery from each
+     *
+     * @param observer `nullptr` for the PID loop alone
+     * @param base load that's always there (gravity, friction), given the output
+     */
+    template <class Law, class Plant, class Base>
+    std::vector<recovery> hold(Plant plant, Base base, hotel::disturbance_observer<>* observer, double setpoint,
+                               double tolerance, const std::vector<step_load>& steps, std::uint32_t ticks) {
+        plant.start(setpoint, period_ms);
+        double y = setpoint, accumulator = 0.0, last_error = 0.0;
+        std::vector<recovery> out(steps.size());
+        std::vector<std::uint32_t> last_outside(steps.size());
+        std::size_t current = 0;
+        for (std::uint32_t k = 0; k < ticks; k++) {
+            if (current + 1 < steps.size() && k == steps[current + 1].at) {
+                current++;
+            }
+            if (k == steps[current].at) {
+                last_outside[current] = k;
+            }
+
+            double error = setpoint - y;
+            accumulator += error;
+            double u = Law::output(error, accumulator, last_error, static_cast<double>(period_ms));
+            last_error = error;
+            if (observer) {
+                observer->update(static_cast<float>(y));
+                u = observer->compensate(static_cast<float>(u));
+            }
+            y = plant.step(std::clamp(u, -limit, limit) - base(y) - steps[current].load);
+
+            auto& r = out[current];
+            double e = std::fabs(setpoint - y);
+            r.peak = std::max(r.peak, e);
+            if (k < steps[current].at + 1000 / period_ms) {
+                r.iae += e * period_ms * 1e-3;
+            }
+            if (e > tolerance) {
+                last_outside[current] = k + 1;
+            }
+        }
+        for (std::size_t i = 0; i < steps.size(); i++) {
+            std::uint32_t end = i + 1 < steps.size() ? steps[i + 1].at : ticks;
+            out[i].settled = last_outside[i] < end;
+            out[i].settle_ms = (last_outside[i] - steps[i].at) * static_cast<double>(period_ms);
+        }
+        return out;
+    }
+
+    void report(const char* name, const char* event, const recovery& without, const recovery& with) {
+        std::printf("%-11s %-9s %9.1f %9.1f", name, event, without.peak, with.peak);
+        for (auto* r : {&without, &with}) {
+            if (r->settled) {
+                std::printf(" %9.0f", r->settle_ms);
+            } else {
+                std::printf(" %9s", "never");
+            }
+        }
+        std::printf(" %9.2f %9.2f\n", without.iae, with.iae);
+    }
+}
+
+int main() {
+    using std::ratio;
+
+    std::printf("%-21s %19s %19s %19s\n", "", "peak error", "recovery (ms)", "IAE over 1 s");
+    std::printf("%-21s %9s %9s %9s %9s %9s %9s\n", "", "PID", "PID + DOB", "PID", "PID + DOB", "PID", "PID + DOB");
+
+    // lift: ~9.4 deg/s per unit of move(), 80 ms, 10 ms latency; 20 units of gravity, then 15 more
+    {
+        using law = hotel::pid_law<ratio<1, 2>, ratio<1, 2000>, ratio<0>>;
+        hotel::verify::integrating_plant<> lift{{.gain = 9.4, .time_constant = 0.08, .dead_time_us = 10000}};
+        auto gravity = [] (double) { return 20.0; };
+        std::vector<step_load> steps{{0, 0.0}, {1000, 15.0}};
+        hotel::disturbance_observer<> observer{{.gain = 9.4f * 0.9f, .time_constant = 0.08f * 1.2f,
+                                                .dead_time_us = 10000, .filter_time_constant = 0.04f,
+                                                .measurement = hotel::disturbance_observer<>::position}};
+        auto without = hold<law>(lift, gravity, nullptr, 360.0, 5.0, steps, 1300);
+        auto with = hold<law>(lift, gravity, &observer, 360.0, 5.0, steps, 1300);
+        report("lift", "pickup", without[1], with[1]);
+    }
+
+    // drivetrain velocity, in inches per second: 0.45 in/s per unit, 150 ms; 12 units of friction, a 40 unit push
+    {
+        using law = hotel::pid_law<ratio<4>, ratio<1, 200>, ratio<0>>;
+        hotel::verify::first_order_plant<> side{{.gain = 0.45, .time_constant = 0.15, .dead_time_us = 10000}};
+        auto friction = [] (double v) { return v > 0.0 ? 12.0 : v < 0.0 ? -12.0 : 0.0; };
+        std::vector<step_load> steps{{0, 0.0}, {1000, 40.0}, {1100, 0.0}};
+        hotel::disturbance_observer<> observer{{.gain = 0.45f * 0.9f, .time_constant = 0.15f * 1.2f,
+                                                .dead_time_us = 10000, .filter_time_constant = 0.04f}};
+        auto without = hold<law>(side, friction, nullptr, 30.0, 1.0, steps, 1400);
+        auto with = hold<law>(side, friction, &observer, 30.0, 1.0, steps, 1400);
+        report("drivetrain", "push", without[1], with[1]);
+        report("drivetrain", "release", without[2], with[2]);
+    }
+    return 0;
+}
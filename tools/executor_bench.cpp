@@ -0,0 +1,136 @@
+/**
+ * @file executor_bench.cpp
+ *
+ * host-side scaling benchmark of `hotel::coro::thread_pool_executor` (see hotel/coro/thread_pool.hpp)
+ *
+ * the workload is a PID gain sweep: every candidate is a `hotel::coro::task` that moves itself onto the pool and then
+ * awaits one sub-task per scenario (each of those also moving onto the pool, so there's nested work to steal), each
+ * simulating the loop against a `hotel::verify` plant model. the sweep is run once inline on the main thread, for a
+ * baseline without the pool, then on pools of 1 to N workers, checking every result matches the baseline.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/executor_bench [max workers] [candidates]
+ * ```
+ * max workers defaults to the number of hardware threads.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "hotel/coro/task.hpp"
+#include "hotel/coro/thread_pool.hpp"
+#include "hotel/verify.hpp"
+
+namespace {
+    using hotel::coro::task;
+    using hotel::coro::thread_pool_executor;
+
+    struct gains {
+        double kp, ki, kd;
+    };
+
+    /// integrated absolute error of a step on a lift, with the same law `hotel::pid_controller` runs
+    double score(gains g, double setpoint) {
+        hotel::verify::integrating_plant<> lift{{.gain = 9.4, .time_constant = 0.08, .dead_time_us = 10000}};
+        lift.start(0.0, 10);
+        double accumulator = 0.0, last_error = 0.0, y = 0.0, cost = 0.0;
+        for (int k = 0; k < 4000; k++) {
+            double error = setpoint - y;
+            accumulator += error;
+            double u = g.kp * error + g.ki * accumulator * 10.0 + g.kd * ((last_error - error) / 10.0);
+            last_error = error;
+            y = lift.step(std::clamp(std::trunc(u), -127.0, 127.0));
+            cost += std::fabs(setpoint - y);
+        }
+        return cost;
+    }
+
+    template <class Executor>
+    task<double> scenario(Executor* pool, gains g, double setpoint) {
+        if (pool) {
+            co_await hotel::coro::schedule_on(*pool);
+        }
+        co_return score(g, setpoint);
+    }
+
+    template <class Executor>
+    task<double> candidate(Executor* pool, gains g) {
+        if (pool) {
+            co_await hotel::coro::schedule_on(*pool);
+        }
+        // start every scenario before waiting on any, so idle workers can steal them
+        std::vector<task<double>> runs;
+        for (double setpoint : {90.0, 180.0, 360.0, 720.0}) {
+            runs.push_back(scenario(pool, g, setpoint));
+        }
+        double total = 0.0;
+        for (auto& r : runs) {
+            total += co_await r;
+        }
+        co_return total;
+    }
+
+    std::vector<gains> grid(std::size_t n) {
+        std::vector<gains> out;
+        for (std::size_t i = 0; i < n; i++) {
+            out.push_back({0.1 + 0.9 * (i % 16) / 16.0, 1e-4 * (i / 16 % 8), 0.5 * (i / 128 % 4)});
+        }
+        return out;
+    }
+
+    template <class Executor>
+    std::vector<double> sweep(Executor* pool, const std::vector<gains>& candidates) {
+        std::vector<task<double>> runs;
+        for (auto& g : candidates) {
+            runs.push_back(candidate(pool, g));
+        }
+        hotel::coro::sync_wait_all(std::span{runs});
+        std::vector<double> out;
+        for (auto& r : runs) {
+            out.push_back(r.result());
+        }
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t max_workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                       : std::max(1u, std::thread::hardware_concurrency());
+    std::size_t n = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 512;
+    auto candidates = grid(n);
+
+    auto start = std::chrono::steady_clock::now();
+    auto baseline = sweep<thread_pool_executor>(nullptr, candidates);
+    double inline_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu candidates x 4 scenarios, %u hardware threads\n", n, std::thread::hardware_concurrency());
+    std::printf("inline   %9.1f ms\n", inline_ms);
+
+    double one = 0.0;
+    // powers of two, and the maximum itself
+    for (std::size_t workers = 1; workers <= max_workers;
+         workers = workers < max_workers ? std::min(workers * 2, max_workers) : workers + 1) {
+        thread_pool_executor pool{workers};
+        start = std::chrono::steady_clock::now();
+        auto results = sweep(&pool, candidates);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (results != baseline) {
+            std::fprintf(stderr, "%zu workers: results differ from the inline run\n", workers);
+            return 1;
+        }
+        if (workers == 1) {
+            one = ms;
+        }
+        auto s = pool.stats();
+        std::printf("%2zu worker%s %9.1f ms  speedup %5.2fx  efficiency %5.1f%%  stolen %llu of %llu\n", workers,
+                    workers == 1 ? " " : "s", ms, one / ms, 100.0 * one / ms / workers,
+                    static_cast<unsigned long long>(s.stolen), static_cast<unsigned long long>(s.executed));
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file feedforward_bench.cpp
+ *
+ * host-side comparison of `hotel::pid_controller` loops with and without the feedforward models in
+ * hotel/feedforward.hpp
+ *
+ * four mechanisms, each a `hotel::verify` plant model with its load applied on top (gravity for the lift, gravity
+ * times the cosine of the angle for the arm, static friction for the flywheel and drivetrain), follow a trapezoidal
+ * motion profile at 10 ms with the same PID gains twice, both times through `hotel::feedforward_adaptor`: once with
+ * a model that outputs nothing, as every loop on the robot runs now, and once with the mechanism's feedforward model
+ * (fed the profile's velocity and acceleration). the feedforward gains are 5% off the true ones, as measured gains
+ * would be. each tick the next profile sample goes to `track()` and the adaptor's generator is advanced, with
+ * `pros::Clock` stood in for by `hotel::sim::virtual_clock` (see hotel/sim/pros_clock.hpp), advanced 10 ms per tick.
+ *
+ * reported are the RMS tracking error while the profile runs, and the settle time: from the end of the profile until
+ * the mechanism is within tolerance for good (for these the controller's settled function never returns true, so the
+ * loop runs throughout). the feedforward loop is then run again with the mechanism's tolerance as its settled
+ * function, to check that the adaptor's `run()` carries on until the profile's last sample even though the
+ * mechanism starts out on its reference, and only finishes once it's settled there; the bench exits with a non-zero status if it
+ * doesn't. the cost of evaluating each model is timed as well.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/feedforward_bench
+ * ```
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <optional>
+#include <ratio>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/feedforward.hpp"
+#include "hotel/pid.hpp"
+#include "hotel/sim/plant.hpp"
+#include "hotel/sim/pros_clock.hpp"
+#include "hotel/verify.hpp"
+
+using sim_clock = hotel::sim::virtual_clock;
+
+namespace {
+    constexpr std::uint32_t period_ms = 10;
+}
+
+namespace {
+    constexpr double limit = 127.0;
+
+    /// trapezoidal profile from `from` to `to`, one sample per period
+    std::vector<hotel::motion_setpoint> trapezoid(float from, float to, float max_velocity, float max_acceleration) {
+        float distance = std::fabs(to - from), direction = to < from ? -1.0f : 1.0f;
+        float ramp = std::min(max_velocity / max_acceleration, std::sqrt(distance / max_acceleration));
+        float cruise_velocity = max_acceleration * ramp;
+        float cruise = (distance - cruise_velocity * ramp) / cruise_velocity;
+        float total = 2.0f * ramp + cruise;
+
+        std::vector<hotel::motion_setpoint> out;
+        for (float t = 0.0f; t < total; t += period_ms * 1e-3f) {
+            float p, v, a;
+            if (t < ramp) {
+                a = max_acceleration;
+                v = a * t;
+                p = 0.5f * a * t * t;
+            } else if (t < ramp + cruise) {
+                a = 0.0f;
+                v = cruise_velocity;
+                p = 0.5f * cruise_velocity * ramp + cruise_velocity * (t - ramp);
+            } else {
+                float r = total - t;
+                a = -max_acceleration;
+                v = max_acceleration * r;
+                p = distance - 0.5f * max_acceleration * r * r;
+            }
+            out.push_back({from + direction * p, direction * v, direction * a});
+        }
+        out.push_back({to, 0.0f, 0.0f});
+        return out;
+    }
+
+    struct result {
+        double rms_error;
+        /// from the end of the profile, in milliseconds; nullopt if it never settled
+        std::optional<double> settle_ms;
+        /// outputs the adaptor's first `run()` produced before it finished
+        std::uint32_t first_run;
+    };
+
+    int failures = 0;
+
+    /**
+     * follow a profile with a PID controller and a feedforward adaptor on top of a plant
+     *
+     * @param plant a `hotel::verify` plant
+     * @param load what the mechanism takes out of the command, given its output and velocity
+     * @param ff feedforward model, evaluated on each profile sample
+     * @param settles whether the controller should consider itself settled within tolerance; if it does, the last
+     *                output is held once it has, and it's resumed when the mechanism drifts out again
+     */
+    template <class Kp, class Ki, class Kd, class Plant, class Load, class Model>
+    result follow(Plant plant, Load load, Model ff, const std::vector<hotel::motion_setpoint>& profile,
+                  double initial, double tolerance, bool settles = false, std::uint32_t extra_ticks = 300) {
+        plant.start(initial, period_ms);
+        sim_clock::reset();
+        double y = initial, last_y = initial, u = 0.0, squares = 0.0;
+        hotel::pid_controller<Kp, Ki, Kd, double, std::function<double()>> pid{
+            [&] { return y; }, [=] (double error) { return settles && std::fabs(error) < tolerance; }, initial};
+        hotel::feedforward_adaptor controller{pid, ff};
+
+        hotel::coro::generator<double> generator;
+        decltype(generator.begin()) it;
+        bool running = false, first = true;
+        std::uint32_t last_outside = 0, first_run = 0, ticks = profile.size() + extra_ticks;
+        for (std::uint32_t k = 0; k < ticks; k++, sim_clock::advance(period_ms * 1000)) {
+            const auto& reference = profile[std::min<std::size_t>(k, profile.size() - 1)];
+            if (k < profile.size()) {
+                controller.track(reference);
+            }
+            if (running) {
+                ++it;
+                running = it != generator.end();
+                first = first && running;
+            } else if (!controller.settled(controller.error())) {
+                controller.resume();
+                generator = controller.run();
+                it = generator.begin();
+                running = it != generator.end();
+            }
+            if (running) {
+                u = *it;
+                first_run += first;
+            }
+            double error = reference.position - y;
+
+            double velocity = (y - last_y) / (period_ms * 1e-3);
+            last_y = y;
+            y = plant.step(std::clamp(u, -limit, limit) - load(y, velocity));
+
+            if (k < profile.size()) {
+                squares += error * error;
+            }
+            if (std::fabs(profile.back().position - y) > tolerance) {
+                last_outside = k + 1;
+            }
+        }
+        std::optional<double> settle;
+        if (last_outside < ticks) {
+            settle = (std::max<double>(last_outside, profile.size()) - profile.size()) * period_ms;
+        }
+        return {std::sqrt(squares / profile.size()), settle, first_run};
+    }
+
+    template <class Kp, class Ki, class Kd, class Plant, class Load, class Model>
+    void compare(const char* name, Plant plant, Load load, Model ff,
+                 const std::vector<hotel::motion_setpoint>& profile, double initial, double tolerance) {
+        auto without = follow<Kp, Ki, Kd>(plant, load, [] (const hotel::motion_setpoint&) { return 0.0f; }, profile,
+                                          initial, tolerance);
+        auto with = follow<Kp, Ki, Kd>(plant, load, ff, profile, initial, tolerance);
+        auto settling = follow<Kp, Ki, Kd>(plant, load, ff, profile, initial, tolerance, true);
+        std::printf("%-11s %12.2f %12.2f", name, without.rms_error, with.rms_error);
+        for (auto& ms : {without.settle_ms, with.settle_ms}) {
+            if (ms) {
+                std::printf(" %12.0f", *ms);
+            } else {
+                std::printf(" %12s", "never");
+            }
+        }
+        // it can finish on the last sample, which has the reference stopped, if it's settled there
+        bool whole = settling.first_run + 1 >= profile.size();
+        failures += !whole;
+        std::printf(" %7u / %-4zu %s\n", settling.first_run, profile.size(), whole ? "" : "FAIL");
+    }
+
+    template <class F>
+    double nanoseconds_per_call(F f) {
+        constexpr int n = 10000000;
+        volatile float sink = 0.0f;
+        hotel::motion_setpoint s{0.0f, 0.0f, 0.0f};
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            s.position = i * 0.01f;
+            s.velocity = (i & 255) - 128.0f;
+            s.acceleration = (i & 1023) - 512.0f;
+            sink = sink + f(s);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    }
+}
+
+int main() {
+    using std::ratio;
+    constexpr double degrees = std::numbers::pi / 180.0;
+
+    std::printf("%-11s %25s %25s %15s\n", "", "RMS tracking error", "settle after profile (ms)", "first run()");
+    std::printf("%-11s %12s %12s %12s %12s %15s\n", "mechanism", "PID", "PID + ff", "PID", "PID + ff",
+                "ticks / profile");
+
+    // lift: ~9.4 deg/s per unit of move(), 80 ms, 10 ms latency; 20 units of gravity
+    compare<ratio<1, 2>, ratio<1, 2000>, ratio<0>>(
+        "lift", hotel::verify::integrating_plant<>{{.gain = 9.4, .time_constant = 0.08, .dead_time_us = 10000}},
+        [] (double, double) { return 20.0; },
+        hotel::elevator_feedforward{.kg = 19.0f, .kv = 1.0f / 9.4f * 1.05f, .ka = 0.08f / 9.4f},
+        trapezoid(0.0f, 720.0f, 600.0f, 2400.0f), 0.0, 5.0);
+
+    // arm, level at 0 degrees: 25 units hold it level
+    compare<ratio<1, 1>, ratio<1, 2000>, ratio<0>>(
+        "arm", hotel::verify::integrating_plant<>{{.gain = 6.0, .time_constant = 0.1, .dead_time_us = 10000}},
+        [=] (double angle, double) { return 25.0 * std::cos(angle * degrees); },
+        hotel::arm_feedforward{.kg = 23.75f, .kv = 1.0f / 6.0f * 0.95f, .ka = 0.1f / 6.0f},
+        trapezoid(-45.0f, 90.0f, 300.0f, 1200.0f), -45.0, 2.0);
+
+    // flywheel velocity in rpm: 4.7 rpm per unit, 350 ms; 8 units of friction
+    compare<ratio<1, 2>, ratio<1, 500>, ratio<0>>(
+        "flywheel", hotel::verify::first_order_plant<>{{.gain = 4.7, .time_constant = 0.35, .dead_time_us = 5000}},
+        [] (double v, double) { return v > 0.0 ? 8.0 : 0.0; },
+        [] (const hotel::motion_setpoint& s) {
+            // the flywheel's "position" is its speed, so the profile's velocity is what its feedforward needs
+            return hotel::simple_feedforward{.ks = 7.6f, .kv = 1.0f / 4.7f * 1.05f, .ka = 0.35f / 4.7f}(
+                s.position, s.velocity);
+        },
+        trapezoid(0.0f, 500.0f, 1000.0f, 1e9f), 0.0, 10.0);
+
+    // one side of a drivetrain's velocity, in inches per second: 0.45 in/s per unit, 150 ms; 12 units of friction
+    compare<ratio<4>, ratio<1, 200>, ratio<0>>(
+        "drivetrain", hotel::verify::first_order_plant<>{{.gain = 0.45, .time_constant = 0.15, .dead_time_us = 10000}},
+        [] (double v, double) { return v > 0.0 ? 12.0 : v < 0.0 ? -12.0 : 0.0; },
+        [] (const hotel::motion_setpoint& s) {
+            return hotel::simple_feedforward{.ks = 11.4f, .kv = 1.0f / 0.45f * 1.05f, .ka = 0.15f / 0.45f}(
+                s.position, s.velocity);
+        },
+        trapezoid(0.0f, 48.0f, 96.0f, 1e9f), 0.0, 1.0);
+
+    hotel::simple_feedforward simple{.ks = 1.0f, .kv = 0.2f, .ka = 0.01f};
+    hotel::elevator_feedforward elevator{.ks = 1.0f, .kg = 20.0f, .kv = 0.2f, .ka = 0.01f};
+    hotel::arm_feedforward arm{.ks = 1.0f, .kg = 20.0f, .kv = 0.2f, .ka = 0.01f};
+    std::printf("\nevaluation: simple %.2f ns, elevator %.2f ns, arm %.2f ns (std::cos: %.2f ns)\n",
+                nanoseconds_per_call([&] (const auto& s) { return simple(s); }),
+                nanoseconds_per_call([&] (const auto& s) { return elevator(s); }),
+                nanoseconds_per_call([&] (const auto& s) { return arm(s); }),
+                nanoseconds_per_call([&] (const auto& s) {
+                    return static_cast<float>(arm.kg * std::cos(s.position * degrees) + arm.kv * s.velocity);
+                }));
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file field_index_bench.cpp
+ *
+ * host-side benchmark of `hotel::field_index` (see hotel/field_index.hpp) against the linear scan over a
+ * `std::vector` it replaces
+ *
+ * for 10 to 500 objects scattered over the field, each simulated tick moves every object a little (as tracking updates
+ * would), then asks for the nearest object of a kind and everything within 18" of a few robot positions. both
+ * structures answer every query, and the answers are checked to agree.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/field_index_bench [ticks]
+ * ```
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "hotel/field_index.hpp"
+
+namespace {
+    using index = hotel::field_index<512, 32>;
+
+    struct object {
+        std::uint16_t id;
+        float x, y;
+        std::uint8_t kind;
+    };
+
+    struct timing {
+        double move_ns = 0.0;
+        double nearest_ns = 0.0;
+        double within_ns = 0.0;
+    };
+
+    constexpr int queries = 8;
+    constexpr float radius = 18.0f;
+
+    double elapsed(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    int ticks = argc > 1 ? std::atoi(argv[1]) : 2000;
+    std::printf("%5s %24s %24s %24s\n", "", "move (ns/object)", "nearest (ns/query)", "within 18\" (ns/query)");
+    std::printf("%5s %12s %11s %12s %11s %12s %11s\n", "n", "scan", "index", "scan", "index", "scan", "index");
+
+    for (std::size_t n : {10, 25, 50, 100, 200, 500}) {
+        std::mt19937 rng{static_cast<std::uint32_t>(n)};
+        std::uniform_real_distribution<float> field{0.0f, 144.0f};
+        std::normal_distribution<float> jitter{0.0f, 0.5f};
+
+        std::vector<object> objects;
+        index grid;
+        for (std::size_t i = 0; i < n; i++) {
+            object o{static_cast<std::uint16_t>(i), field(rng), field(rng), static_cast<std::uint8_t>(i % 3)};
+            objects.push_back(o);
+            grid.insert(o.id, o.x, o.y, o.kind);
+        }
+
+        timing scan, indexed;
+        std::size_t checksum_scan = 0, checksum_index = 0;
+        std::vector<std::uint16_t> found_scan, found_index(512);
+        for (int t = 0; t < ticks; t++) {
+            std::vector<std::pair<float, float>> moves(n);
+            for (auto& m : moves) {
+                m = {jitter(rng), jitter(rng)};
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < n; i++) {
+                objects[i].x = std::clamp(objects[i].x + moves[i].first, 0.0f, 143.9f);
+                objects[i].y = std::clamp(objects[i].y + moves[i].second, 0.0f, 143.9f);
+            }
+            scan.move_ns += elapsed(start);
+            start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < n; i++) {
+                grid.move(static_cast<std::uint16_t>(i), objects[i].x, objects[i].y);
+            }
+            indexed.move_ns += elapsed(start);
+
+            std::array<std::pair<float, float>, queries> robots;
+            for (auto& r : robots) {
+                r = {field(rng), field(rng)};
+            }
+            std::uint8_t wanted = static_cast<std::uint8_t>(t % 3);
+
+            start = std::chrono::steady_clock::now();
+            for (auto [x, y] : robots) {
+                float best = std::numeric_limits<float>::infinity();
+                std::uint16_t id = 0xffff;
+                for (auto& o : objects) {
+                    float d = (o.x - x) * (o.x - x) + (o.y - y) * (o.y - y);
+                    if (d < best && o.kind == wanted) {
+                        best = d;
+                        id = o.id;
+                    }
+                }
+                checksum_scan += id;
+            }
+            scan.nearest_ns += elapsed(start);
+            start = std::chrono::steady_clock::now();
+            for (auto [x, y] : robots) {
+                auto hit = grid.nearest(x, y, [&] (auto id) { return grid.kind(id) == wanted; });
+                checksum_index += hit ? hit->id : 0xffff;
+            }
+            indexed.nearest_ns += elapsed(start);
+
+            for (auto [x, y] : robots) {
+                start = std::chrono::steady_clock::now();
+                found_scan.clear();
+                for (auto& o : objects) {
+                    if ((o.x - x) * (o.x - x) + (o.y - y) * (o.y - y) <= radius * radius) {
+                        found_scan.push_back(o.id);
+                    }
+                }
+                scan.within_ns += elapsed(start);
+                start = std::chrono::steady_clock::now();
+                auto k = grid.within(x, y, radius, found_index);
+                indexed.within_ns += elapsed(start);
+
+                std::sort(found_index.begin(), found_index.begin() + k);
+                if (k != found_scan.size() || !std::equal(found_scan.begin(), found_scan.end(), found_index.begin())) {
+                    std::fprintf(stderr, "n=%zu: within disagrees\n", n);
+                    return 1;
+                }
+            }
+        }
+        if (checksum_scan != checksum_index) {
+            std::fprintf(stderr, "n=%zu: nearest disagrees\n", n);
+            return 1;
+        }
+
+        double moves = static_cast<double>(ticks) * n, q = static_cast<double>(ticks) * queries;
+        std::printf("%5zu %12.1f %11.1f %12.1f %11.1f %12.1f %11.1f\n", n, scan.move_ns / moves,
+                    indexed.move_ns / moves, scan.nearest_ns / q, indexed.nearest_ns / q, scan.within_ns / q,
+                    indexed.within_ns / q);
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+/**
+ * @file flywheel_bench.cpp
+ *
+ * host-side shot-recovery benchmark of the flywheel controllers in hotel/flywheel.hpp, against the plain PID loop on
+ * `get_actual_velocity` they replace
+ *
+ * the flywheel is a `hotel::sim::first_order_plant` (600 rpm at 12 V, 0.35 s time constant, 5 ms dead time, a little
+ * friction), spun up to 500 rpm and then hit with a shot every 1.5 s: a 30 ms load that takes 70-80 rpm out of it. every
+ * controller runs at 10 ms, with feedforward gains 5% off the true ones, on each of two velocity signals:
+ *
+ * - `actual`: a stand-in for `pros::Motor::get_actual_velocity`, the true speed averaged over the last 60 ms
+ * - `estimate`: `hotel::velocity_estimator` fitting the encoder position (1.2 degree resolution) read every iteration
+ *
+ * recovery is the time from the start of a shot until the true speed is back within 10 rpm of the setpoint for good
+ * (until the next shot); spin-up is the same from a standstill.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/flywheel_bench [shots]
+ * ```
+ */
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <ratio>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "hotel/flywheel.hpp"
+#include "hotel/pid.hpp"
+#include "hotel/sim/plant.hpp"
+
+namespace {
+    using sim_clock = hotel::sim::virtual_clock;
+    using plant = hotel::sim::first_order_plant<sim_clock>;
+
+    constexpr float setpoint = 500.0f;
+    constexpr float tolerance = 10.0f;
+    constexpr float friction = 20.0f;
+    constexpr float shot_load = 900.0f;
+    constexpr std::uint64_t shot_us = 30000;
+    constexpr std::uint64_t shot_interval_us = 1500000;
+    constexpr std::uint64_t period_us = 10000;
+
+    /// true feedforward is 20 mV/rpm and 400 mV of friction; the controllers are given these
+    constexpr float kv = 19.0f;
+    constexpr float ks = 380.0f;
+
+    struct flywheel {
+        plant wheel{{.gain = 0.05f, .time_constant = 0.35f, .dead_time_us = 5000}};
+        double position = 0.0;
+        std::deque<float> history;
+        hotel::velocity_estimator<4, sim_clock> estimator;
+
+        flywheel() { wheel.disturb(friction); };
+
+        float actual_velocity() const {
+            return std::accumulate(history.begin(), history.end(), 0.0f) / std::max<std::size_t>(history.size(), 1);
+        };
+
+        float estimated_velocity() {
+            return estimator.update(std::round(position / 1.2) * 1.2);
+        };
+
+        /// advance a millisecond, returning the true speed
+        float tick() {
+            sim_clock::advance(1000);
+            float v = wheel.output();
+            position += v * 6.0 * 1e-3;
+            history.push_back(v);
+            if (history.size() > 60) {
+                history.pop_front();
+            }
+            return v;
+        };
+    };
+
+    struct result {
+        double spin_up_ms = 0.0;
+        double mean_recovery_ms = 0.0;
+        double worst_recovery_ms = 0.0;
+        /// deepest dip below the setpoint after a shot, and highest overshoot above it, in rpm
+        float dip = 0.0f;
+        float overshoot = 0.0f;
+        int unrecovered = 0;
+    };
+
+    /**
+     * run spin-up and `shots` shots
+     *
+     * @param make builds the controller's step function, given the feedback function it should read
+     */
+    template <class Make>
+    result simulate(Make make, bool estimate, int shots) {
+        sim_clock::reset();
+        flywheel f;
+        std::function<float()> feedback = estimate ? std::function<float()>{[&f] { return f.estimated_velocity(); }}
+                                                   : std::function<float()>{[&f] { return f.actual_velocity(); }};
+        auto step = make(feedback);
+
+        result r;
+        std::vector<double> recoveries;
+        std::uint64_t event = 0;
+        for (int e = 0; e <= shots; e++) {
+            // the last time the speed was outside the band since this event
+            std::uint64_t last_outside = event;
+            bool outside = true;
+            while (sim_clock::now() < event + shot_interval_us) {
+                f.wheel.command(step());
+                for (std::uint64_t k = 0; k < period_us / 1000; k++) {
+                    if (e > 0 && sim_clock::now() == event) {
+                        f.wheel.disturb(friction + shot_load);
+                    } else if (e > 0 && sim_clock::now() == event + shot_us) {
+                        f.wheel.disturb(friction);
+                    }
+                    float v = f.tick();
+                    outside = std::fabs(v - setpoint) > tolerance;
+                    if (outside) {
+                        last_outside = sim_clock::now();
+                    }
+                    if (e > 0) {
+                        r.dip = std::max(r.dip, setpoint - v);
+                        if (sim_clock::now() > event + shot_us) {
+                            r.overshoot = std::max(r.overshoot, v - setpoint);
+                        }
+                    }
+                }
+            }
+            double ms = (last_outside - event) / 1000.0;
+            if (outside) {
+                r.unrecovered++;
+                ms = shot_interval_us / 1000.0;
+            }
+            if (e == 0) {
+                r.spin_up_ms = ms;
+            } else {
+                recoveries.push_back(ms);
+            }
+            event += shot_interval_us;
+        }
+        r.mean_recovery_ms = std::accumulate(recoveries.begin(), recoveries.end(), 0.0) / recoveries.size();
+        r.worst_recovery_ms = *std::max_element(recoveries.begin(), recoveries.end());
+        return r;
+    }
+
+    /// what a `motor_velocity_controller` does, in mV: `pid_law` with an unbounded integral, clamped by the motor
+    auto plain_pid(std::function<float()> feedback) {
+        using law = hotel::pid_law<std::ratio<20>, std::ratio<1, 20>, std::ratio<0>>;
+        return [feedback, accumulated = 0.0f, last_error = 0.0f] () mutable {
+            float error = setpoint - feedback();
+            accumulated += error;
+            float u = law::output(error, accumulated, last_error, 10.0f);
+            last_error = error;
+            return std::clamp(u, -12000.0f, 12000.0f);
+        };
+    }
+
+    template <class Controller, class Parameters>
+    auto controller(Parameters p) {
+        return [p] (std::function<float()> feedback) {
+            return [c = Controller{p, feedback, setpoint}] () mutable { return c.step(); };
+        };
+    }
+
+    void report(const char* name, const char* signal, const result& r) {
+        std::printf("%-22s %-9s %9.0f %9.0f %9.0f %8.1f %8.1f", name, signal, r.spin_up_ms, r.mean_recovery_ms,
+                    r.worst_recovery_ms, r.dip, r.overshoot);
+        if (r.unrecovered) {
+            std::printf("  (%d never settled)", r.unrecovered);
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    int shots = argc > 1 ? std::atoi(argv[1]) : 8;
+
+    using tbh = hotel::take_back_half_controller<std::function<float()>, sim_clock>;
+    using bang_bang = hotel::bang_bang_controller<std::function<float()>, sim_clock>;
+    using pid_ff = hotel::pid_feedforward_controller<std::function<float()>, sim_clock>;
+
+    std::printf("setpoint %.0f rpm, %d shots, settled within %.0f rpm; times in ms, speeds in rpm\n", setpoint, shots,
+                tolerance);
+    std::printf("%-22s %-9s %9s %9s %9s %8s %8s\n", "controller", "velocity", "spin-up", "recovery", "worst", "dip",
+                "overshot");
+    for (bool estimate : {false, true}) {
+        const char* signal = estimate ? "estimate" : "actual";
+        report("pid_controller", signal, simulate(plain_pid, estimate, shots));
+        report("take_back_half", signal,
+               simulate(controller<tbh>(tbh::parameters{.gain = 400.0f, .kv = kv}), estimate, shots));
+        report("bang_bang_feedforward", signal,
+               simulate(controller<bang_bang>(bang_bang::parameters{.kv = kv, .ks = ks, .band = 15.0f, .kp = 100.0f}),
+                        estimate, shots));
+        report("pid_feedforward", signal,
+               simulate(controller<pid_ff>(pid_ff::parameters{.kv = kv, .ks = ks, .kp = 80.0f, .ki = 100.0f}),
+                        estimate, shots));
+    }
+    return 0;
+}
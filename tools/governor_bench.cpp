@@ -0,0 +1,138 @@
+/**
+ * @file governor_bench.cpp
+ *
+ * host-side measurement of how much `hotel::governor` (see hotel/governor.hpp) steadies a control loop
+ *
+ * a match is simulated on `hotel::sim::fixed_priority_scheduler`: 10 s disabled on the field, 15 s of autonomous, a
+ * couple of seconds disabled, then 105 s of driver control. a 10 ms control loop shares the default priority with
+ * four background subsystems (telemetry, screen refresh, logging and autonomous precomputation), which is how tasks
+ * end up when nobody picks their priorities, with odometry at 5 ms above them all. each background job costs more
+ * the more detail its budget asks for.
+ *
+ * without the governor, the background work runs at the same settings in every phase (precomputation only while
+ * disabled, which `hotel::auton_preload` already does). with it, a status function stepped through the match drives
+ * `poll()`, and each subsystem's callback moves its task to its budget for the phase. reported for each phase is the
+ * control loop's response-time jitter (worst minus best response, i.e. how far its output moves around within a
+ * period), its worst response time, and the processor's load.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/governor_bench
+ * ```
+ */
+#include <array>
+#include <chrono>
+
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/governor.hpp"
+#include "hotel/sim/plant.hpp"
+#include "hotel/sim/scheduler.hpp"
+
+namespace {
+    using sim_clock = hotel::sim::virtual_clock;
+    using governor_t = hotel::basic_governor<8, sim_clock>;
+
+    struct background {
+        const char* name;
+        /// execution time at detail 0, and per level of detail on top, in microseconds
+        std::uint32_t base_us;
+        std::uint32_t per_detail_us;
+        hotel::budget_profile governed;
+        /// what it runs at without the governor: the disabled budget, except for precomputation
+        hotel::budget ungoverned;
+        bool only_disabled = false;
+    };
+
+    const std::array<background, 4> subsystems{{
+        {"telemetry", 300, 250, {.disabled = {20, 2}, .autonomous = {100, 0}, .driver = {50, 1}}, {20, 2}},
+        {"screen", 2500, 0, {.disabled = {50, 0}, .autonomous = {}, .driver = {100, 0}}, {50, 0}},
+        {"logging", 200, 300, {.disabled = {10, 2}, .autonomous = {50, 0}, .driver = {20, 1}}, {10, 2}},
+        {"precompute", 4000, 0, {.disabled = {20, 0}, .autonomous = {}, .driver = {}}, {20, 0}, true},
+    }};
+
+    struct segment {
+        const char* name;
+        std::uint8_t status;
+        std::uint32_t duration_ms;
+    };
+
+    const std::array<segment, 4> match{{
+        {"disabled", COMPETITION_CONNECTED | COMPETITION_DISABLED, 10000},
+        {"autonomous", COMPETITION_CONNECTED | COMPETITION_AUTONOMOUS, 15000},
+        {"disabled", COMPETITION_CONNECTED | COMPETITION_DISABLED, 2000},
+        {"driver", COMPETITION_CONNECTED, 105000},
+    }};
+
+    struct result {
+        std::uint32_t jitter_us;
+        std::uint32_t worst_us;
+        std::uint32_t misses;
+        float utilization;
+    };
+
+    /// simulate one segment with the given background budgets; task 0 is the control loop
+    result simulate(const std::array<hotel::budget, 4>& budgets, std::uint32_t duration_ms) {
+        hotel::task_set<8> tasks;
+        tasks.add({.name = "control", .period_us = 10000, .wcet_us = 1500});
+        tasks.add({.name = "odometry", .period_us = 5000, .wcet_us = 400, .priority = TASK_PRIORITY_DEFAULT + 1});
+        std::array<std::uint32_t, 8> phases{0, 0};
+        for (std::size_t i = 0; i < subsystems.size(); i++) {
+            if (budgets[i].enabled()) {
+                // the background tasks were started at odd times, not all on the control loop's tick
+                phases[tasks.size()] = 1300 + 2700 * static_cast<std::uint32_t>(i);
+                auto wcet = subsystems[i].base_us + subsystems[i].per_detail_us * budgets[i].detail;
+                // paced with `pros::delay` after their work, so they drift against the control loop's ticks
+                tasks.add({.name = subsystems[i].name, .period_us = budgets[i].period_ms * 1000 + wcet,
+                           .wcet_us = wcet});
+            }
+        }
+        hotel::sim::fixed_priority_scheduler<8> sim{tasks, phases.data()};
+        sim.run(duration_ms * 1000ull);
+        return {sim.jitter(0), sim.worst_response(0), sim.misses(0), sim.utilization()};
+    }
+}
+
+int main() {
+    std::uint8_t status = 0;
+    governor_t governor{[&status] { return status; }};
+    std::array<hotel::budget, 4> governed{};
+    for (std::size_t i = 0; i < subsystems.size(); i++) {
+        governor.add(subsystems[i].name, subsystems[i].governed,
+                     [&governed, i] (const hotel::budget& b, hotel::match_phase) { governed[i] = b; });
+    }
+
+    std::printf("%-11s %23s %23s %23s\n", "", "control jitter (us)", "worst response (us)", "processor load (%)");
+    std::printf("%-11s %11s %11s %11s %11s %11s %11s\n", "phase", "fixed", "governed", "fixed", "governed", "fixed",
+                "governed");
+    for (const auto& s : match) {
+        status = s.status;
+        sim_clock::advance(s.duration_ms * 1000ull);
+        auto phase = governor.poll();
+
+        std::array<hotel::budget, 4> fixed{};
+        for (std::size_t i = 0; i < subsystems.size(); i++) {
+            if (!subsystems[i].only_disabled || phase == hotel::match_phase::disabled) {
+                fixed[i] = subsystems[i].ungoverned;
+            }
+        }
+        auto without = simulate(fixed, s.duration_ms);
+        auto with = simulate(governed, s.duration_ms);
+        std::printf("%-11s %11u %11u %11u %11u %11.1f %11.1f\n", s.name, without.jitter_us, with.jitter_us,
+                    without.worst_us, with.worst_us, without.utilization * 100.0f, with.utilization * 100.0f);
+        if (without.misses || with.misses) {
+            std::printf("%-11s missed deadlines: %u fixed, %u governed\n", "", without.misses, with.misses);
+        }
+    }
+
+    constexpr int n = 10000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        status = (i & 1023) == 0 ? COMPETITION_AUTONOMOUS : 0;
+        governor.poll();
+    }
+    auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    std::printf("\npoll: %.2f ns (%u transitions)\n", ns, governor.stats().transitions);
+    return 0;
+}
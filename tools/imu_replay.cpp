@@ -0,0 +1,198 @@
+/**
+ * @file imu_replay.cpp
+ *
+ * host-side replay of raw IMU data through `hotel::imu_pipeline` (see hotel/imu_pipeline.hpp)
+ *
+ * the input is a telemetry log with one `imu_raw` record per sensor reading:
+ * ```
+ * #imu_raw,<time us>,<gyro x>,<gyro y>,<gyro z>,<accel x>,<accel y>,<accel z>[,<reference heading>]
+ * ```
+ * which is what logging `imu.get_gyro_rate()` and `imu.get_accel()` with `hotel::telemetry::write` every 5ms produces
+ * (add `imu.get_rotation()`, or a heading from some better source, as the reference). without a file, a two-minute
+ * match is synthesized instead, with a warming-up gyro bias, noise, vibration and a known true heading.
+ *
+ * every reading is fed through the pipeline, and through a plain integration of the z rate with the bias measured over
+ * the first two seconds (what `get_rotation` does). with a reference heading, the drift of each is reported; the time
+ * spent per pipeline step is reported either way.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/imu_replay [log]
+ * ```
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <cstdio>
+#include <cstring>
+
+#include "hotel/imu_pipeline.hpp"
+#include "hotel/sim/plant.hpp"
+
+namespace {
+    using sim_clock = hotel::sim::virtual_clock;
+
+    struct reading {
+        std::uint64_t time;
+        hotel::vector3 gyro;
+        hotel::vector3 accel;
+        double reference;
+    };
+
+    struct axes {
+        double x, y, z;
+    };
+
+    /// `hotel::concepts::InertialSensor` over a recording
+    struct replay_imu {
+        const reading* current = nullptr;
+
+        axes get_gyro_rate() const { return {current->gyro.x, current->gyro.y, current->gyro.z}; };
+
+        axes get_accel() const { return {current->accel.x, current->accel.y, current->accel.z}; };
+
+        std::int32_t set_data_rate(std::uint32_t) const { return 1; };
+    };
+
+    bool load(const char* path, std::vector<reading>& out, bool& has_reference) {
+        auto* f = std::fopen(path, "r");
+        if (!f) {
+            return false;
+        }
+        char line[256];
+        has_reference = true;
+        while (std::fgets(line, sizeof(line), f)) {
+            if (std::strncmp(line, "#imu_raw,", 9) != 0) {
+                continue;
+            }
+            reading r{};
+            unsigned long long t;
+            int n = std::sscanf(line + 9, "%llu,%f,%f,%f,%f,%f,%f,%lf", &t, &r.gyro.x, &r.gyro.y, &r.gyro.z,
+                                &r.accel.x, &r.accel.y, &r.accel.z, &r.reference);
+            if (n < 7) {
+                continue;
+            }
+            has_reference &= n == 8;
+            r.time = t;
+            out.push_back(r);
+        }
+        std::fclose(f);
+        return true;
+    }
+
+    /**
+     * a match's worth of driving and stopping, sampled every 5ms
+     *
+     * the z bias warms up by 0.15 deg/s over the first couple of minutes and random-walks on top of that; all three
+     * axes get white noise, and the x and y axes vibration while driving.
+     */
+    std::vector<reading> synthesize(std::uint32_t seed) {
+        std::mt19937 rng{seed};
+        std::normal_distribution<float> noise{0.0f, 1.0f};
+        std::uniform_real_distribution<float> uniform{0.0f, 1.0f};
+        std::vector<reading> out;
+
+        constexpr double dt = 0.005;
+        double heading = 0.0, walk = 0.0, t = 0.0;
+        auto emit = [&] (float rate, float vibration, float lateral) {
+            double warm = 0.15 * (1.0 - std::exp(-t / 60.0));
+            walk += 0.003 * std::sqrt(dt) * noise(rng);
+            float bias = static_cast<float>(warm + walk);
+            reading r{};
+            r.time = static_cast<std::uint64_t>(t * 1e6);
+            r.gyro = {0.02f + 0.05f * noise(rng) + vibration * noise(rng),
+                      -0.03f + 0.05f * noise(rng) + vibration * noise(rng),
+                      rate + bias + 0.05f * noise(rng)};
+            r.accel = {lateral + 0.01f * noise(rng) + vibration * 0.05f * noise(rng),
+                       0.01f * noise(rng) + vibration * 0.05f * noise(rng),
+                       1.0f + 0.01f * noise(rng)};
+            // the z rate is counter-clockwise-positive, the heading clockwise-positive
+            heading -= rate * dt;
+            r.reference = heading;
+            out.push_back(r);
+            t += dt;
+        };
+
+        // sitting still through calibration, then driving in bursts with pauses
+        while (t < 3.0) {
+            emit(0.0f, 0.0f, 0.0f);
+        }
+        while (t < 123.0) {
+            float length = 0.5f + 3.5f * uniform(rng);
+            float peak = (uniform(rng) - 0.5f) * 400.0f;
+            for (double start = t; t - start < length;) {
+                float phase = static_cast<float>((t - start) / length);
+                float rate = peak * std::sin(phase * std::numbers::pi_v<float>);
+                emit(rate, 0.8f, 0.1f * std::sin(phase * 6.0f));
+            }
+            float pause = 0.2f + 1.8f * uniform(rng);
+            for (double start = t; t - start < pause;) {
+                emit(0.0f, 0.0f, 0.0f);
+            }
+        }
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<reading> data;
+    bool has_reference = true;
+    if (argc > 1) {
+        if (!load(argv[1], data, has_reference) || data.empty()) {
+            std::fprintf(stderr, "%s: no imu_raw records\n", argv[1]);
+            return 1;
+        }
+    } else {
+        data = synthesize(42);
+    }
+
+    // the plain integration's bias is whatever it was over the first two seconds, like the sensor's calibration
+    double bias = 0.0;
+    std::size_t calibration = 0;
+    while (calibration < data.size() && data[calibration].time - data[0].time < 2000000) {
+        bias += data[calibration++].gyro.z;
+    }
+    bias /= std::max<std::size_t>(calibration, 1);
+
+    replay_imu imu;
+    hotel::imu_pipeline<replay_imu, sim_clock> pipeline{imu};
+    double plain = 0.0, plain_max = 0.0, pipeline_max = 0.0;
+    double reference0 = data[0].reference;
+    double busy = 0.0;
+    for (std::size_t i = 0; i < data.size(); i++) {
+        imu.current = &data[i];
+        sim_clock::reset(data[i].time);
+
+        auto start = std::chrono::steady_clock::now();
+        pipeline.step();
+        busy += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        if (i) {
+            plain -= (data[i].gyro.z - bias) * (data[i].time - data[i - 1].time) * 1e-6;
+        }
+        if (has_reference) {
+            double reference = data[i].reference - reference0;
+            plain_max = std::max(plain_max, std::fabs(plain - reference));
+            pipeline_max = std::max(pipeline_max, std::fabs(pipeline.heading() - reference));
+        }
+    }
+
+    auto seconds = (data.back().time - data.front().time) * 1e-6;
+    auto s = pipeline.snapshot();
+    std::printf("%zu readings over %.1fs, stationary %.1fs, final bias estimate (%.3f, %.3f, %.3f) deg/s\n",
+                data.size(), seconds, pipeline.stats().stationary_us * 1e-6, s.bias.x, s.bias.y, s.bias.z);
+    if (has_reference) {
+        double reference = data.back().reference - reference0;
+        std::printf("plain integration  final error %7.2f deg  max %7.2f deg\n", plain - reference, plain_max);
+        std::printf("imu_pipeline       final error %7.2f deg  max %7.2f deg\n", s.heading - reference,
+                    pipeline_max);
+    } else {
+        std::printf("plain integration  final heading %9.2f deg\n", plain);
+        std::printf("imu_pipeline       final heading %9.2f deg\n", s.heading);
+    }
+    std::printf("%.0f ns per step on this host\n", busy / data.size());
+    return 0;
+}
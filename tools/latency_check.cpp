@@ -0,0 +1,88 @@
+/**
+ * @file latency_check.cpp
+ *
+ * host-side validation of `hotel::latency_probe` (see hotel/latency_probe.hpp) against a plant with a known delay
+ *
+ * the probe runs on `hotel::sim::virtual_clock` against `hotel::sim::first_order_plant`, for a range of dead times,
+ * time constants, sample periods and encoder resolutions. the latency it should report is the dead time, plus the time
+ * the plant's output takes to get past the threshold once it starts moving, rounded up to the next sample; every
+ * measurement has to land within one sample period of that. a dead time longer than the timeout has to be reported
+ * as a timeout. exits with a non-zero status if anything is out of tolerance.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/latency_check
+ * ```
+ */
+#include <cmath>
+
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/latency_probe.hpp"
+#include "hotel/sim/plant.hpp"
+
+namespace {
+    using sim_clock = hotel::sim::virtual_clock;
+
+    struct scenario {
+        std::uint32_t dead_time_us;
+        float time_constant;
+        float resolution;
+        std::uint32_t sample_period_us;
+    };
+
+    constexpr float step = 100.0f;
+    constexpr double threshold = 1.0;
+}
+
+int main() {
+    const scenario scenarios[] = {
+        {5000, 0.08f, 0.0f, 250},
+        {10000, 0.08f, 0.0f, 250},
+        {12000, 0.08f, 0.0f, 1000},
+        {20000, 0.05f, 0.0f, 250},
+        {20000, 0.2f, 0.5f, 500},
+        {35000, 0.1f, 0.0f, 100},
+        {60000, 0.08f, 0.0f, 1000},
+    };
+
+    int failures = 0;
+    std::printf("%10s %8s %10s %8s %10s %10s %6s\n", "dead (us)", "tau (s)", "resolution", "sample", "expected",
+                "measured", "");
+    for (const auto& s : scenarios) {
+        sim_clock::reset();
+        hotel::sim::first_order_plant<sim_clock> plant{{.gain = 1.0f, .time_constant = s.time_constant,
+                                                        .dead_time_us = s.dead_time_us, .resolution = s.resolution}};
+        hotel::latency_probe<1, sim_clock> probe;
+
+        // once the command lands, the output crosses the threshold (or the quantization step above it) after this long
+        double crossing = threshold;
+        if (s.resolution > 0.0f) {
+            crossing = std::ceil((threshold + 0.5 * s.resolution) / s.resolution) * s.resolution - 0.5 * s.resolution;
+        }
+        double rise_us = -s.time_constant * std::log(1.0 - crossing / step) * 1e6;
+        double expected = s.dead_time_us + rise_us;
+
+        auto measured = probe.measure(hotel::device_kind::motor, 1, [&] { plant.command(step); },
+                                      [&] { return plant.output(); },
+                                      {.threshold = threshold, .sample_period_us = s.sample_period_us});
+        bool ok = measured && *measured >= expected && *measured <= expected + s.sample_period_us;
+        failures += !ok;
+        std::printf("%10u %8.2f %10.1f %8u %10.0f %10.0f %6s\n", s.dead_time_us, s.time_constant, s.resolution,
+                    s.sample_period_us, expected, measured ? static_cast<double>(*measured) : -1.0,
+                    ok ? "ok" : "FAIL");
+    }
+
+    // a response that takes longer than the timeout is a timeout, not a latency
+    sim_clock::reset();
+    hotel::sim::first_order_plant<sim_clock> slow{{.gain = 1.0f, .time_constant = 0.08f, .dead_time_us = 250000}};
+    hotel::latency_probe<1, sim_clock> probe;
+    auto measured = probe.measure(hotel::device_kind::motor, 1, [&] { slow.command(step); },
+                                  [&] { return slow.output(); }, {.timeout_us = 200000});
+    bool timed_out = !measured && probe.results(hotel::device_kind::motor, 1)->timeouts == 1;
+    failures += !timed_out;
+    std::printf("\n250 ms dead time, 200 ms timeout: %s\n", timed_out ? "timed out (ok)" : "FAIL");
+
+    return failures ? 1 : 0;
+}
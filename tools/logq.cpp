@@ -0,0 +1,313 @@
+/**
+ * @file logq.cpp
+ *
+ * host-side query tool for columnar match logs (see hotel/log/columnar.hpp)
+ *
+ * every file is `mmap`ed and handed to a pool of worker threads, one file at a time, so a directory full of matches is
+ * scanned on all cores. only the columns named on the command line are decoded, and chunks are skipped using their
+ * index whenever the time window or the threshold rules them out (their samples are still counted). with `-a`, a sample
+ * above the threshold counts as above until the next one, even if that's in the next chunk, or for one sample period
+ * if there's a gap in the log after it.
+ *
+ * build with `make tools` (uses the host compiler), then e.g.
+ * ```
+ * bin/logq -c lift_current -a 2.0 logs/match*.hcl    # how long was the lift above 2A, across all matches
+ * bin/logq -t 0:15 -f logs/match*.hcl                # per-file stats for every channel during autonomous
+ * ```
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hotel/log/columnar.hpp"
+
+namespace {
+    struct options {
+        std::vector<std::string> channels;
+        std::optional<double> from;
+        std::optional<double> to;
+        std::optional<float> threshold;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        bool per_file = false;
+        std::vector<std::string> files;
+    };
+
+    struct stats {
+        std::uint64_t samples = 0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        double sum = 0.0;
+        std::uint64_t above = 0;
+        double above_seconds = 0.0;
+        std::uint64_t chunks_skipped = 0;
+
+        void merge(const stats& other) {
+            samples += other.samples;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+            sum += other.sum;
+            above += other.above;
+            above_seconds += other.above_seconds;
+            chunks_skipped += other.chunks_skipped;
+        };
+    };
+
+    using results = std::map<std::string, stats>;
+
+    void usage(const char* self) {
+        std::fprintf(stderr,
+                     "usage: %s [-c channel]... [-t from:to] [-a threshold] [-j threads] [-f] file...\n"
+                     "  -c  channel to query (repeatable; default: every channel)\n"
+                     "  -t  only samples within [from, to] seconds of each log's first sample\n"
+                     "  -a  count samples (and time) above threshold instead of full stats\n"
+                     "  -j  worker threads (default: all cores)\n"
+                     "  -f  print results for each file as well as the total\n",
+                     self);
+        std::exit(2);
+    }
+
+    options parse(int argc, char** argv) {
+        options opts;
+        int c;
+        while ((c = getopt(argc, argv, "c:t:a:j:f")) != -1) {
+            switch (c) {
+                case 'c':
+                    opts.channels.emplace_back(optarg);
+                    break;
+                case 't': {
+                    double from, to;
+                    if (std::sscanf(optarg, "%lf:%lf", &from, &to) != 2) {
+                        usage(argv[0]);
+                    }
+                    opts.from = from;
+                    opts.to = to;
+                    break;
+                }
+                case 'a':
+                    opts.threshold = std::strtof(optarg, nullptr);
+                    break;
+                case 'j':
+                    opts.threads = std::max(1, std::atoi(optarg));
+                    break;
+                case 'f':
+                    opts.per_file = true;
+                    break;
+                default:
+                    usage(argv[0]);
+            }
+        }
+
+        for (int i = optind; i < argc; i++) {
+            opts.files.emplace_back(argv[i]);
+        }
+        if (opts.files.empty()) {
+            usage(argv[0]);
+        }
+
+        return opts;
+    }
+
+    bool query(const std::string& path, const options& opts, results& out) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            return false;
+        }
+
+        auto size = static_cast<std::size_t>(info.st_size);
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+
+        hotel::log::column_reader reader{static_cast<const std::uint8_t*>(mapped), size};
+        if (!reader.valid()) {
+            munmap(mapped, size);
+            return false;
+        }
+
+        std::vector<std::size_t> selected;
+        for (std::size_t c = 0; c < reader.channel_list().size(); c++) {
+            std::string name{reader.channel_list()[c].name};
+            if (opts.channels.empty() || std::find(opts.channels.begin(), opts.channels.end(), name) != opts.channels.end()) {
+                selected.push_back(c);
+            }
+        }
+
+        std::optional<std::uint64_t> origin;
+        std::uint64_t from = 0, to = std::numeric_limits<std::uint64_t>::max();
+        std::vector<std::uint64_t> timestamps;
+        std::vector<float> values;
+        // per channel, when the last sample was above the threshold: it stays above until the next sample, which may
+        // be in the next chunk
+        std::vector<std::optional<std::uint64_t>> above_since(reader.channel_list().size());
+        std::uint64_t last_us = 0, period_us = 0;
+
+        reader.for_each_chunk([&](const hotel::log::column_reader::chunk& chunk) {
+            const auto& header = chunk.header();
+            if (!origin) {
+                origin = header.first_us;
+                if (opts.from) {
+                    from = *origin + static_cast<std::uint64_t>(*opts.from * 1e6);
+                    to = *origin + static_cast<std::uint64_t>(*opts.to * 1e6);
+                }
+            }
+            // a gap of more than a couple of periods (logging paused, or a corrupt chunk skipped) ends the time above
+            // one period after the last sample before it
+            if (period_us && header.first_us - last_us > 2 * period_us) {
+                for (std::size_t c = 0; c < above_since.size(); c++) {
+                    if (auto& since = above_since[c]) {
+                        out[std::string{reader.channel_list()[c].name}].above_seconds +=
+                            (std::min(last_us + period_us, to) - *since) * 1e-6;
+                        since.reset();
+                    }
+                }
+            }
+            last_us = header.last_us;
+            if (header.samples > 1) {
+                period_us = (header.last_us - header.first_us) / (header.samples - 1);
+            }
+
+            if (header.first_us > to) {
+                return false;
+            }
+            if (header.last_us < from) {
+                return true;
+            }
+
+            bool timestamps_decoded = false;
+            auto decode_timestamps = [&] {
+                if (!timestamps_decoded) {
+                    timestamps.resize(chunk.samples());
+                    values.resize(chunk.samples());
+                    chunk.timestamps(timestamps);
+                    timestamps_decoded = true;
+                }
+            };
+            auto in_window = [&] (std::uint64_t t) { return t >= from && t <= to; };
+
+            for (auto c : selected) {
+                auto& s = out[std::string{reader.channel_list()[c].name}];
+                auto& since = above_since[c];
+                if (opts.threshold && chunk.index(c).max <= *opts.threshold) {
+                    // nothing in here is above, so the time above ends where the chunk starts; its samples still count
+                    s.chunks_skipped++;
+                    if (since) {
+                        s.above_seconds += (std::min(header.first_us, to) - *since) * 1e-6;
+                        since.reset();
+                    }
+                    if (header.first_us >= from && header.last_us <= to) {
+                        s.samples += chunk.samples();
+                    } else {
+                        decode_timestamps();
+                        s.samples += std::count_if(timestamps.begin(), timestamps.end(), in_window);
+                    }
+                    continue;
+                }
+
+                decode_timestamps();
+                chunk.values(c, timestamps, values);
+
+                for (std::size_t i = 0; i < chunk.samples(); i++) {
+                    if (since) {
+                        s.above_seconds += (std::min(timestamps[i], to) - *since) * 1e-6;
+                        since.reset();
+                    }
+                    if (!in_window(timestamps[i])) {
+                        continue;
+                    }
+
+                    double v = values[i];
+                    s.samples++;
+                    s.min = std::min(s.min, v);
+                    s.max = std::max(s.max, v);
+                    s.sum += v;
+                    if (opts.threshold && v > *opts.threshold) {
+                        s.above++;
+                        since = timestamps[i];
+                    }
+                }
+            }
+            return true;
+        });
+
+        munmap(mapped, size);
+        return true;
+    }
+
+    void print(const char* label, const results& r, const options& opts) {
+        for (const auto& [name, s] : r) {
+            if (opts.threshold) {
+                std::printf("%-24s %-24s samples %10llu  above %10llu  %9.3fs above  (%llu chunks not decoded)\n",
+                            label, name.c_str(), static_cast<unsigned long long>(s.samples),
+                            static_cast<unsigned long long>(s.above), s.above_seconds,
+                            static_cast<unsigned long long>(s.chunks_skipped));
+            } else {
+                std::printf("%-24s %-24s samples %10llu  min %12g  max %12g  mean %12g\n",
+                            label, name.c_str(), static_cast<unsigned long long>(s.samples),
+                            s.samples ? s.min : 0.0, s.samples ? s.max : 0.0, s.samples ? s.sum / s.samples : 0.0);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    auto opts = parse(argc, argv);
+
+    std::vector<results> per_file(opts.files.size());
+    std::vector<char> ok(opts.files.size());
+    std::atomic<std::size_t> next{0};
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::min<std::size_t>(opts.threads, opts.files.size()); t++) {
+        workers.emplace_back([&] {
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < opts.files.size();) {
+                ok[i] = query(opts.files[i], opts, per_file[i]);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    results total;
+    int status = 0;
+    for (std::size_t i = 0; i < opts.files.size(); i++) {
+        if (!ok[i]) {
+            std::fprintf(stderr, "%s: not a readable columnar log\n", opts.files[i].c_str());
+            status = 1;
+            continue;
+        }
+        if (opts.per_file) {
+            print(opts.files[i].c_str(), per_file[i], opts);
+        }
+        for (const auto& [name, s] : per_file[i]) {
+            total[name].merge(s);
+        }
+    }
+    print("total", total, opts);
+
+    return status;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file mux_peer.cpp
+ *
+ * host-side peer for `hotel::link_mux` (see hotel/link_mux.hpp)
+ *
+ * pointed at a serial device, it runs the other end of the brain's mux: every message received is printed as
+ * `ch<n> <size> <hex>`, and every line typed on stdin is sent on the chosen channel. both ends have to use the same
+ * channel count and queue size (the defaults, 4 and 1024, unless this file is changed to match).
+ *
+ * with `-t` it instead opens a pty pair and runs both ends against each other for a few seconds: one saturates a
+ * budgeted low-priority channel with a bulk transfer while sending timestamped telemetry on a high-priority one, and the
+ * other checks that everything arrives intact and reports telemetry latency and bulk throughput.
+ *
+ * build with `make tools` (uses the host compiler), then e.g.
+ * ```
+ * bin/mux_peer -b 230400 -c 1 /dev/ttyACM1
+ * bin/mux_peer -t
+ * ```
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "hotel/link_mux.hpp"
+
+namespace {
+    struct host_clock {
+        static std::uint64_t now() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+
+        static void wait_until(std::uint64_t t) {
+            auto current = now();
+            if (t > current) {
+                std::this_thread::sleep_for(std::chrono::microseconds(t - current));
+            }
+        };
+    };
+
+    /// `hotel::concepts::SerialLink` over a file descriptor
+    struct fd_link {
+        int fd;
+        /// the kernel doesn't report a tty's output buffer size, so assume a conservative one
+        static constexpr int buffer = 4095;
+
+        std::int32_t read(std::uint8_t* out, std::int32_t length) {
+            auto n = ::read(fd, out, static_cast<std::size_t>(length));
+            return n < 0 ? 0 : static_cast<std::int32_t>(n);
+        };
+
+        std::int32_t write(const std::uint8_t* in, std::int32_t length) {
+            auto n = ::write(fd, in, static_cast<std::size_t>(length));
+            return n < 0 ? 0 : static_cast<std::int32_t>(n);
+        };
+
+        std::int32_t get_read_avail() const {
+            int n = 0;
+            return ioctl(fd, FIONREAD, &n) == 0 ? n : 0;
+        };
+
+        std::int32_t get_write_free() const {
+            int queued = 0;
+            if (ioctl(fd, TIOCOUTQ, &queued) != 0) {
+                return 0;
+            }
+            return std::max(0, buffer - queued);
+        };
+    };
+
+    using mux = hotel::link_mux<fd_link, 4, 1024, host_clock>;
+
+    bool make_raw(int fd, speed_t baud) {
+        termios t{};
+        if (tcgetattr(fd, &t) != 0) {
+            return false;
+        }
+        cfmakeraw(&t);
+        if (baud) {
+            cfsetispeed(&t, baud);
+            cfsetospeed(&t, baud);
+        }
+        t.c_cc[VMIN] = 0;
+        t.c_cc[VTIME] = 0;
+        return tcsetattr(fd, TCSANOW, &t) == 0 && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) == 0;
+    }
+
+    speed_t baud_constant(long baud) {
+        switch (baud) {
+            case 9600: return B9600;
+            case 19200: return B19200;
+            case 38400: return B38400;
+            case 57600: return B57600;
+            case 115200: return B115200;
+            case 230400: return B230400;
+            case 460800: return B460800;
+            case 921600: return B921600;
+            default: return 0;
+        }
+    }
+
+    int peer(const char* device, long baud, std::size_t channel) {
+        int fd = open(device, O_RDWR | O_NOCTTY);
+        if (fd < 0 || !make_raw(fd, baud_constant(baud))) {
+            std::perror(device);
+            return 1;
+        }
+        fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+
+        fd_link link{fd};
+        mux m{link, {{{.priority = 3}, {.priority = 2}, {.priority = 1}, {.priority = 0}}}};
+        std::string line;
+        std::uint8_t message[mux::max_message];
+
+        while (true) {
+            pollfd fds[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+            poll(fds, 2, 5);
+
+            char c;
+            while (::read(STDIN_FILENO, &c, 1) == 1) {
+                if (c != '\n') {
+                    line += c;
+                    continue;
+                }
+                if (!m.send(channel, {reinterpret_cast<const std::uint8_t*>(line.data()),
+                                      std::min(line.size(), mux::max_message)})) {
+                    std::fprintf(stderr, "channel %zu is full\n", channel);
+                }
+                line.clear();
+            }
+
+            m.service();
+            for (std::size_t ch = 0; ch < 4; ch++) {
+                for (std::size_t n; (n = m.receive(ch, message));) {
+                    std::printf("ch%zu %zu ", ch, n);
+                    for (std::size_t i = 0; i < n; i++) {
+                        std::printf("%02x", message[i]);
+                    }
+                    std::printf("\n");
+                }
+            }
+            std::fflush(stdout);
+        }
+    }
+
+    int self_test(double seconds) {
+        int brain_fd, host_fd;
+        if (openpty(&brain_fd, &host_fd, nullptr, nullptr, nullptr) != 0 || !make_raw(brain_fd, 0) ||
+            !make_raw(host_fd, 0)) {
+            std::perror("openpty");
+            return 1;
+        }
+
+        constexpr std::size_t telemetry = 0, bulk = 2;
+        constexpr std::uint32_t bulk_rate = 20000;
+        std::atomic<bool> done{false};
+        std::uint32_t telemetry_sent = 0;
+
+        // the "brain": 100Hz telemetry, and a bulk transfer that never lets up
+        std::thread brain{[&] {
+            fd_link link{brain_fd};
+            mux m{link, {{{.priority = 3}, {.priority = 2}, {.priority = 1, .bytes_per_second = bulk_rate}, {}}}};
+            std::uint32_t next = 0;
+            auto last = host_clock::now();
+            while (!done) {
+                auto now = host_clock::now();
+                if (now - last >= 10000) {
+                    last = now;
+                    std::uint8_t message[32] = {};
+                    std::memcpy(message, &now, sizeof(now));
+                    telemetry_sent += m.send(telemetry, message);
+                }
+                while (true) {
+                    std::uint8_t message[200];
+                    std::memcpy(message, &next, sizeof(next));
+                    for (std::size_t i = sizeof(next); i < sizeof(message); i++) {
+                        message[i] = static_cast<std::uint8_t>(next + i);
+                    }
+                    if (!m.send(bulk, message)) {
+                        break;
+                    }
+                    next++;
+                }
+                m.service();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }};
+
+        // the host
+        fd_link link{host_fd};
+        mux m{link, {{{.priority = 3}, {.priority = 2}, {.priority = 1}, {}}}};
+        std::uint32_t telemetry_received = 0, bulk_received = 0, bulk_expected = 0, errors = 0;
+        double latency_sum = 0.0, latency_max = 0.0;
+        std::uint8_t message[mux::max_message];
+        auto start = host_clock::now();
+        while (host_clock::now() - start < seconds * 1e6) {
+            m.service();
+            for (std::size_t n; (n = m.receive(telemetry, message));) {
+                std::uint64_t sent;
+                std::memcpy(&sent, message, sizeof(sent));
+                double latency = (host_clock::now() - sent) * 1e-3;
+                latency_sum += latency;
+                latency_max = std::max(latency_max, latency);
+                telemetry_received++;
+            }
+            for (std::size_t n; (n = m.receive(bulk, message));) {
+                std::uint32_t index;
+                std::memcpy(&index, message, sizeof(index));
+                errors += n != 200 || index != bulk_expected || message[199] != static_cast<std::uint8_t>(index + 199);
+                bulk_expected = index + 1;
+                bulk_received++;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        done = true;
+        brain.join();
+
+        auto elapsed = (host_clock::now() - start) * 1e-6;
+        std::printf("telemetry: %u of %u received, latency mean %.2fms max %.2fms\n", telemetry_received, telemetry_sent,
+                    telemetry_received ? latency_sum / telemetry_received : 0.0, latency_max);
+        std::printf("bulk: %u received, %.0f B/s (budget %u B/s), %u out of order or corrupt\n", bulk_received,
+                    bulk_received * 200 / elapsed, bulk_rate, errors);
+        return errors || !telemetry_received || !bulk_received;
+    }
+
+    void usage(const char* self) {
+        std::fprintf(stderr,
+                     "usage: %s [-b baud] [-c channel] device\n"
+                     "       %s -t [seconds]\n"
+                     "  -b  baud rate to set on the device (default: leave it alone)\n"
+                     "  -c  channel to send stdin lines on (default: 1)\n"
+                     "  -t  run both ends against each other over a pty and report\n",
+                     self, self);
+        std::exit(2);
+    }
+}
+
+int main(int argc, char** argv) {
+    long baud = 0;
+    std::size_t channel = 1;
+    bool test = false;
+    int c;
+    while ((c = getopt(argc, argv, "b:c:t")) != -1) {
+        switch (c) {
+            case 'b':
+                baud = std::atol(optarg);
+                break;
+            case 'c':
+                channel = std::min<std::size_t>(std::strtoul(optarg, nullptr, 10), 3);
+                break;
+            case 't':
+                test = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (test) {
+        return self_test(optind < argc ? std::atof(argv[optind]) : 3.0);
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+    return peer(argv[optind], baud, channel);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file odometry_check.cpp
+ *
+ * host-side check of `hotel::odometry_calibration` (see hotel/odometry_calibration.hpp) against a simulated robot
+ *
+ * the simulated robot's true geometry is off from the nominal one by up to 0.13 in per wheel diameter or offset, and
+ * its IMU reads 1.2% short. it runs the calibration script twice over: five turns clockwise and five back, then 96 in
+ * forwards and 96 in back (with a little heading wobble), about 3000 samples in all. the encoders are quantized to
+ * 0.01 degree, the IMU has 0.01 degree of noise, and the perpendicular wheel picks up 0.002 in of scrub per sample.
+ *
+ * the fit has to converge, and every parameter has to come back within 0.002 in (or 0.0002 of the IMU scale) of the
+ * truth; the saved file has to load back to the same geometry. then both the nominal and the fitted geometry dead
+ * reckon a 900 in path (straights with 90 degree turns between them) from the parallel wheels alone, and the fit has
+ * to end up within an inch of where the robot really is.
+ *
+ * reported are the nominal, fitted and true parameters, the solver's iterations and time, and the dead-reckoning
+ * error with each geometry. exits with a non-zero status if any of the above doesn't hold.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/odometry_check
+ * ```
+ */
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/odometry_calibration.hpp"
+#include "hotel/sim/plant.hpp"
+
+namespace {
+    using sim_clock = hotel::sim::virtual_clock;
+    constexpr double pi = std::numbers::pi;
+
+    const hotel::odometry_geometry nominal{2.75, 2.75, 2.75, 5.25, 5.25, -2.5, 1.0};
+    const hotel::odometry_geometry truth{2.783, 2.761, 2.745, 5.37, 5.12, -2.6, 1.012};
+
+    /// the simulated robot: true encoder positions (in degrees) and heading
+    struct robot {
+        double left = 0.0, right = 0.0, side = 0.0, heading = 0.0;
+        std::mt19937 rng{5};
+        std::normal_distribution<double> noise{0.0, 1.0};
+
+        void move(double forward, double turn_degrees) {
+            double turn = turn_degrees * pi / 180.0;
+            left += (forward + truth.left_offset * turn) / (pi * truth.left_diameter) * 360.0;
+            right += (forward - truth.right_offset * turn) / (pi * truth.right_diameter) * 360.0;
+            side += (truth.side_offset * turn + 0.002 * noise(rng)) / (pi * truth.side_diameter) * 360.0;
+            heading += turn_degrees;
+        };
+
+        hotel::odometry_sample read() {
+            return {std::round(left * 100.0) / 100.0, std::round(right * 100.0) / 100.0,
+                    std::round(side * 100.0) / 100.0, heading / truth.imu_scale + 0.01 * noise(rng)};
+        };
+    };
+
+    /// dead-reckon a 900 in path from the parallel wheels with the given geometry; returns the final position error
+    double dead_reckoning_error(const hotel::odometry_geometry& g) {
+        double x = 0.0, y = 0.0, heading = 0.0, true_x = 0.0, true_y = 0.0, true_heading = 0.0;
+        for (int i = 0; i < 3000; i++) {
+            double forward = 0.3, turn = (i % 500 < 400 ? 0.0 : 0.9) * pi / 180.0;
+            double left_degrees = (forward + truth.left_offset * turn) / (pi * truth.left_diameter) * 360.0;
+            double right_degrees = (forward - truth.right_offset * turn) / (pi * truth.right_diameter) * 360.0;
+
+            double left = left_degrees * pi * g.left_diameter / 360.0;
+            double right = right_degrees * pi * g.right_diameter / 360.0;
+            double rotation = (left - right) / (g.left_offset + g.right_offset);
+            double travel = (g.right_offset * left + g.left_offset * right) / (g.left_offset + g.right_offset);
+            x += travel * std::cos(heading + rotation / 2.0);
+            y += travel * std::sin(heading + rotation / 2.0);
+            heading += rotation;
+
+            true_x += forward * std::cos(true_heading + turn / 2.0);
+            true_y += forward * std::sin(true_heading + turn / 2.0);
+            true_heading += turn;
+        }
+        return std::hypot(x - true_x, y - true_y);
+    }
+
+    void show(const char* name, const hotel::odometry_geometry& g) {
+        std::printf("%-8s", name);
+        for (double v : g.as_array()) {
+            std::printf(" %9.4f", v);
+        }
+        std::printf("\n");
+    }
+}
+
+int main() {
+    robot r;
+    hotel::odometry_calibration<8192, 16, sim_clock> calibration{[&] { return r.read(); }, nominal};
+    for (int repeat = 0; repeat < 2; repeat++) {
+        for (double direction : {1.0, -1.0}) {
+            int n = 0;
+            calibration.spin(1800.0 * direction, [&] {
+                if (n++ == 500) {
+                    return true;
+                }
+                r.move(0.0, 3.6 * direction);
+                return false;
+            });
+        }
+        for (double direction : {1.0, -1.0}) {
+            int n = 0;
+            calibration.straight(96.0 * direction, [&] {
+                if (n++ == 240) {
+                    return true;
+                }
+                r.move(0.4 * direction, 0.05 * r.noise(r.rng));
+                return false;
+            });
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto fit = calibration.solve();
+    auto solve_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-8s %9s %9s %9s %9s %9s %9s %9s\n", "", "left d", "right d", "side d", "left o", "right o",
+                "side o", "imu");
+    show("nominal", nominal);
+    show("fit", fit.geometry);
+    show("truth", truth);
+
+    int failures = 0;
+    auto fitted = fit.geometry.as_array();
+    auto expected = truth.as_array();
+    double worst_length = 0.0, worst_scale = std::fabs(fitted[6] - expected[6]);
+    for (std::size_t i = 0; i < 6; i++) {
+        worst_length = std::max(worst_length, std::fabs(fitted[i] - expected[i]));
+    }
+    bool recovered = fit.solver.converged && worst_length <= 0.002 && worst_scale <= 0.0002;
+    failures += !recovered;
+    std::printf("\n%zu samples, %u iterations, %.1f ms: converged %s, worst error %.4f in, %.5f of scale %s\n",
+                calibration.size(), fit.solver.iterations, solve_ms, fit.solver.converged ? "yes" : "no",
+                worst_length, worst_scale, recovered ? "ok" : "FAIL");
+
+    const char* path = "odometry_check.bin";
+    auto saved = hotel::calibrate_odometry(calibration, path);
+    auto loaded = hotel::odometry_geometry::load(path);
+    bool round_trip = loaded && loaded->as_array() == saved.geometry.as_array();
+    std::remove(path);
+    failures += !round_trip;
+    std::printf("save and load: %s\n", round_trip ? "ok" : "FAIL");
+
+    double before = dead_reckoning_error(nominal), after = dead_reckoning_error(fit.geometry);
+    failures += !(after < 1.0);
+    std::printf("900 in path: %.2f in off with the nominal geometry, %.2f in with the fit %s\n", before, after,
+                after < 1.0 ? "ok" : "FAIL");
+    return failures ? 1 : 0;
+}
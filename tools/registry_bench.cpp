@@ -0,0 +1,222 @@
+/**
+ * @file registry_bench.cpp
+ *
+ * host-side benchmark of `hotel::controller_registry` (see hotel/controller_registry.hpp) against the usual
+ * `std::vector<std::unique_ptr<Base>>`
+ *
+ * the same mix of controllers is held both ways: take-back-half and PID + feedforward flywheel loops, self-tuning
+ * roller loops, and `hotel::pid_controller` position loops (stepped with `step()`), in equal numbers. the baseline wraps each in a class with a virtual `step()` and allocates them in the
+ * order a robot would register them, interleaved with the other allocations made while everything is set up. both
+ * are ticked from the same sensor readings, and the sums of their outputs are checked against each other.
+ *
+ * reported are the time per controller per tick, and the time to remove a random controller and add it back (what
+ * swapping mechanisms in and out costs), for a range of controller counts. the vector is churned two ways: erasing
+ * in place, which keeps everything else in order, and swapping the last element into the gap and popping it, which
+ * is constant time like the registry's remove but moves another controller to a different index.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/registry_bench
+ * ```
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <ratio>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/controller_registry.hpp"
+#include "hotel/flywheel.hpp"
+#include "hotel/pid.hpp"
+#include "hotel/self_tuning.hpp"
+#include "hotel/sim/plant.hpp"
+#include "hotel/sim/pros_clock.hpp"
+
+using sim_clock = hotel::sim::virtual_clock;
+
+namespace {
+
+    struct sensor {
+        const float* value;
+
+        float operator()() const { return *value; };
+    };
+
+    struct never {
+        bool operator()(float) const { return false; };
+    };
+
+    using position_pid = hotel::pid_controller<std::ratio<1, 2>, std::ratio<1, 2000>, std::ratio<0>, float, sensor,
+                                               float, never>;
+
+    using tbh_t = hotel::take_back_half_controller<sensor, sim_clock>;
+    using pidf_t = hotel::pid_feedforward_controller<sensor, sim_clock>;
+    using tuning_t = hotel::self_tuning_controller<sensor, never>;
+
+    constexpr std::size_t max_per_type = 1024;
+    using registry_t = hotel::basic_controller_registry<max_per_type, tbh_t, pidf_t, tuning_t, position_pid>;
+
+    struct base {
+        virtual ~base() = default;
+        virtual float step() = 0;
+    };
+
+    template <class C>
+    struct boxed final : base {
+        C controller;
+
+        explicit boxed(C c) : controller(std::move(c)) {};
+
+        float step() override { return controller.step(); };
+    };
+
+    /// the i-th controller of the mix, reading `sensors[i]`
+    template <class F>
+    void make(std::size_t i, const std::vector<float>& sensors, F&& emit) {
+        const float* s = &sensors[i];
+        switch (i % 4) {
+            case 0:
+                emit(tbh_t{{.gain = 400.0f, .kv = 20.0f}, sensor{s}, 450.0f});
+                break;
+            case 1:
+                emit(pidf_t{{.kv = 20.0f, .ks = 150.0f}, sensor{s}, 500.0f});
+                break;
+            case 2:
+                emit(tuning_t{{.nominal_gain = 4.7f, .nominal_time_constant = 0.15f}, sensor{s}, never{}, 300.0f});
+                break;
+            default:
+                emit(position_pid{sensor{s}, never{}, 360.0f});
+                break;
+        }
+    }
+
+    template <class F>
+    double seconds(F f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// next sensor readings: cheap, different per sensor, and the same for both sides
+    void move(std::vector<float>& sensors, std::uint32_t tick) {
+        for (std::size_t i = 0; i < sensors.size(); i++) {
+            sensors[i] = 300.0f + static_cast<float>((tick * 7 + i * 13) % 101);
+        }
+        sim_clock::advance(10000);
+    }
+}
+
+int main() {
+    std::printf("%-11s %25s %38s\n", "", "tick (ns per controller)", "remove + add (ns)");
+    std::printf("%-11s %12s %12s %12s %12s %12s\n", "controllers", "vector", "registry", "vector", "swap + pop",
+                "registry");
+
+    for (std::size_t n : {16u, 64u, 256u, 1024u, 4096u}) {
+        std::vector<float> sensors(n, 0.0f);
+        std::mt19937 rng{42};
+        sim_clock::reset();
+
+        std::vector<std::unique_ptr<base>> boxes;
+        std::vector<std::unique_ptr<char[]>> clutter;
+        std::uniform_int_distribution<std::size_t> clutter_size{16, 512};
+        for (std::size_t i = 0; i < n; i++) {
+            make(i, sensors, [&] (auto c) {
+                boxes.push_back(std::make_unique<boxed<decltype(c)>>(std::move(c)));
+            });
+            clutter.push_back(std::make_unique<char[]>(clutter_size(rng)));
+        }
+
+        auto registry = std::make_unique<registry_t>();
+        std::vector<registry_t::handle<tbh_t>> tbh;
+        std::vector<registry_t::handle<pidf_t>> pidf;
+        std::vector<registry_t::handle<tuning_t>> tuning;
+        std::vector<registry_t::handle<position_pid>> pid;
+        for (std::size_t i = 0; i < n; i++) {
+            make(i, sensors, [&] (auto c) {
+                auto h = registry->add(std::move(c));
+                if constexpr (std::is_same_v<decltype(c), tbh_t>) {
+                    tbh.push_back(h);
+                } else if constexpr (std::is_same_v<decltype(c), pidf_t>) {
+                    pidf.push_back(h);
+                } else if constexpr (std::is_same_v<decltype(c), tuning_t>) {
+                    tuning.push_back(h);
+                } else {
+                    pid.push_back(h);
+                }
+            });
+        }
+
+        // same number of controller steps at every size
+        std::uint32_t ticks = static_cast<std::uint32_t>(std::max<std::size_t>(4000000 / n, 100));
+        double vector_sum = 0.0, registry_sum = 0.0;
+        auto vector_time = seconds([&] {
+            sim_clock::reset();
+            for (std::uint32_t k = 0; k < ticks; k++) {
+                move(sensors, k);
+                for (auto& b : boxes) {
+                    vector_sum += b->step();
+                }
+            }
+        });
+        auto registry_time = seconds([&] {
+            sim_clock::reset();
+            for (std::uint32_t k = 0; k < ticks; k++) {
+                move(sensors, k);
+                registry->tick([&] (auto&, float output) { registry_sum += output; });
+            }
+        });
+        // the sensor updates, timed on their own, aren't part of either
+        auto sensor_time = seconds([&] {
+            for (std::uint32_t k = 0; k < ticks; k++) {
+                move(sensors, k);
+            }
+        });
+
+        if (std::fabs(vector_sum - registry_sum) > 1e-6 * std::fabs(vector_sum) + 1e-3) {
+            std::printf("mismatch at %zu controllers: %f vs %f\n", n, vector_sum, registry_sum);
+            return 1;
+        }
+
+        // churn: take a controller out and put it back (a random one from the vector, either closing the gap or
+        // filling it with the last one; a random PID loop from the registry, whose handles are typed)
+        constexpr int churn = 200000;
+        std::uniform_int_distribution<std::size_t> pick{0, pid.size() - 1};
+        std::uniform_int_distribution<std::size_t> pick_box{0, boxes.size() - 1};
+        auto vector_churn = seconds([&] {
+            for (int r = 0; r < churn; r++) {
+                auto it = boxes.begin() + static_cast<std::ptrdiff_t>(pick_box(rng));
+                auto moved = std::move(*it);
+                boxes.erase(it);
+                boxes.push_back(std::move(moved));
+            }
+        });
+        auto swap_churn = seconds([&] {
+            for (int r = 0; r < churn; r++) {
+                auto& slot = boxes[pick_box(rng)];
+                auto moved = std::move(slot);
+                slot = std::move(boxes.back());
+                boxes.pop_back();
+                boxes.push_back(std::move(moved));
+            }
+        });
+        auto registry_churn = seconds([&] {
+            for (int r = 0; r < churn; r++) {
+                auto& h = pid[pick(rng)];
+                auto c = *registry->get(h);
+                registry->remove(h);
+                h = registry->add(std::move(c));
+            }
+        });
+
+        double steps = static_cast<double>(ticks) * n;
+        std::printf("%-11zu %12.2f %12.2f %12.1f %12.1f %12.1f\n", n, (vector_time - sensor_time) * 1e9 / steps,
+                    (registry_time - sensor_time) * 1e9 / steps, vector_churn * 1e9 / churn, swap_churn * 1e9 / churn,
+                    registry_churn * 1e9 / churn);
+    }
+    return 0;
+}
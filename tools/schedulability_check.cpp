@@ -0,0 +1,141 @@
+/**
+ * @file schedulability_check.cpp
+ *
+ * host-side check of `hotel::task_set`'s response-time analysis (see hotel/schedulability.hpp) against
+ * `hotel::sim::fixed_priority_scheduler`
+ *
+ * random task sets of 2 to 8 tasks are generated from a fixed seed, with periods from 1 to 100 ms (some drawn from
+ * harmonic-ish values, some anywhere on a 0.5 ms grid) and the utilization split between them with UUniFast, at a
+ * total between 30% and 100%. each set is given rate-monotonic priorities, analyzed, and simulated for two seconds in
+ * three ways: every task released at once (the critical instant the analysis assumes), every task released at a
+ * random offset, and with only three priority levels to go round so that tasks end up sharing them.
+ *
+ * every task's worst simulated response has to be no more than the bound the analysis gave it, and no task the
+ * analysis calls schedulable may miss a deadline in the simulation. with every task released at once and a level per
+ * task, the analysis is exact, so for schedulable tasks the simulated worst case has to equal the bound too.
+ *
+ * reported per mode are the task sets and tasks checked, how many tasks were schedulable, how many simulated worst
+ * cases met the bound exactly, and the lowest ratio of simulated worst case to bound. exits with a non-zero status on
+ * any violation.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/schedulability_check
+ * ```
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "hotel/schedulability.hpp"
+#include "hotel/sim/scheduler.hpp"
+
+namespace {
+    constexpr std::size_t max_tasks = 8;
+    constexpr std::uint64_t horizon_us = 2000000;
+
+    enum class mode { synchronous, phased, shared };
+
+    struct tally {
+        const char* name;
+        std::uint32_t sets = 0;
+        std::uint32_t tasks = 0;
+        std::uint32_t schedulable = 0;
+        std::uint32_t exact = 0;
+        std::uint32_t over_bound = 0;
+        std::uint32_t missed = 0;
+        std::uint32_t not_exact = 0;
+        double lowest_ratio = 1.0;
+
+        bool ok() const { return !over_bound && !missed && !not_exact; };
+    };
+
+    hotel::task_set<max_tasks> random_set(std::mt19937& rng) {
+        static constexpr std::uint32_t harmonic_ms[] = {1, 2, 4, 5, 10, 20, 25, 50, 100};
+        auto n = std::uniform_int_distribution<std::size_t>{2, max_tasks}(rng);
+        auto total = std::uniform_real_distribution<double>{0.3, 1.0}(rng);
+        bool harmonic = std::uniform_int_distribution<int>{0, 1}(rng);
+
+        // UUniFast: an unbiased split of the total utilization between the tasks
+        hotel::task_set<max_tasks> set;
+        double remaining = total;
+        for (std::size_t i = 0; i < n; i++) {
+            double u = remaining;
+            if (i + 1 < n) {
+                u = remaining * (1.0 - std::pow(std::uniform_real_distribution<double>{0.0, 1.0}(rng), 1.0 / (n - i - 1)));
+            }
+            remaining -= u;
+
+            std::uint32_t period = harmonic
+                ? harmonic_ms[std::uniform_int_distribution<std::size_t>{0, std::size(harmonic_ms) - 1}(rng)] * 1000
+                : std::uniform_int_distribution<std::uint32_t>{2, 200}(rng) * 500;
+            set.add({.period_us = period, .wcet_us = std::max<std::uint32_t>(1, static_cast<std::uint32_t>(u * period))});
+        }
+        return set;
+    }
+
+    void check(tally& t, mode m, hotel::task_set<max_tasks> set, std::mt19937& rng) {
+        if (m == mode::shared) {
+            set.assign_rate_monotonic(TASK_PRIORITY_DEFAULT + 2, TASK_PRIORITY_DEFAULT);
+        } else {
+            set.assign_rate_monotonic();
+        }
+        set.analyze();
+
+        std::array<std::uint32_t, max_tasks> phases{};
+        if (m == mode::phased) {
+            for (std::size_t i = 0; i < set.size(); i++) {
+                phases[i] = std::uniform_int_distribution<std::uint32_t>{0, set[i].period_us - 1}(rng);
+            }
+        }
+        hotel::sim::fixed_priority_scheduler<max_tasks> sim{set, phases.data()};
+        sim.run(horizon_us);
+
+        bool distinct = true;
+        for (std::size_t i = 1; i < set.size(); i++) {
+            distinct = distinct && set[i].priority != set[i - 1].priority;
+        }
+
+        t.sets++;
+        for (std::size_t i = 0; i < set.size(); i++) {
+            t.tasks++;
+            if (!set[i].schedulable) {
+                continue;
+            }
+            t.schedulable++;
+            auto worst = sim.worst_response(i);
+            t.over_bound += worst > set[i].response_us;
+            t.missed += sim.misses(i) > 0;
+            t.exact += worst == set[i].response_us;
+            t.not_exact += m == mode::synchronous && distinct && worst != set[i].response_us;
+            t.lowest_ratio = std::min(t.lowest_ratio, static_cast<double>(worst) / set[i].response_us);
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng{105};
+    std::array<tally, 3> tallies{{{"synchronous"}, {"phased"}, {"shared"}}};
+
+    for (int k = 0; k < 3000; k++) {
+        auto set = random_set(rng);
+        check(tallies[0], mode::synchronous, set, rng);
+        check(tallies[1], mode::phased, set, rng);
+        check(tallies[2], mode::shared, set, rng);
+    }
+
+    int failures = 0;
+    std::printf("%-12s %6s %6s %12s %8s %10s %8s %8s %8s\n", "releases", "sets", "tasks", "schedulable", "exact",
+                "min ratio", "> bound", "missed", "");
+    for (const auto& t : tallies) {
+        std::printf("%-12s %6u %6u %12u %8u %10.3f %8u %8u %8s\n", t.name, t.sets, t.tasks, t.schedulable, t.exact,
+                    t.lowest_ratio, t.over_bound, t.missed, t.ok() ? "ok" : "FAIL");
+        failures += !t.ok();
+    }
+    return failures ? 1 : 0;
+}
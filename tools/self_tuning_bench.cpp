@@ -0,0 +1,143 @@
+/**
+ * @file self_tuning_bench.cpp
+ *
+ * host-side check that `hotel::self_tuning_controller` (see hotel/self_tuning.hpp) follows a plant that changes under
+ * it
+ *
+ * a roller's velocity (first order with 20 ms of dead time and a little measurement noise) is stepped between 200 and
+ * 400 rpm every 1.5 s for a minute, while the plant drifts the way it does over an event day:
+ *
+ * - 0-20 s: as nominal, 4.7 rpm per unit of `move()`, 150 ms time constant
+ * - 20-40 s: a sagging battery and a warm motor, 25% less gain and a 200 ms time constant
+ * - 40-60 s: then the mechanism gets stickier, 10 units of friction on top
+ *
+ * the same controller runs twice with the same nominal model and closed-loop target: once with retuning disabled (the
+ * gains placed for the nominal plant, as fixed `std::ratio` gains would be), and once retuning every 250 ms. for each
+ * phase the mean settle time of the steps, their overshoot and the integrated error are reported, along with the
+ * model's gain estimate against the true one at the end of the phase.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/self_tuning_bench
+ * ```
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+
+#include <cstdio>
+
+#include "hotel/self_tuning.hpp"
+
+namespace {
+    constexpr float period = 0.01f;
+
+    /// discrete first-order plant whose parameters can be changed on the fly
+    struct roller {
+        float gain = 4.7f;
+        float time_constant = 0.15f;
+        float friction = 0.0f;
+        float y = 0.0f;
+        std::array<float, 2> pending{};
+
+        float step(float u) {
+            float delayed = pending[0];
+            pending[0] = pending[1];
+            pending[1] = u;
+            float effective = delayed - (y > 0.0f ? friction : y < 0.0f ? -friction : 0.0f);
+            float a = std::exp(-period / time_constant);
+            y = a * y + (1.0f - a) * gain * effective;
+            return y;
+        };
+    };
+
+    struct phase {
+        const char* name;
+        float gain;
+        float time_constant;
+        float friction;
+    };
+
+    struct result {
+        double settle_ms = 0.0;
+        double overshoot = 0.0;
+        double iae = 0.0;
+        int unsettled = 0;
+        float estimated_gain = 0.0f;
+    };
+
+    std::array<result, 3> run(bool retune, const std::array<phase, 3>& phases) {
+        roller plant;
+        std::mt19937 rng{7};
+        std::uniform_real_distribution<float> noise{-2.0f, 2.0f};
+        float measured = 0.0f;
+
+        using controller_t = hotel::self_tuning_controller<>;
+        controller_t controller{{.nominal_gain = 4.7f, .nominal_time_constant = 0.15f, .delay = 2,
+                                 .closed_loop_time_constant = 0.1f, .forgetting = 0.995f,
+                                 .retune_ticks = retune ? 25u : std::numeric_limits<std::uint32_t>::max()},
+                                [&] { return measured; }, [] (float) { return false; }, 200.0f};
+
+        std::array<result, 3> out{};
+        constexpr int ticks_per_phase = 2000, ticks_per_step = 150;
+        for (std::size_t p = 0; p < phases.size(); p++) {
+            plant.gain = phases[p].gain;
+            plant.time_constant = phases[p].time_constant;
+            plant.friction = phases[p].friction;
+            int steps = 0;
+            for (int s = 0; s < ticks_per_phase / ticks_per_step; s++) {
+                float from = controller.setpoint(), to = from == 200.0f ? 400.0f : 200.0f;
+                controller.target(to);
+                int last_outside = 0;
+                float peak = 0.0f;
+                for (int k = 0; k < ticks_per_step; k++) {
+                    measured = plant.y + noise(rng);
+                    float y = plant.step(controller.step());
+                    float e = std::fabs(to - y);
+                    if (e > 10.0f) {
+                        last_outside = k + 1;
+                    }
+                    peak = std::max(peak, (y - to) / (to - from));
+                    out[p].iae += e * period;
+                }
+                // the first step of a phase includes the change itself
+                if (s == 0) {
+                    continue;
+                }
+                steps++;
+                if (last_outside == ticks_per_step) {
+                    out[p].unsettled++;
+                }
+                out[p].settle_ms += last_outside * period * 1000.0;
+                out[p].overshoot = std::max<double>(out[p].overshoot, peak);
+            }
+            out[p].settle_ms /= steps;
+            out[p].estimated_gain = controller.plant().gain();
+        }
+        return out;
+    }
+}
+
+int main() {
+    std::array<phase, 3> phases{{
+        {"nominal", 4.7f, 0.15f, 0.0f},
+        {"sagging", 3.5f, 0.2f, 0.0f},
+        {"sticky", 3.5f, 0.2f, 10.0f},
+    }};
+    auto fixed = run(false, phases);
+    auto tuned = run(true, phases);
+
+    std::printf("%-9s %-7s %21s %21s %21s %15s\n", "", "", "mean settle (ms)", "worst overshoot (%)", "IAE (rpm*s)",
+                "gain estimate");
+    std::printf("%-9s %-7s %10s %10s %10s %10s %10s %10s %15s\n", "phase", "gain", "fixed", "tuned", "fixed", "tuned",
+                "fixed", "tuned", "tuned");
+    for (std::size_t p = 0; p < phases.size(); p++) {
+        std::printf("%-9s %-7.2f %10.0f %10.0f %10.1f %10.1f %10.1f %10.1f %15.2f\n", phases[p].name, phases[p].gain,
+                    fixed[p].settle_ms, tuned[p].settle_ms, 100.0 * fixed[p].overshoot, 100.0 * tuned[p].overshoot,
+                    fixed[p].iae, tuned[p].iae, tuned[p].estimated_gain);
+    }
+    return 0;
+}
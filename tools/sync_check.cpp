@@ -0,0 +1,242 @@
+/**
+ * @file sync_check.cpp
+ *
+ * host-side check that `hotel::state_sync` (see hotel/state_sync.hpp) converges over a link that loses and reorders
+ * messages
+ *
+ * two syncs talk across a `hotel::sim::serial_pair` at 115200 baud, on `hotel::sim::virtual_clock`, each publishing a
+ * struct the other subscribes to and serviced every 10 ms. each end writes through a stand-in that drops whole frames
+ * and holds others back until a later one has gone out and been read (reordering them), in both directions, so
+ * updates, deltas and acks all go missing or arrive late; bit errors on the line are thrown in for some runs as well.
+ *
+ * every update carries the tick it was made on, and the publisher keeps every value it's had, so each time the
+ * subscriber's copy changes it's checked to be exactly one of them (a delta applied to the wrong base would show up
+ * here) and to be no older than the one before it. after three seconds of changing every tick the published values
+ * stop moving, and both copies have to match them within 2.5 seconds (the keyframe period, plus a resend or two).
+ * some runs also restart one end, starting its sequence numbers over: halfway through, or within the first few ticks,
+ * while the other end's sequence numbers are still close enough to the new ones to be mistaken for them.
+ *
+ * reported per run are the frames lost and reordered, the longest the subscriber was behind while the values were
+ * moving, and how long it took to catch up once they stopped. exits with a non-zero status if any run sees a value
+ * that was never published, goes backwards, or doesn't converge.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/sync_check
+ * ```
+ */
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "hotel/sim/serial.hpp"
+#include "hotel/state_sync.hpp"
+
+namespace {
+    using sim_clock = hotel::sim::virtual_clock;
+    using port = hotel::sim::loopback_serial<>;
+
+    /// a link that loses some frames and delays others past the next one; `state_sync` writes a frame per call
+    struct unreliable {
+        port* inner;
+        double loss;
+        double reorder;
+        std::mt19937 rng;
+        std::vector<std::uint8_t> held;
+        std::uint64_t held_at = 0;
+        bool overtaken = false;
+        std::uint32_t dropped = 0;
+        std::uint32_t reordered = 0;
+
+        bool chance(double p) { return std::uniform_real_distribution<double>{0.0, 1.0}(rng) < p; };
+
+        void release() {
+            if (!held.empty()) {
+                inner->write(held.data(), static_cast<std::int32_t>(held.size()));
+                held.clear();
+                overtaken = false;
+            }
+        };
+
+        /**
+         * called between services: a held frame goes out once the one that overtook it has had a chance to be
+         * applied, or on its own, late, if nothing has overtaken it for a while
+         */
+        void tick() {
+            if (!held.empty() && (overtaken || sim_clock::now() - held_at > 30000)) {
+                release();
+            }
+        };
+
+        std::int32_t write(const std::uint8_t* buffer, std::int32_t length) {
+            if (chance(loss)) {
+                dropped++;
+                return length;
+            }
+            if (held.empty() && chance(reorder)) {
+                held.assign(buffer, buffer + length);
+                held_at = sim_clock::now();
+                reordered++;
+                return length;
+            }
+            overtaken = overtaken || !held.empty();
+            return inner->write(buffer, length);
+        };
+
+        std::int32_t read(std::uint8_t* buffer, std::int32_t length) { return inner->read(buffer, length); };
+
+        std::int32_t get_read_avail() const { return inner->get_read_avail(); };
+
+        std::int32_t get_write_free() const { return inner->get_write_free(); };
+    };
+
+    using sync_t = hotel::state_sync<unreliable, 8, 64, 8, sim_clock>;
+
+    struct pose {
+        std::uint32_t tick;
+        float x, y, theta;
+    };
+
+    struct status {
+        std::uint32_t tick;
+        float voltage;
+        std::uint8_t mode[8];
+    };
+
+    /// follows one direction: every value published, and what the subscriber has shown so far
+    template <class T>
+    struct tracker {
+        std::vector<T> published;
+        std::uint32_t last_seen = 0;
+        std::uint32_t max_lag = 0;
+        bool bad = false;
+
+        void check(const T& copy, std::uint32_t now_tick, bool moving) {
+            if (copy.tick >= published.size() ||
+                std::memcmp(&copy, &published[copy.tick], sizeof(T)) != 0 || copy.tick < last_seen) {
+                bad = true;
+                return;
+            }
+            last_seen = copy.tick;
+            if (moving && now_tick - copy.tick > max_lag) {
+                max_lag = now_tick - copy.tick;
+            }
+        };
+    };
+
+    struct scenario {
+        double loss;
+        double reorder;
+        float error_rate;
+        /// replace one end with a fresh sync on this tick (0 for never)
+        std::uint32_t restart_at = 0;
+    };
+
+    constexpr std::uint32_t moving_ticks = 300;
+    constexpr std::uint32_t total_ticks = 600;
+    constexpr std::uint32_t converge_ticks = 250;
+
+    bool run(const scenario& s, std::uint32_t seed) {
+        sim_clock::reset(1000000);
+        hotel::sim::serial_pair<> wire{{.bytes_per_second = 11520, .error_rate = s.error_rate, .seed = seed}};
+        unreliable a_link{&wire.a, s.loss, s.reorder, std::mt19937{seed}, {}};
+        unreliable b_link{&wire.b, s.loss, s.reorder, std::mt19937{seed + 1}, {}};
+        std::optional<sync_t> a;
+        sync_t b{b_link};
+
+        pose a_pose{0, 0.0f, 0.0f, 0.0f}, b_pose{};
+        status b_status{0, 12.8f, {}}, a_status{};
+        auto start_a = [&] {
+            a.emplace(a_link);
+            a->publish(0, a_pose, 20000);
+            a->subscribe(1, a_status);
+        };
+        start_a();
+        b.subscribe(0, b_pose);
+        b.publish(1, b_status, 50000);
+
+        tracker<pose> poses;
+        tracker<status> statuses;
+        poses.published.push_back(a_pose);
+        statuses.published.push_back(b_status);
+
+        // ticks from when the values stopped until both copies matched them for good; 0 until they do
+        std::uint32_t converged = 0;
+        for (std::uint32_t k = 1; k <= total_ticks; k++) {
+            sim_clock::advance(10000);
+            bool moving = k <= moving_ticks;
+            if (moving) {
+                a_pose = {k, a_pose.x + 0.5f, a_pose.y + 0.25f * (k % 7), a_pose.theta + 0.01f};
+                b_status.tick = k;
+                b_status.voltage -= 0.001f;
+                b_status.mode[k % 8] ^= 1;
+                poses.published.push_back(a_pose);
+                statuses.published.push_back(b_status);
+            }
+
+            if (k == s.restart_at) {
+                a.reset();
+                start_a();
+            }
+
+            a_link.tick();
+            b_link.tick();
+            a->service();
+            b.service();
+            if (b_pose.tick || b_pose.x != 0.0f) {
+                poses.check(b_pose, std::min(k, moving_ticks), moving);
+            }
+            if (a_status.tick || a_status.voltage != 0.0f) {
+                statuses.check(a_status, std::min(k, moving_ticks), moving);
+            }
+
+            bool same = std::memcmp(&a_pose, &b_pose, sizeof(pose)) == 0 &&
+                        std::memcmp(&b_status, &a_status, sizeof(status)) == 0;
+            if (!moving && same && !converged) {
+                converged = k - moving_ticks;
+            } else if (!same) {
+                converged = 0;
+            }
+        }
+
+        bool ok = !poses.bad && !statuses.bad && converged && converged <= converge_ticks;
+        std::printf("%6.0f%% %8.0f%% %8.0e %8s %9u %10u %9u ms %9u ms ", s.loss * 100.0, s.reorder * 100.0,
+                    s.error_rate, s.restart_at ? "yes" : "no", a_link.dropped + b_link.dropped,
+                    a_link.reordered + b_link.reordered,
+                    std::max(poses.max_lag, statuses.max_lag) * 10, converged * 10);
+        std::printf("%s\n", ok ? "ok" : poses.bad || statuses.bad ? "FAIL (bad value)" : "FAIL (no convergence)");
+        return ok;
+    }
+}
+
+int main() {
+    const scenario scenarios[] = {
+        {0.0, 0.0, 0.0f},
+        {0.05, 0.0, 0.0f},
+        {0.2, 0.0, 0.0f},
+        {0.0, 0.2, 0.0f},
+        {0.1, 0.2, 0.0f},
+        {0.3, 0.3, 0.0f},
+        {0.5, 0.2, 0.0f},
+        {0.1, 0.1, 1e-4f},
+        {0.0, 0.0, 0.0f, moving_ticks / 2},
+        {0.1, 0.2, 0.0f, moving_ticks / 2},
+        {0.0, 0.0, 0.0f, 8},
+        {0.1, 0.2, 0.0f, 8},
+        {0.0, 0.5, 0.0f, 4},
+    };
+
+    int failures = 0;
+    std::printf("%7s %9s %8s %8s %9s %10s %12s %12s\n", "loss", "reorder", "errors", "restart", "dropped",
+                "reordered", "max lag", "converged");
+    for (const auto& s : scenarios) {
+        for (std::uint32_t seed : {1u, 2u, 3u}) {
+            failures += !run(s, seed);
+        }
+    }
+    return failures ? 1 : 0;
+}
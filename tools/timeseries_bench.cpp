@@ -0,0 +1,97 @@
+/**
+ * @file timeseries_bench.cpp
+ *
+ * host-side benchmark of `hotel::timeseries` (see hotel/timeseries.hpp) against the `std::deque` rescans it replaces
+ *
+ * for a range of window sizes, pushes the same pseudo-random signal through both and reads min, max and mean after every
+ * push, checking that they agree. the per-push cost of the rescan grows with the window; the timeseries shouldn't.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/timeseries_bench [samples]
+ * ```
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "hotel/timeseries.hpp"
+
+namespace {
+    struct result {
+        double ns_per_push;
+        double checksum;
+    };
+
+    template <std::size_t N>
+    result run_timeseries(const std::vector<float>& signal) {
+        hotel::timeseries<float, N> window;
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto v : signal) {
+            window.push(v);
+            checksum += window.min() + window.max() + window.mean();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return {std::chrono::duration<double, std::nano>(end - start).count() / signal.size(), checksum};
+    }
+
+    template <std::size_t N>
+    result run_rescan(const std::vector<float>& signal) {
+        std::deque<float> window;
+        double checksum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto v : signal) {
+            window.push_back(v);
+            if (window.size() > N) {
+                window.pop_front();
+            }
+            auto [lo, hi] = std::minmax_element(window.begin(), window.end());
+            double mean = std::accumulate(window.begin(), window.end(), 0.0) / window.size();
+            checksum += *lo + *hi + mean;
+        }
+        auto end = std::chrono::steady_clock::now();
+        return {std::chrono::duration<double, std::nano>(end - start).count() / signal.size(), checksum};
+    }
+
+    template <std::size_t N>
+    bool compare(const std::vector<float>& signal) {
+        auto fast = run_timeseries<N>(signal);
+        auto slow = run_rescan<N>(signal);
+        bool agree = std::fabs(fast.checksum - slow.checksum) <= 1e-6 * std::fabs(slow.checksum) + 1e-3;
+        std::printf("%6zu  %12.1f  %12.1f  %8.1fx  %s\n", N, fast.ns_per_push, slow.ns_per_push,
+                    slow.ns_per_push / fast.ns_per_push, agree ? "ok" : "MISMATCH");
+        return agree;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    // a noisy, drifting signal, roughly like a motor current
+    std::mt19937 rng{42};
+    std::normal_distribution<float> noise{0.0f, 0.1f};
+    std::vector<float> signal(samples);
+    float level = 1.0f;
+    for (auto& v : signal) {
+        level = std::clamp(level + noise(rng) * 0.1f, 0.0f, 2.5f);
+        v = level + noise(rng);
+    }
+
+    std::printf("%6s  %12s  %12s  %9s\n", "window", "timeseries", "rescan", "speedup");
+    std::printf("%6s  %12s  %12s\n", "", "(ns/push)", "(ns/push)");
+    bool ok = compare<8>(signal);
+    ok = compare<32>(signal) && ok;
+    ok = compare<128>(signal) && ok;
+    ok = compare<512>(signal) && ok;
+    ok = compare<2048>(signal) && ok;
+
+    return ok ? 0 : 1;
+}
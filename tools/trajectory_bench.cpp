@@ -0,0 +1,124 @@
+/**
+ * @file trajectory_bench.cpp
+ *
+ * host-side benchmark of `hotel::trajectory_cache` (see hotel/trajectory_cache.hpp): what a boot costs with and without
+ * the cached files
+ *
+ * a set of paths, parameterized the way an autonomous selector would (a few routines, each with a field offset), is
+ * requested from an empty cache directory and generated, as on the first boot. a second cache over the same directory
+ * then requests them again, as on every boot after that, and loads them from the files. the samples are checked to be
+ * identical, and the time per path is reported for both.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/trajectory_bench [directory]
+ * ```
+ * the directory defaults to a fresh one under `/tmp`; point it at a mounted SD card to time that instead.
+ */
+#include <array>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "hotel/trajectory_cache.hpp"
+
+namespace {
+    struct host_clock {
+        static std::uint64_t now() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+
+        static void wait_until(std::uint64_t t) {
+            auto current = now();
+            if (t > current) {
+                std::this_thread::sleep_for(std::chrono::microseconds(t - current));
+            }
+        };
+    };
+
+    using cache = hotel::basic_trajectory_cache<1024, 16, 16, host_clock>;
+
+    struct request {
+        std::vector<hotel::waypoint> points;
+        hotel::trajectory_constraints constraints;
+    };
+
+    /// four routines, each at three field offsets: twelve paths of 130-330 inches
+    std::vector<request> requests() {
+        std::vector<request> out;
+        for (int routine = 0; routine < 4; routine++) {
+            for (int offset = -1; offset <= 1; offset++) {
+                double o = offset * 1.5;
+                request r;
+                r.points = {{0.0, 0.0}, {24.0, 12.0 + o}, {48.0 + o, 48.0}, {24.0, 72.0 - o}, {-12.0, 60.0}};
+                for (int extra = 0; extra < routine; extra++) {
+                    r.points.push_back({-24.0 - 24.0 * extra, 36.0 + 12.0 * (extra % 2) + o});
+                }
+                r.constraints.max_velocity = 50.0 + 5.0 * routine;
+                r.constraints.spacing = 0.25;
+                out.push_back(r);
+            }
+        }
+        return out;
+    }
+}
+
+int main(int argc, char** argv) {
+    char scratch[] = "/tmp/trajectory_bench.XXXXXX";
+    const char* directory = argc > 1 ? argv[1] : mkdtemp(scratch);
+    if (!directory) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+
+    auto paths = requests();
+    std::vector<std::size_t> handles;
+
+    // first boot: every request misses, and is generated and written back
+    auto cold = std::make_unique<cache>(cache::options{.directory = directory});
+    auto start = host_clock::now();
+    for (auto& r : paths) {
+        handles.push_back(cold->request(r.points, r.constraints));
+    }
+    while (!cold->service()) {}
+    auto cold_us = host_clock::now() - start;
+
+    // every boot after: every request is a single read
+    auto warm = std::make_unique<cache>(cache::options{.directory = directory});
+    start = host_clock::now();
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        if (warm->request(paths[i].points, paths[i].constraints) != handles[i] || !warm->ready(handles[i])) {
+            std::fprintf(stderr, "path %zu missed on the second boot\n", i);
+            return 1;
+        }
+    }
+    auto warm_us = host_clock::now() - start;
+
+    std::size_t samples = 0;
+    for (auto h : handles) {
+        auto a = cold->samples(h), b = warm->samples(h);
+        if (a.size() != b.size() || std::memcmp(a.data(), b.data(), a.size_bytes()) != 0) {
+            std::fprintf(stderr, "path %zu came back different\n", h);
+            return 1;
+        }
+        samples += a.size();
+    }
+
+    const auto& c = cold->stats();
+    const auto& w = warm->stats();
+    std::printf("%zu paths, %zu samples (%zu bytes) in %s\n", paths.size(), samples,
+                samples * sizeof(hotel::trajectory_sample), directory);
+    std::printf("cold: %8.1f us per path (generate %.1f, write %.1f), %u misses\n",
+                static_cast<double>(cold_us) / paths.size(), static_cast<double>(c.generate_us) / paths.size(),
+                static_cast<double>(c.write_us) / paths.size(), c.misses);
+    std::printf("warm: %8.1f us per path (load %.1f, longest %u), %u hits\n",
+                static_cast<double>(warm_us) / paths.size(), static_cast<double>(w.load_us) / paths.size(),
+                w.longest_load_us, w.hits);
+    std::printf("warm boot is %.1fx faster\n", static_cast<double>(cold_us) / std::max<std::uint64_t>(warm_us, 1));
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ * @file trajectory_check.cpp
+ *
+ * host-side check that `hotel::trajectory_cache` (see hotel/trajectory_cache.hpp) only ever serves the samples it
+ * generated, whatever it finds on the card
+ *
+ * a path is generated into a fresh directory, and then its file is damaged in the ways a card does it before the next
+ * boot (a cache over the same directory) requests the path again: a flipped bit in the samples, a write torn off
+ * partway through (or down to the header, or to nothing), a file from a different path copied over it (a collision in
+ * the 32-bit file name), and a header claiming more samples than the file has. each of those has to be rejected and
+ * counted, the path generated again (identical to the first time), and the file rewritten so that the boot after that
+ * is a plain hit. bumping `version` has to turn every file into a miss without disturbing the old ones, and a request
+ * with a single waypoint (which can't be generated) has to fail without leaving a file or a ready slot behind.
+ *
+ * reported are the counters after each case. exits with a non-zero status if any case doesn't come out as described.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/trajectory_check
+ * ```
+ */
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "hotel/trajectory_cache.hpp"
+
+namespace {
+    struct host_clock {
+        static std::uint64_t now() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+
+        static void wait_until(std::uint64_t t) {
+            auto current = now();
+            if (t > current) {
+                std::this_thread::sleep_for(std::chrono::microseconds(t - current));
+            }
+        };
+    };
+
+    using cache = hotel::basic_trajectory_cache<1024, 4, 16, host_clock>;
+    using bytes = std::vector<char>;
+
+    const char* directory = nullptr;
+
+    const std::vector<hotel::waypoint> path_a{{0.0, 0.0}, {24.0, 12.0}, {48.0, 48.0}, {24.0, 72.0}};
+    const std::vector<hotel::waypoint> path_b{{0.0, 0.0}, {-24.0, 12.0}, {-48.0, 36.0}};
+    const hotel::trajectory_constraints constraints{.max_velocity = 50.0, .spacing = 0.5};
+
+    /// where the cache keeps a path: 32 bits of its key, folded, as the file name
+    std::string file(const std::vector<hotel::waypoint>& points, std::uint32_t version = 1) {
+        auto key = cache::key(points, constraints, version);
+        char name[128];
+        std::snprintf(name, sizeof(name), "%s/%08lx.trj", directory,
+                      static_cast<unsigned long>(static_cast<std::uint32_t>(key ^ key >> 32)));
+        return name;
+    }
+
+    bytes read(const std::string& name) {
+        std::ifstream in{name, std::ios::binary};
+        return {std::istreambuf_iterator<char>{in}, {}};
+    }
+
+    void write(const std::string& name, const bytes& contents) {
+        std::ofstream{name, std::ios::binary | std::ios::trunc}.write(contents.data(),
+                                                                     static_cast<std::streamsize>(contents.size()));
+    }
+
+    struct boot {
+        std::unique_ptr<cache> c;
+        std::size_t handle;
+        std::vector<hotel::trajectory_sample> samples;
+        cache::statistics stats;
+    };
+
+    /// a fresh cache requesting one path, serviced until nothing's pending
+    boot start(const std::vector<hotel::waypoint>& points, std::uint32_t version = 1) {
+        boot b{std::make_unique<cache>(cache::options{.directory = directory, .version = version}), 0, {}, {}};
+        b.handle = b.c->request(points, constraints);
+        while (!b.c->service()) {}
+        auto s = b.c->samples(b.handle);
+        b.samples.assign(s.begin(), s.end());
+        b.stats = b.c->stats();
+        return b;
+    }
+
+    bool same(const std::vector<hotel::trajectory_sample>& a, const std::vector<hotel::trajectory_sample>& b) {
+        return a.size() == b.size() && !a.empty() &&
+               std::memcmp(a.data(), b.data(), a.size() * sizeof(hotel::trajectory_sample)) == 0;
+    }
+
+    int failures = 0;
+
+    void expect(const char* what, const boot& b, bool ok) {
+        failures += !ok;
+        std::printf("%-44s %5u %5u %8u %8u %8zu  %s\n", what, b.stats.hits, b.stats.misses, b.stats.rejected,
+                    b.stats.write_failures, b.samples.size(), ok ? "ok" : "FAIL");
+    }
+
+    /// damage path a's file, boot twice, and check the first boot rejects it and the second is back to a hit
+    void damaged(const char* what, const std::vector<hotel::trajectory_sample>& original,
+                 const std::function<void(bytes&)>& damage) {
+        auto contents = read(file(path_a));
+        damage(contents);
+        write(file(path_a), contents);
+
+        auto rejected = start(path_a);
+        expect(what, rejected, rejected.stats.rejected == 1 && rejected.stats.misses == 1 &&
+                               rejected.stats.hits == 0 && same(rejected.samples, original));
+        auto again = start(path_a);
+        expect("  then rewritten", again, again.stats.hits == 1 && again.stats.rejected == 0 &&
+                                          same(again.samples, original));
+    }
+}
+
+int main() {
+    char scratch[] = "/tmp/trajectory_check.XXXXXX";
+    directory = mkdtemp(scratch);
+    if (!directory) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+
+    std::printf("%-44s %5s %5s %8s %8s %8s\n", "case", "hits", "miss", "rejected", "wfailed", "samples");
+    auto first = start(path_a);
+    expect("first boot generates", first, first.stats.misses == 1 && first.stats.write_failures == 0 &&
+                                          first.samples.size() > 100 && std::filesystem::exists(file(path_a)));
+    auto second = start(path_a);
+    expect("second boot loads", second, second.stats.hits == 1 && same(second.samples, first.samples));
+    auto original = first.samples;
+    auto header_size = read(file(path_a)).size() - original.size() * sizeof(hotel::trajectory_sample);
+
+    damaged("bit flipped in the samples", original, [] (bytes& b) { b[b.size() / 2] ^= 0x10; });
+    damaged("torn write", original, [] (bytes& b) { b.resize(b.size() * 2 / 3); });
+    damaged("header only", original, [header_size] (bytes& b) { b.resize(header_size); });
+    damaged("another path's file under its name", original, [] (bytes& b) {
+        start(path_b);
+        b = read(file(path_b));
+    });
+    damaged("header claims more samples than there are", original, [] (bytes& b) {
+        std::uint32_t count;
+        std::memcpy(&count, b.data() + 4, sizeof(count));
+        count++;
+        std::memcpy(b.data() + 4, &count, sizeof(count));
+    });
+    damaged("empty file", original, [] (bytes& b) { b.clear(); });
+
+    auto bumped = start(path_a, 2);
+    expect("version bumped: generated again", bumped, bumped.stats.misses == 1 && bumped.stats.hits == 0 &&
+                                                      same(bumped.samples, original) &&
+                                                      file(path_a, 2) != file(path_a, 1));
+    auto bumped_again = start(path_a, 2);
+    expect("  then loaded under the new version", bumped_again, bumped_again.stats.hits == 1);
+    auto old_version = start(path_a, 1);
+    expect("  old version's file untouched", old_version, old_version.stats.hits == 1);
+
+    const std::vector<hotel::waypoint> single{{12.0, 12.0}};
+    auto lonely = start(single);
+    bool failed = lonely.c->state(lonely.handle) == cache::status::failed && !lonely.c->ready(lonely.handle) &&
+                  !lonely.c->wait(lonely.handle, 1000) && !std::filesystem::exists(file(single));
+    expect("single waypoint fails, and writes nothing", lonely, failed && lonely.stats.misses == 1);
+    auto lonely_again = start(single);
+    expect("  and fails again next boot", lonely_again,
+           lonely_again.stats.misses == 1 && lonely_again.stats.rejected == 0 && lonely_again.samples.empty());
+
+    std::filesystem::remove_all(directory);
+    return failures ? 1 : 0;
+}
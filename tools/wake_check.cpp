@@ -0,0 +1,175 @@
+/**
+ * @file wake_check.cpp
+ *
+ * host-side check that `hotel::pid_controller::resume()` (see hotel/pid.hpp) and `hotel::idle_wake_loop` (see
+ * hotel/idle_wake.hpp) wake without a bump
+ *
+ * `pros::Clock` is stood in for by a millisecond counter that follows `hotel::sim::virtual_clock` (see
+ * hotel/sim/pros_clock.hpp), so the controller runs exactly as it would on the brain. three things are checked:
+ *
+ * - a PD loop paused for five seconds and resumed with its error unchanged produces exactly the output it did before
+ *   the pause, and a PID loop's first output after a pause is the law evaluated at the period it ran at before, with
+ *   its accumulated error and no derivative kick (with and without a derivative gain, since a zero gain times an
+ *   infinite rate is NaN, not zero)
+ * - two iterations within one clock tick don't divide by a zero period
+ * - a lift held by `idle_wake_loop` settles, idles, takes on a game object, wakes and settles again, and the first
+ *   output after the wake is within one iteration's worth of change of the last one before it
+ *
+ * exits with a non-zero status if any check fails.
+ *
+ * build with `make tools` (uses the host compiler), then
+ * ```
+ * bin/wake_check
+ * ```
+ */
+#include <algorithm>
+#include <cmath>
+#include <ratio>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "hotel/idle_wake.hpp"
+#include "hotel/pid.hpp"
+#include "hotel/sim/plant.hpp"
+#include "hotel/sim/pros_clock.hpp"
+
+using sim_clock = hotel::sim::virtual_clock;
+
+namespace {
+    int failures = 0;
+
+    void check(bool ok, const char* what) {
+        std::printf("%-72s %s\n", what, ok ? "ok" : "FAIL");
+        failures += !ok;
+    }
+
+    /// a lift: motor velocity lags the command, position integrates it, gravity (and whatever it's carrying) pulls
+    struct lift {
+        double position = 0.0;
+        double velocity = 0.0;
+        double command = 0.0;
+        double load = 20.0;
+        std::uint64_t last = 0;
+
+        double read() {
+            for (; last + 1000 <= sim_clock::now(); last += 1000) {
+                velocity += (9.4 * (command - load) - velocity) * (1.0 - std::exp(-0.001 / 0.08));
+                position += velocity * 0.001;
+            }
+            return position;
+        }
+    };
+
+    template <class Ki, class Kd>
+    using controller_t = hotel::pid_controller<std::ratio<1, 2>, Ki, Kd, double, std::function<double()>>;
+
+    /// run 20 iterations 10 ms apart, pause for five seconds, resume, and check the first output after the pause
+    template <class Ki, class Kd>
+    void pause_and_resume(const char* name, double before, double after) {
+        using law = hotel::pid_law<std::ratio<1, 2>, Ki, Kd>;
+        sim_clock::reset(1000000);
+        double measured = before;
+        controller_t<Ki, Kd> controller{[&] { return measured; }, [] (double) { return false; }, 100.0};
+
+        double last_output = 0.0, accumulated = 0.0;
+        {
+            auto generator = controller.run();
+            auto it = generator.begin();
+            for (int k = 0; k < 20; k++) {
+                sim_clock::advance(10000);
+                ++it;
+                last_output = *it;
+            }
+            // 21 errors of (100 - before) have been accumulated, the first at the controller's construction
+            accumulated = 21 * (100.0 - before);
+        }
+
+        sim_clock::advance(5000000);
+        measured = after;
+        controller.resume();
+        auto generator = controller.run();
+        double first = *generator.begin();
+        double error = 100.0 - after;
+        double expected = law::output(error, accumulated + error, error, 10.0);
+
+        char what[128];
+        std::snprintf(what, sizeof(what), "%s: first output after a 5 s pause is %.3f (expected %.3f)", name, first,
+                      expected);
+        check(std::isfinite(first) && std::fabs(first - expected) < 1e-9, what);
+        if (before == after && std::ratio_equal_v<Ki, std::ratio<0>>) {
+            std::snprintf(what, sizeof(what), "%s: unchanged error gives the output from before the pause (%.3f)",
+                          name, last_output);
+            check(first == last_output, what);
+        }
+    }
+}
+
+int main() {
+    pause_and_resume<std::ratio<0>, std::ratio<1, 100>>("PD, error unchanged", 90.0, 90.0);
+    pause_and_resume<std::ratio<1, 1000>, std::ratio<1, 100>>("PID, error moved", 90.0, 80.0);
+    pause_and_resume<std::ratio<1, 1000>, std::ratio<0>>("PI, error moved", 90.0, 80.0);
+
+    // two iterations inside the same millisecond
+    {
+        sim_clock::reset(1000000);
+        double measured = 0.0;
+        controller_t<std::ratio<1, 1000>, std::ratio<1, 100>> controller{[&] { return measured; },
+                                                                          [] (double) { return false; }, 100.0};
+        auto generator = controller.run();
+        auto it = generator.begin();
+        sim_clock::advance(10000);
+        ++it;
+        measured = 1.0;
+        ++it;
+        check(std::isfinite(*it), "two iterations within one clock tick give a finite output");
+    }
+
+    // a lift holding 600 degrees picks up a game object
+    {
+        sim_clock::reset(1000000);
+        lift plant;
+        plant.last = sim_clock::now();
+        hotel::motor_position_controller<std::ratio<1, 2>, std::ratio<1, 1000>, std::ratio<0>> controller{
+            [&] { return plant.read(); }, [] (double error) { return std::fabs(error) < 5.0; }, 600.0};
+        hotel::idle_wake_loop<decltype(controller), sim_clock> hold{controller,
+                                                                    {.active_period_us = 10000,
+                                                                     .idle_period_us = 50000}};
+
+        std::uint32_t wakes = 0;
+        std::int32_t last_output = 0;
+        double last_error = 0.0;
+        int checked = 0;
+        bool bumpless = true, bounded = true;
+        hold.run([&] (std::int32_t output) {
+            double error = 600.0 - plant.read();
+            if (hold.stats().wakes != wakes) {
+                wakes = hold.stats().wakes;
+                // one iteration's worth: the error's change through Kp, plus one more error accumulated
+                double allowed = 0.5 * std::fabs(error - last_error) + std::fabs(error) * 10.0 / 1000.0 + 1.0;
+                bumpless = bumpless && std::abs(output - last_output) <= allowed;
+                std::printf("  wake %u: last output before %d, first after %d (allowed change %.1f)\n", wakes,
+                            last_output, output, allowed);
+                checked++;
+            }
+            bounded = bounded && std::abs(output) < 1000;
+            last_output = output;
+            last_error = error;
+            plant.command = std::clamp<double>(output, -127.0, 127.0);
+        }, [&] {
+            if (sim_clock::now() >= 6000000) {
+                plant.load = 35.0;
+            }
+            return sim_clock::now() >= 12000000;
+        });
+
+        check(hold.stats().idle_iterations > 0, "lift settles and idles");
+        check(checked > 0, "lift wakes when it picks up the game object");
+        check(bounded, "every output is in range");
+        check(bumpless, "first output after each wake is within one iteration's change");
+        check(std::fabs(600.0 - plant.read()) < 5.0, "lift settles again after the wake");
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}